@@ -16,76 +16,163 @@
 #include <cmath>
 #include <esp_task_wdt.h>
 #include <esp_mac.h>
+#include <driver/gpio.h>
 #include <RebootManager.h>
 
 #include "common.h"
 #include "webhandling.h"
 #include "version.h"
 #include "neotimer.h"
+#include "bme280burst.h"
+#include "scheduler.h"
+#include "n2ktemplates.h"
+#include "n2kstats.h"
+#include "n2kalert.h"
+#include "derived.h"
+#include "diagnostics.h"
+#include "busplanner.h"
 
 bool debugMode = false;
 String gStatusSensor;
 char Version[] = VERSION_STR; // Manufacturer's Software version code
 
-uint8_t gN2KSource[] = { 22, 23, 24 };
-uint8_t gN2KInstance = 1;
-uint8_t gN2KSID = 1;
-tN2kTempSource gTempSource = N2kts_MainCabinTemperature;
-tN2kHumiditySource gHumiditySource = N2khs_Undef;
-
-tN2kSyncScheduler TemperatureScheduler(false, 2000, 500);
-tN2kSyncScheduler HumidityScheduler(false, 500, 510);
-tN2kSyncScheduler PressureScheduler(false, 500, 520);
-tN2kSyncScheduler DewPointScheduler(false, 500, 530);
-tN2kSyncScheduler HeatIndexScheduler(false, 500, 540);
-
-// Define a function to calculate the dew point
-double dewPoint(double temp_celsius, double humidity) {
-    const double a = 17.27;
-    const double b = 237.7;
-    double alpha = ((a * temp_celsius) / (b + temp_celsius)) + log(humidity / 100.0);
-    return (b * alpha) / (a - alpha);
+uint8_t gN2KSource[DeviceCount];
+
+// Configuration snapshots from the web server. loop() applies a new version
+// once per cycle, everything it needs from it is copied into the state below.
+SnapshotStore<ConfigSnapshot> gConfig;
+uint32_t AppliedConfigVersion = 0;
+
+// All periodic work of loop(). loop() sleeps until the next job is due.
+DeadlineScheduler Scheduler;
+
+// One epoch every 500 ms. Which values of an epoch are sent is decided by the transmit policy.
+const uint32_t EpochPeriod = 500;
+const uint32_t EpochOffset = 500;
+
+// The messages of an epoch are spread over slots, so that the node puts at
+// most BusBudget frames per slot on the bus. BusPlanner assigns the slots
+// when the configuration changes. SlotJob runs every slot, slot 0 acquires.
+// A message larger than the budget (the storm alert, 5 frames) gets a slot
+// of its own.
+const uint32_t SlotLength = 20;
+const uint8_t BusBudget = 4;
+const uint8_t SlotsPerEpoch = EpochPeriod / SlotLength;
+BusPlanner Planner;
+static_assert(SENSOR_COUNT * TemplateCount + 1 <= BusPlanner::MaxMessages, "the bus plan needs an entry for every message");
+uint32_t CurrentEpoch = 0xFFFFFFFF; // none started yet
+
+// Measurements and alerts are queued and sent from loop() after the bus was
+// parsed, so the protocol messages of the library go first. A congested bus
+// sends the newest values and drops the ones older than the maximum age.
+OutboundQueue gOutbound;
+const uint8_t AlertKey = 0;
+static_assert(SENSOR_COUNT * TemplateCount + 1 <= OutboundQueue::Size, "the outbound queue has to hold a whole epoch and the alert");
+
+// Frames the CAN driver may hold: a product information (20 frames) and the
+// messages of a few slots. Values in the driver cannot be dropped any more,
+// so a deeper buffer would delay them on a congested bus far beyond the
+// maximum age (13 s at 12 frames/s with 150 frames).
+const uint16_t SendFrameBufferSize = 32;
+
+// Send results per PGN and virtual device, read by the web server
+N2kStatistics gN2kStats;
+const uint32_t StatisticsPeriod = 1000;
+
+// The bus is parsed when frames arrive and at least this often for the
+// protocol timers (address claim, heartbeat). Without the receive
+// notification the bus is polled every PollInterval ms.
+const uint32_t ProtocolInterval = 50;
+const uint32_t PollInterval = 10;
+bool gCanRxNotification = false;
+TaskHandle_t N2kTaskHandle = NULL;
+
+// One acquisition and everything that is sent for it
+struct tEpoch {
+    uint32_t Number;
+    uint8_t SID;
+    BME280Sample Sample;
+    double Temperature;
+    double Humidity;
+    double Pressure;
+    double DewPoint;
+    double HeatIndex;
+};
 
-}
+// The BME280 of this node, the first SENSOR_COUNT entries are used.
+// The first sensor is the primary one: it uses the temperature and humidity
+// source of the web configuration, and its values are shown on the web page,
+// recorded and used for the storm warning. Every sensor uses five instances
+// from the configured instance plus InstanceOffset.
+struct tSensorEntry {
+    uint8_t Address;
+    TwoWire* Bus;
+    uint8_t InstanceOffset;
+    tN2kTempSource TempSource;
+    tN2kHumiditySource HumiditySource;
+};
 
-// This function takes the temperature in Celsius and the relative humidity in percentage
-// and returns the heat index temperature in Celsius
-double heatIndexCelsius(double temp_celsius, double humidity) {
-    // These are the constants used in the formula
-    const double c1 = -42.379;
-    const double c2 = 2.04901523;
-    const double c3 = 10.14333127;
-    const double c4 = -0.22475541;
-    const double c5 = -0.00683783;
-    const double c6 = -0.05481717;
-    const double c7 = 0.00122874;
-    const double c8 = 0.00085282;
-    const double c9 = -0.00000199;
-
-    // Convert the temperature from Celsius to Fahrenheit
-    double temp_fahrenheit = temp_celsius * 9.0 / 5.0 + 32;
-
-    // Calculate the heat index in Fahrenheit
-    double heat_fahrenheit = c1 + c2 * temp_fahrenheit + c3 * humidity + c4 * temp_fahrenheit * humidity + c5 * temp_fahrenheit * temp_fahrenheit + c6 * humidity * humidity + c7 * temp_fahrenheit * temp_fahrenheit * humidity + c8 * temp_fahrenheit * humidity * humidity + c9 * temp_fahrenheit * temp_fahrenheit * humidity * humidity;
-
-    // Convert the heat index from Fahrenheit to Celsius
-    double heat_celsius = (heat_fahrenheit - 32) * 5.0 / 9.0;
-
-    // Return the result
-    return heat_celsius;
-}
+const tSensorEntry Sensors[] = {
+    { BME280_ADDRESS_ALTERNATE, &Wire, 0, N2kts_MainCabinTemperature, N2khs_InsideHumidity },
+    { BME280_ADDRESS, &Wire, 5, N2kts_OutsideTemperature, N2khs_OutsideHumidity },
+    { BME280_ADDRESS_ALTERNATE, &Wire1, 10, N2kts_EngineRoomTemperature, N2khs_InsideHumidity },
+    { BME280_ADDRESS, &Wire1, 15, N2kts_RefridgerationTemperature, N2khs_InsideHumidity }
+};
+
+static_assert(SENSOR_COUNT >= 1 && SENSOR_COUNT <= sizeof(Sensors) / sizeof(Sensors[0]), "SENSOR_COUNT needs an entry in Sensors[]");
+static_assert(DeviceCount <= N2kStatistics::MaxDevices, "too many devices for the statistics");
+
+// Everything that belongs to one sensor
+struct tSensorState {
+    BME280Burst Bme;
+    bool Present;
+    tEpoch Epoch;
+    ChannelTransmitter Transmitters[ChannelCount];
+    N2kTemplates Templates; // prebuilt messages, rebuilt when the configuration changes
+    uint8_t Slots[TemplateCount];  // slot of the epoch where the message is sent
+    bool Pending[TemplateCount];   // due in this epoch and not sent yet
+};
+
+tSensorState SensorStates[SENSOR_COUNT];
+
+// The virtual NMEA 2000 devices of a sensor, in the order of DeviceTemperature/Pressure/Humidity
+struct tDeviceEntry {
+    const char* ModelSerialCode;
+    uint16_t ProductCode;
+    const char* ModelID;
+    uint8_t DeviceFunction;
+    uint8_t IdShift; // for the unique number from the chip id
+    const unsigned long* TransmitMessages;
+};
+
+SeqLock<SensorData> gSensorData;
 
+// Window statistics per channel, updated with every epoch
+MinuteStatistics MinuteStats[ChannelCount];
+HourStatistics HourStats[ChannelCount];
+DayStatistics DayStats[ChannelCount];
+SeqLock<StatisticsData> gStatistics;
 
-double gTemperature = 0;
-double gHumidity = 0;
-double gPressure = 0;
-double gdewPoint = 0;
-double gheatIndex = 0;
+// 24 h of minute values for the web page
+History gHistory;
+
+// Pressure tendency and storm warning. An active warning is repeated every
+// AlertPeriod ms as alert of the pressure device.
+PressureTendency Tendency;
+bool StormAlertEnabled = true;
+uint8_t StormAlertInstance = 1;
+bool StormAlertActive = false;
+uint8_t StormAlertOccurrence = 0;
+const uint32_t AlertPeriod = 10000;
+const uint16_t StormAlertId = 1;
+LoopTiming gLoopTiming;
 
 // Task handle (Core 0 on ESP32)
 TaskHandle_t TaskHandle;
 
-Adafruit_BME280 bme;
+// In forced mode TriggerJob starts the conversion so that it is done when slot 0 reads it
+int8_t TriggerJobId = -1;
+int8_t AlertJobId = -1;
 
 // List here messages your device will transmit.
 const unsigned long TemperaturTransmitMessages[] PROGMEM = {
@@ -101,53 +188,100 @@ const unsigned long HumidityTransmitMessages[] PROGMEM = {
 
 const unsigned long PressureTransmitMessages[] PROGMEM = {
     130314L, // Pressure
+    126983L, // Alert (storm warning)
     0
 };
 
+const tDeviceEntry Devices[DevicesPerSensor] = {
+    { "101", 101, "BME280-TemperaturMonitor", 130, 7, TemperaturTransmitMessages }, // Devices that measure/report temperature
+    { "102", 102, "BME280-Pressure", 140, 8, PressureTransmitMessages },            // Devices that measure/report pressure
+    { "103", 103, "BME280-HumidityMonitor", 170, 9, HumidityTransmitMessages }      // Devices that measure/report humidity
+};
+
 void OnN2kOpen() {
-    // Start schedulers now.
-    TemperatureScheduler.UpdateNextTime();
-    HumidityScheduler.UpdateNextTime();
-    PressureScheduler.UpdateNextTime();
-    DewPointScheduler.UpdateNextTime();
-    HeatIndexScheduler.UpdateNextTime();
+    // Start schedulers now, the epochs count from here.
+    CurrentEpoch = 0xFFFFFFFF;
+    Scheduler.start(millis());
 }
 
-void CheckN2kSourceAddressChange() {
-    uint8_t SourceAddress = NMEA2000.GetN2kSource();
+// The first falling edge on the CAN RX line (start of frame) wakes loop().
+// The interrupt disables itself and is armed again before the next parse,
+// so a busy bus costs one interrupt per wake and not one per bit.
+void IRAM_ATTR OnCanRxActivity(void* /* arg_ */) {
+    BaseType_t woken_ = pdFALSE;
 
-    if (NMEA2000.GetN2kSource(DeviceTemperature) != gN2KSource[DeviceTemperature]) {
-        gN2KSource[DeviceTemperature] = NMEA2000.GetN2kSource(DeviceTemperature);
-        gSaveParams = true;
+    gpio_intr_disable(ESP32_CAN_RX_PIN);
+    vTaskNotifyGiveFromISR(N2kTaskHandle, &woken_);
+    if (woken_) {
+        portYIELD_FROM_ISR();
     }
+}
+
+// The CAN driver owns the RX pin, we only listen to its edges
+bool InitCanRxNotification() {
+    N2kTaskHandle = xTaskGetCurrentTaskHandle();
 
-    if (NMEA2000.GetN2kSource(DevicePressure) != gN2KSource[DevicePressure]) {
-        gN2KSource[DevicePressure] = NMEA2000.GetN2kSource(DevicePressure);
-        gSaveParams = true;
+    esp_err_t err_ = gpio_install_isr_service(0);
+    if (err_ != ESP_OK && err_ != ESP_ERR_INVALID_STATE) { // already installed is fine
+        return false;
     }
+    if (gpio_set_intr_type(ESP32_CAN_RX_PIN, GPIO_INTR_NEGEDGE) != ESP_OK) {
+        return false;
+    }
+    if (gpio_isr_handler_add(ESP32_CAN_RX_PIN, OnCanRxActivity, NULL) != ESP_OK) {
+        return false;
+    }
+    return true;
+}
 
-    if (NMEA2000.GetN2kSource(DeviceHumidity) != gN2KSource[DeviceHumidity]) {
-        gN2KSource[DeviceHumidity] = NMEA2000.GetN2kSource(DeviceHumidity);
-        gSaveParams = true;
+void CheckN2kSourceAddressChange() {
+    for (uint8_t i = 0; i < DeviceCount; i++) {
+        if (NMEA2000.GetN2kSource(i) != gN2KSource[i]) {
+            gN2KSource[i] = NMEA2000.GetN2kSource(i);
+            gSaveParams = true;
+        }
     }
 }
 
+// Product and device information of one virtual device from Devices[]
+void SetupN2kDevice(uint8_t device_, const uint8_t* chipid_) {
+    const tDeviceEntry& entry_ = Devices[device_ % DevicesPerSensor];
+    uint8_t sensor_ = device_ / DevicesPerSensor;
+
+    // Generate unique numbers from chip id, the further sensors count up from the first
+    uint64_t id_ = 0;
+    for (int i = 0; i < 6; i++) {
+        id_ += (chipid_[i] << (entry_.IdShift * i));
+    }
+    id_ += (uint64_t)sensor_ << 16;
+
+    NMEA2000.SetProductInformation(
+        entry_.ModelSerialCode, // Manufacturer's Model serial code
+        entry_.ProductCode, // Manufacturer's product code
+        entry_.ModelID,  // Manufacturer's Model ID
+        Version,  // Manufacturer's Software version code
+        Version, // Manufacturer's Model version
+        1, // load equivalency
+        0xffff, // NMEA 2000 version - use default
+        0xff, // Sertification level - use default
+        device_
+    );
+
+    NMEA2000.SetDeviceInformation(
+        id_, // Unique number. Use e.g. Serial number.
+        entry_.DeviceFunction, // Device function
+        75, // Device class=Sensor Communication Interface.
+        2046, // Just choosen free from code list on 
+        4,  // Marine
+        device_
+    );
+}
+
 void setup() {
     uint8_t chipid[6];
-    uint64_t DeviceId1 = 0;
-    uint64_t DeviceId2 = 0;
-    uint64_t DeviceId3 = 0;
-    int i = 0;
 
-    // Generate unique numbers from chip id
     esp_efuse_mac_get_default(chipid);
 
-    for (int i = 0; i < 6; i++) {
-        DeviceId1 += (chipid[i] << (7 * i));
-        DeviceId2 += (chipid[i] << (8 * i)); // 8*i statt 7*i
-        DeviceId3 += (chipid[i] << (9 * i)); // 9*i statt 7*i oder 8*i
-    }
-
     Serial.begin(115200);
     while (!Serial) {
         delay(1);
@@ -162,97 +296,60 @@ void setup() {
     // init wifi
     wifiInit();
 
-    gStatusSensor = "OK";
-    if (!bme.begin(BME280_ADDRESS_ALTERNATE)) {
-        gStatusSensor = "NOK";
-		DEBUG_PRINTLN(F("Could not find a valid BME280 sensor, check wiring!"));
+    const ConfigSnapshot& config_ = gConfig.acquire();
+    for (uint8_t i = 0; i < DeviceCount; i++) {
+        gN2KSource[i] = config_.Sources[i];
+    }
+
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        tSensorState& sensor_ = SensorStates[i];
+
+        // The configured SID is the start value, it is incremented with every epoch
+        sensor_.Epoch.SID = config_.SID;
+
+        sensor_.Present = sensor_.Bme.begin(Sensors[i].Address, Sensors[i].Bus);
+        if (!sensor_.Present) {
+            DEBUG_PRINTF("Could not find a valid BME280 sensor at 0x%02X, check wiring!\n", Sensors[i].Address);
+        }
     }
+    gStatusSensor = SensorStates[0].Present ? "OK" : "NOK";
+    gConfig.release();
 	
 
     xTaskCreatePinnedToCore(
         loop2, /* Function to implement the task */
         "TaskHandle", /* Name of the task */
-        10000,  /* Stack size in words */
+        10000,  /* Stack size in bytes, the use is shown on /diagnostics */
         NULL,  /* Task input parameter */
         0,  /* Priority of the task */
         &TaskHandle,  /* Task handle. */
         0 /* Core where the task should run */
     );
 
-    // Enable multi device support for 3 devices
-    NMEA2000.SetDeviceCount(3); 
+    // Enable multi device support, three devices per sensor
+    NMEA2000.SetDeviceCount(DeviceCount);
+
+    TriggerJobId = Scheduler.add(TriggerJob, EpochPeriod, EpochOffset);
+    Scheduler.add(SlotJob, SlotLength, EpochOffset);
+    Scheduler.add(StatisticsJob, StatisticsPeriod, StatisticsPeriod);
+    AlertJobId = Scheduler.add(AlertJob, AlertPeriod, AlertPeriod);
+
+    gN2kStats.addPGN(130312L);
+    gN2kStats.addPGN(130313L);
+    gN2kStats.addPGN(130314L);
+    gN2kStats.addPGN(130316L);
+    gN2kStats.addPGN(126983L);
 
     NMEA2000.SetOnOpen(OnN2kOpen);
 
     // Reserve enough buffer for sending all messages. This does not work on small memory devices like Uno or Mega
     NMEA2000.SetN2kCANMsgBufSize(8);
     NMEA2000.SetN2kCANReceiveFrameBufSize(150);
-    NMEA2000.SetN2kCANSendFrameBufSize(150);
-
-    // Set Product information
-    NMEA2000.SetProductInformation(
-        "101", // Manufacturer's Model serial code
-        101, // Manufacturer's product code
-        "BME280-TemperaturMonitor",  // Manufacturer's Model ID
-        Version,  // Manufacturer's Software version code
-        Version, // Manufacturer's Model version
-        1, // load equivalency
-        0xffff, // NMEA 2000 version - use default
-        0xff, // Sertification level - use default
-        DeviceTemperature
-    );
+    NMEA2000.SetN2kCANSendFrameBufSize(SendFrameBufferSize);
 
-    NMEA2000.SetProductInformation(
-        "102", // Manufacturer's Model serial code
-        102, // Manufacturer's product code
-        "BME280-Pressure",  // Manufacturer's Model ID
-        Version,  // Manufacturer's Software version code
-        Version, // Manufacturer's Model version
-        1, // load equivalency
-        0xffff, // NMEA 2000 version - use default
-        0xff, // Sertification level - use default
-        DevicePressure
-    );
-
-    NMEA2000.SetProductInformation(
-        "103", // Manufacturer's Model serial code
-        103, // Manufacturer's product code
-        "BME280-HumidityMonitor",  // Manufacturer's Model ID
-        Version,  // Manufacturer's Software version code
-        Version, // Manufacturer's Model version
-        1, // load equivalency
-        0xffff, // NMEA 2000 version - use default
-        0xff, // Sertification level - use default
-        DeviceHumidity
-    );
-
-    // Set device information
-    NMEA2000.SetDeviceInformation(
-        DeviceId1, // Unique number. Use e.g. Serial number.
-        130, // Device function=Devices that measure/report temperature
-        75, // Device class=Sensor Communication Interface.
-        2046, // Just choosen free from code list on 
-        4,  // Marine
-        DeviceTemperature
-    );
-
-    NMEA2000.SetDeviceInformation(
-        DeviceId2, // Unique number. Use e.g. Serial number.
-        140, // Device function=Devices that measure/report pressure.
-        75, // Device class=Sensor Communication Interface.
-        2046, // Just choosen free from code list on 
-        4,  // Marine
-        DevicePressure
-    );
-
-    NMEA2000.SetDeviceInformation(
-        DeviceId3, // Unique number. Use e.g. Serial number.
-        170, // Device function=Devices that measure/report humidity.
-        75, // Device class=Sensor Communication Interface.
-        2046, // Just choosen free from code list on 
-        4,  // Marine
-        DeviceHumidity
-    );
+    for (uint8_t i = 0; i < DeviceCount; i++) {
+        SetupN2kDevice(i, chipid);
+    }
 
     // Disable all msg forwarding to USB (=Serial)
     NMEA2000.EnableForward(false); 
@@ -260,129 +357,375 @@ void setup() {
     // If you also want to see all traffic on the bus use N2km_ListenAndNode instead of N2km_NodeOnly below
     NMEA2000.SetMode(tNMEA2000::N2km_NodeOnly);
 
-    NMEA2000.SetN2kSource(gN2KSource[DeviceTemperature], DeviceTemperature);
-    NMEA2000.SetN2kSource(gN2KSource[DevicePressure], DevicePressure);
-    NMEA2000.SetN2kSource(gN2KSource[DeviceHumidity], DeviceHumidity);
-
-
-    // Here we tell library, which PGNs we transmit
-    NMEA2000.ExtendTransmitMessages(TemperaturTransmitMessages);
-    NMEA2000.ExtendTransmitMessages(PressureTransmitMessages);
-    NMEA2000.ExtendTransmitMessages(HumidityTransmitMessages);
+    // Here we tell library, which PGNs each device transmits
+    for (uint8_t i = 0; i < DeviceCount; i++) {
+        NMEA2000.SetN2kSource(gN2KSource[i], i);
+        NMEA2000.ExtendTransmitMessages(Devices[i % DevicesPerSensor].TransmitMessages, i);
+    }
         
     NMEA2000.Open();
 
+    gCanRxNotification = InitCanRxNotification();
+    if (!gCanRxNotification) {
+        DEBUG_PRINTLN(F("CAN receive notification not available, polling the bus"));
+    }
+
     esp_task_wdt_add(NULL); //add current thread to WDT watch
 }
 
-void SendN2kTemperature(uint8_t instance_) {
-    tN2kMsg N2kMsg;
-    double Temperature = 0.00;
+// SID 0..252 are valid, 253..255 are reserved
+uint8_t NextSID(uint8_t sid_) {
+    return sid_ >= 252 ? 0 : sid_ + 1;
+}
 
-    if (TemperatureScheduler.IsTime()) {
-        TemperatureScheduler.UpdateNextTime();
+// Reads the sensor once and calculates the derived values from this sample.
+// Every epoch gets a new SID.
+void AcquireEpoch(tSensorState& sensor_) {
+    tEpoch& epoch_ = sensor_.Epoch;
 
-		if (gStatusSensor != "NOK") {
-            Temperature = bme.readTemperature();
-		}
-        
-        SetN2kPGN130312(N2kMsg, gN2KSID, instance_, gTempSource, CToKelvin(Temperature), N2kDoubleNA);
-        NMEA2000.SendMsg(N2kMsg, DeviceTemperature);
+    epoch_.Number++;
+    epoch_.SID = NextSID(epoch_.SID);
+
+    epoch_.Temperature = 0.00;
+    epoch_.Humidity = 0.00;
+    epoch_.Pressure = 0.00;
+    epoch_.DewPoint = 0.00;
+    epoch_.HeatIndex = 0.00;
 
-        SetN2kPGN130316(N2kMsg, gN2KSID, instance_, gTempSource, CToKelvin(Temperature), N2kDoubleNA);
-        NMEA2000.SendMsg(N2kMsg, DeviceTemperature);
+    epoch_.Sample.timestamp = millis();
+    epoch_.Sample.valid = false;
+    if (sensor_.Present) {
+        sensor_.Bme.readSample(epoch_.Sample);
+    }
 
-        gTemperature = Temperature;
+    if (epoch_.Sample.valid) {
+        epoch_.Temperature = epoch_.Sample.temperature;
+        epoch_.Humidity = epoch_.Sample.humidity;
+        epoch_.Pressure = epoch_.Sample.pressure; // already in mBar
+        epoch_.DewPoint = calculateDewPoint(epoch_.Temperature, epoch_.Humidity);
+        epoch_.HeatIndex = calculateHeatIndex(epoch_.Temperature, epoch_.Humidity);
+    }
+    else {
+        WebSerial.println(F("Could not find a valid BME280 sensor, check wiring!"));
     }
 }
 
-void SendN2kHumidity(uint8_t instance_) {
-    tN2kMsg N2kMsg;
-    double Humidity = 0.00;
+// All measurement messages go through here, so every result is counted
+bool SendN2kMsg(const tN2kMsg& N2kMsg, uint8_t device_) {
+    bool result_ = NMEA2000.SendMsg(N2kMsg, device_);
+    gN2kStats.record(N2kMsg.PGN, device_, N2kMsg.DataLen, result_);
+    return result_;
+}
 
-    if (HumidityScheduler.IsTime()) {
-        HumidityScheduler.UpdateNextTime();
+// Value of a message in the unit of its PGN
+double TemplateValue(const tEpoch& epoch_, tN2kTemplateId id_) {
+    switch (id_) {
+    case TemplateTemperature:
+    case TemplateTemperatureExt: return CToKelvin(epoch_.Temperature);
+    case TemplateHumidity: return epoch_.Humidity;
+    case TemplatePressure: return mBarToPascal(epoch_.Pressure);
+    case TemplateHeatIndex:
+    case TemplateHeatIndexExt: return CToKelvin(epoch_.HeatIndex);
+    default: return CToKelvin(epoch_.DewPoint);
+    }
+}
 
-        if (gStatusSensor != "NOK") {
-            Humidity = bme.readHumidity();
+// Marks the PGNs of the epoch that changed or need a heartbeat.
+// They are sent in their slot, all with the SID of the epoch.
+void QueueEpoch(tSensorState& sensor_) {
+    const tEpoch& epoch_ = sensor_.Epoch;
+    ChannelTransmitter* transmitters_ = sensor_.Transmitters;
+    bool* pending_ = sensor_.Pending;
+    uint32_t now_ = epoch_.Sample.timestamp;
+
+    if (transmitters_[ChannelTemperature].due(epoch_.Temperature, now_)) {
+        pending_[TemplateTemperature] = true;
+        pending_[TemplateTemperatureExt] = true;
+    }
+    if (transmitters_[ChannelHumidity].due(epoch_.Humidity, now_)) {
+        pending_[TemplateHumidity] = true;
+    }
+    if (transmitters_[ChannelPressure].due(epoch_.Pressure, now_)) {
+        pending_[TemplatePressure] = true;
+    }
+    if (transmitters_[ChannelHeatIndex].due(epoch_.HeatIndex, now_)) {
+        pending_[TemplateHeatIndex] = true;
+        pending_[TemplateHeatIndexExt] = true;
+    }
+    if (transmitters_[ChannelDewPoint].due(epoch_.DewPoint, now_)) {
+        pending_[TemplateDewPoint] = true;
+        pending_[TemplateDewPointExt] = true;
+    }
+}
+
+// Queues the pending messages of the sensor that are planned up to this
+// slot. Earlier ones are only pending if loop() was late and skipped slots.
+void SendSlot(tSensorState& sensor_, uint8_t slot_) {
+    const tEpoch& epoch_ = sensor_.Epoch;
+    N2kTemplates& templates_ = sensor_.Templates;
+
+    for (uint8_t i = 0; i < TemplateCount; i++) {
+        if (!sensor_.Pending[i] || sensor_.Slots[i] > slot_) {
+            continue;
         }
-        SetN2kPGN130313(N2kMsg, gN2KSID, instance_, gHumiditySource, Humidity, N2kDoubleNA);
-        NMEA2000.SendMsg(N2kMsg, DeviceHumidity);
-        gHumidity = Humidity;
+        tN2kTemplateId id_ = tN2kTemplateId(i);
+        gOutbound.push(templates_.patch(id_, epoch_.SID, TemplateValue(epoch_, id_)), templates_.device(id_), i, epoch_.Sample.timestamp);
+        sensor_.Pending[i] = false;
+    }
+}
+
+void PublishEpoch(const tEpoch& epoch_) {
+    StatisticsData statistics_;
+    for (uint8_t i = 0; i < ChannelCount; i++) {
+        MinuteStats[i].summary(statistics_.Windows[i][WindowMinute]);
+        HourStats[i].summary(statistics_.Windows[i][WindowHour]);
+        DayStats[i].summary(statistics_.Windows[i][WindowDay]);
     }
+    gStatistics.publish(statistics_);
+
+    SensorData data_;
+
+    data_.timestamp = epoch_.Sample.timestamp;
+    data_.temperature = epoch_.Temperature;
+    data_.humidity = epoch_.Humidity;
+    data_.pressure = epoch_.Pressure;
+    data_.dewPoint = epoch_.DewPoint;
+    data_.heatIndex = epoch_.HeatIndex;
+    data_.tendency1h = Tendency.change1h();
+    data_.tendency3h = Tendency.change3h();
+    data_.tendency = Tendency.tendency();
+    data_.storm = StormAlertActive;
+
+    gSensorData.publish(data_);
 }
 
-void SendN2kPressure(uint8_t instance_) {
+void StatisticsJob() {
+    gN2kStats.update(millis());
+}
+
+void RecordEpoch(const tEpoch& epoch_) {
+    uint32_t now_ = epoch_.Sample.timestamp;
+
+    if (epoch_.Sample.valid) {
+        gHistory.add(epoch_.Temperature, epoch_.Humidity, epoch_.Pressure, now_);
+    }
+    else {
+        gHistory.add(NAN, NAN, NAN, now_);
+    }
+
+    double values_[ChannelCount];
+    values_[ChannelTemperature] = epoch_.Temperature;
+    values_[ChannelHumidity] = epoch_.Humidity;
+    values_[ChannelPressure] = epoch_.Pressure;
+    values_[ChannelDewPoint] = epoch_.DewPoint;
+    values_[ChannelHeatIndex] = epoch_.HeatIndex;
+
+    for (uint8_t i = 0; i < ChannelCount; i++) {
+        float value_ = epoch_.Sample.valid ? values_[i] : NAN;
+        MinuteStats[i].add(value_, now_);
+        HourStats[i].add(value_, now_);
+        DayStats[i].add(value_, now_);
+    }
+}
+
+void SendStormAlert() {
     tN2kMsg N2kMsg;
-    double Pressure = 0.00;
+    tN2kAlert alert_ = {};
+
+    alert_.Type = N2kAlertTypeWarning;
+    alert_.Category = N2kAlertCategoryNavigational;
+    alert_.Id = StormAlertId;
+    alert_.SourceName = NMEA2000.GetDeviceInformation(DevicePressure).GetName();
+    alert_.Instance = StormAlertInstance;
+    alert_.Occurrence = StormAlertOccurrence;
+    alert_.ThresholdStatus = StormAlertActive ? N2kAlertThresholdExceeded : N2kAlertThresholdNormal;
+    alert_.Priority = 0;
+    alert_.State = StormAlertActive ? N2kAlertStateActive : N2kAlertStateNormal;
+
+    SetN2kAlert(N2kMsg, alert_);
+    gOutbound.push(N2kMsg, DevicePressure, AlertKey, millis());
+}
 
-    if (PressureScheduler.IsTime()) {
-        PressureScheduler.UpdateNextTime();
-        if (gStatusSensor != "NOK") {
-            Pressure = bme.readPressure() / 100.0f;  // Read and convert to mBar 
+// Sender of the outbound queue
+bool SendQueued(const tN2kMsg& N2kMsg, uint8_t device_, uint32_t age_) {
+    bool result_ = SendN2kMsg(N2kMsg, device_);
+    if (result_) {
+        DIAG_VALUE(DiagQueueAge, age_);
+    }
+    return result_;
+}
+
+// Runs after every epoch, the tendency itself changes once per minute.
+// A change of the warning is sent at once.
+void UpdateTendency() {
+    if (!Tendency.update(gHistory)) {
+        return;
+    }
+
+    bool active_ = StormAlertEnabled && Tendency.storm();
+    if (active_ != StormAlertActive) {
+        StormAlertActive = active_;
+        if (active_) {
+            StormAlertOccurrence++;
         }
-        else {
-           WebSerial.println(F("Could not find a valid BME280 sensor, check wiring!"));
+        WebSerial.println(active_ ? F("Storm warning raised") : F("Storm warning cleared"));
+        SendStormAlert();
+    }
+}
+
+void AlertJob() {
+    if (StormAlertActive) {
+        SendStormAlert();
+    }
+}
+
+void TriggerJob() {
+    DIAG_VALUE(DiagTriggerLateness, Scheduler.lateness());
+
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        if (SensorStates[i].Present) {
+            SensorStates[i].Bme.trigger();
         }
-        SetN2kPGN130314(N2kMsg, gN2KSID, instance_, N2kps_Atmospheric, mBarToPascal(Pressure));
-        NMEA2000.SendMsg(N2kMsg, DevicePressure);
-        gPressure = Pressure;
     }
 }
 
-void SendN2KHeatIndexTemperature(double Temperatur_, double Humidity_, uint8_t instance_) {
-    tN2kMsg N2kMsg;
-	double _heatIndex = 0.00;
+// Programs the sensor and moves TriggerJob ahead of the epoch by the maximum
+// measurement time of the profile, rounded up to the next ms
+void ApplySamplingProfile(tBME280Profile samplingProfile_) {
+    const BME280Profile& profile_ = BME280GetProfile(samplingProfile_);
+    uint32_t lead_ = BME280MeasurementTime(profile_) / 1000 + 1;
+
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        if (SensorStates[i].Present) {
+            SensorStates[i].Bme.setProfile(profile_);
+        }
+    }
+    Scheduler.setOffset(TriggerJobId, EpochOffset - lead_);
+}
+
+// Plans the slots of all epoch messages and of the storm alert. Messages
+// planned beyond the epoch (budget too small) are sent in its last slot.
+void PlanBus() {
+    int8_t ids_[SENSOR_COUNT][TemplateCount];
+    bool complete_ = true;
+
+    Planner.clear();
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        for (uint8_t j = 0; j < TemplateCount; j++) {
+            ids_[i][j] = Planner.add(EpochPeriod, 1);
+            complete_ = complete_ && ids_[i][j] >= 0;
+        }
+    }
+    int8_t alert_ = Planner.add(AlertPeriod, N2kStatistics::frameCount(N2kAlertDataLen));
+    complete_ = complete_ && alert_ >= 0;
+
+    // A message without an entry would have no slot, the old plan stays
+    if (!complete_) {
+        WebSerial.printf("Bus plan has no entry for all %u messages\n", SENSOR_COUNT * TemplateCount + 1);
+        return;
+    }
 
-    if (HeatIndexScheduler.IsTime()) {
-        HeatIndexScheduler.UpdateNextTime();
+    if (!Planner.plan(SlotLength, BusBudget)) {
+        WebSerial.printf("Bus plan exceeds %u frames per slot\n", BusBudget);
+    }
 
-        if (gStatusSensor != "NOK") {
-			_heatIndex = heatIndexCelsius(Temperatur_, Humidity_);
-		}
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        for (uint8_t j = 0; j < TemplateCount; j++) {
+            uint16_t slot_ = Planner.slot(ids_[i][j]);
+            SensorStates[i].Slots[j] = slot_ < SlotsPerEpoch ? slot_ : SlotsPerEpoch - 1;
+        }
+    }
+    Scheduler.setOffset(AlertJobId, EpochOffset + Planner.offset(alert_));
+}
 
-        SetN2kPGN130312(N2kMsg, gN2KSID, instance_, N2kts_HeatIndexTemperature, CToKelvin(_heatIndex), N2kDoubleNA);
-        NMEA2000.SendMsg(N2kMsg, DeviceTemperature);
+// Rebuilds templates, transmit policies and the other state that depends on
+// the configuration. Runs in loop() when a new snapshot was published.
+void ApplyConfig(const ConfigSnapshot& config_) {
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        tSensorState& sensor_ = SensorStates[i];
+        tN2kTempSource tempSource_ = i == 0 ? config_.TempSource : Sensors[i].TempSource;
+        tN2kHumiditySource humiditySource_ = i == 0 ? config_.HumiditySource : Sensors[i].HumiditySource;
 
-        SetN2kPGN130316(N2kMsg, gN2KSID, instance_, N2kts_HeatIndexTemperature, CToKelvin(_heatIndex), N2kDoubleNA);
-        NMEA2000.SendMsg(N2kMsg, DeviceTemperature);
+        sensor_.Templates.build(config_.Instance + Sensors[i].InstanceOffset, tempSource_, humiditySource_, i * DevicesPerSensor);
 
-        gheatIndex = _heatIndex;
+        for (uint8_t j = 0; j < ChannelCount; j++) {
+            sensor_.Transmitters[j].setPolicy(config_.Policy[j]);
+            sensor_.Transmitters[j].setTolerance(EpochPeriod / 2);
+            sensor_.Transmitters[j].reset();
+        }
     }
+
+    Tendency.setStormThreshold(config_.StormThreshold);
+    StormAlertEnabled = config_.StormAlert;
+    StormAlertInstance = config_.Instance;
+    gOutbound.setMaxAge(config_.MaxAge);
+    ApplySamplingProfile(config_.SamplingProfile);
+    PlanBus();
 }
 
-void SendN2KDewPointTemperature(double Temperatur_, double Humidity_, uint8_t instance_) {
-    tN2kMsg N2kMsg;
-	double _dewPoint = 0.00;
+void EpochJob() {
+    DIAG_VALUE(DiagEpochLateness, Scheduler.lateness());
 
-    if (DewPointScheduler.IsTime()) {
-        DewPointScheduler.UpdateNextTime();
-		if (gStatusSensor != "NOK") {
-			_dewPoint = dewPoint(Temperatur_, Humidity_);
-		}
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        DIAG_START(acquireStart_);
+        AcquireEpoch(SensorStates[i]);
+        DIAG_RECORD(DiagAcquire, acquireStart_);
 
-        SetN2kPGN130312(N2kMsg, gN2KSID, instance_, N2kts_DewPointTemperature, CToKelvin(_dewPoint), N2kDoubleNA);
-        NMEA2000.SendMsg(N2kMsg, DeviceTemperature);
+        QueueEpoch(SensorStates[i]);
+    }
 
-        SetN2kPGN130316(N2kMsg, gN2KSID, instance_, N2kts_DewPointTemperature, CToKelvin(_dewPoint), N2kDoubleNA);
-        NMEA2000.SendMsg(N2kMsg, DeviceTemperature);
+    // web page, history and storm warning use the primary sensor
+    const tEpoch& primary_ = SensorStates[0].Epoch;
+    RecordEpoch(primary_);
+    UpdateTendency();
+    PublishEpoch(primary_);
+}
 
-        gdewPoint = _dewPoint;
+// Runs every slot. The first run of an epoch starts it, every slot queues
+// its messages. The slot follows from the deadline of the run, not from a
+// count of the runs: the scheduler runs a late job once for all the periods
+// it missed, a counter would then lag behind the plan from there on.
+void SlotJob() {
+    uint32_t slots_ = (Scheduler.deadline() - Scheduler.startTime() - EpochOffset) / SlotLength;
+    uint32_t epoch_ = slots_ / SlotsPerEpoch;
+    uint8_t slot_ = slots_ % SlotsPerEpoch;
+
+    if (epoch_ != CurrentEpoch) {
+        CurrentEpoch = epoch_;
+        EpochJob();
+    }
+
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        SendSlot(SensorStates[i], slot_);
     }
 }
 
 void loop() {
-    SendN2kTemperature(gN2KInstance);
-    SendN2kHumidity(gN2KInstance + 1);
-    SendN2kPressure(gN2KInstance + 2);
+    uint32_t start_ = micros();
+
+    // Arm before parsing, a frame arriving during the parse wakes us again
+    if (gCanRxNotification) {
+        gpio_intr_enable(ESP32_CAN_RX_PIN);
+    }
+
+    // A new configuration is applied as a whole before the jobs run
+    const ConfigSnapshot& config_ = gConfig.acquire();
+    if (gConfig.version() != AppliedConfigVersion) {
+        ApplyConfig(config_);
+        AppliedConfigVersion = gConfig.version();
+    }
+    gConfig.release();
 
-    SendN2KHeatIndexTemperature(gTemperature, gHumidity, gN2KInstance + 3);
-    SendN2KDewPointTemperature(gTemperature, gHumidity, gN2KInstance + 4);
+    Scheduler.run(millis());
 
+    DIAG_START(parseStart_);
     NMEA2000.ParseMessages();
+    DIAG_RECORD(DiagParse, parseStart_);
     CheckN2kSourceAddressChange();
 
-    gParamsChanged = false;
+    DIAG_START(sendStart_);
+    gOutbound.flush(SendQueued, millis(), BusBudget);
+    DIAG_RECORD(DiagSend, sendStart_);
 
     // Dummy to empty input buffer to avoid board to stuck with e.g. NMEA Reader
     if (Serial.available()) {
@@ -390,14 +733,35 @@ void loop() {
     }
 
     esp_task_wdt_reset();
+
+    uint32_t duration_ = micros() - start_;
+    gLoopTiming.Iterations.fetch_add(1, std::memory_order_relaxed);
+    gLoopTiming.LastDuration.store(duration_, std::memory_order_relaxed);
+    if (duration_ > gLoopTiming.MaxDuration.load(std::memory_order_relaxed)) {
+        gLoopTiming.MaxDuration.store(duration_, std::memory_order_relaxed);
+    }
+    DIAG_VALUE(DiagLoop, duration_);
+
+    // Sleep until the next job is due or a frame arrives
+    uint32_t wait_ = Scheduler.timeUntilNext(millis());
+    uint32_t maxWait_ = gCanRxNotification ? ProtocolInterval : PollInterval;
+    if (wait_ > maxWait_) {
+        wait_ = maxWait_;
+    }
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_));
 }
 
-void loop2(void* parameter) {
+void loop2(void* /* parameter */) {
     esp_task_wdt_add(NULL); //add current thread to WDT watch (Core 0)
     for (;;) {   // Endless loop
+        DIAG_START(loopStart_);
+
+        DIAG_START(wifiStart_);
         wifiLoop();
+        DIAG_RECORD(DiagWifiLoop, wifiStart_);
 
         esp_task_wdt_reset();
+        DIAG_RECORD(DiagLoop2, loopStart_);
 
         vTaskDelay(100);
     }
@@ -0,0 +1,113 @@
+// 
+// 
+// 
+
+#include "bme280burst.h"
+
+/*
+ * Initializes the sensor and keeps a copy of the trimming parameters,
+ * so the compensation does not need to touch the driver afterwards.
+ */
+bool BME280Burst::begin(uint8_t addr_, TwoWire* wire_) {
+	if (!Adafruit_BME280::begin(addr_, wire_)) {
+		return false;
+	}
+	copyCalibration();
+	return true;
+}
+
+/*
+ * Reads the data registers 0xF7..0xFE in one I2C transaction
+ */
+bool BME280Burst::readRaw(BME280RawData& raw_) {
+	uint8_t buffer_[BME280_BURST_LENGTH];
+	uint8_t register_ = BME280_BURST_REGISTER;
+
+	if (i2c_dev == NULL || !i2c_dev->write_then_read(&register_, 1, buffer_, BME280_BURST_LENGTH)) {
+		return false;
+	}
+
+	BME280UnpackRaw(buffer_, raw_);
+	_calib.t_fine_adjust = t_fine_adjust;
+	return true;
+}
+
+/*
+ * Reads press/temp/hum in one I2C transaction and compensates all three
+ * values from it. Returns false if the sensor did not answer.
+ */
+bool BME280Burst::readSample(BME280Sample& sample_) {
+	sample_.timestamp = millis();
+
+#if defined(BME280_FIXED_COMPENSATION)
+	BME280FixedSample fixed_;
+	readFixed(fixed_);
+	BME280FixedToSample(fixed_, sample_);
+#else
+	BME280RawData raw_;
+	if (!readRaw(raw_)) {
+		sample_.valid = false;
+		return false;
+	}
+	BME280Compensate(_calib, raw_, sample_);
+#endif
+
+	return sample_.valid;
+}
+
+bool BME280Burst::readFixed(BME280FixedSample& sample_) {
+	BME280RawData raw_;
+
+	if (!readRaw(raw_)) {
+		sample_.valid = false;
+		return false;
+	}
+
+	BME280CompensateFixed(_calib, raw_, sample_);
+	return sample_.valid;
+}
+
+void BME280Burst::setProfile(const BME280Profile& profile_) {
+	setSampling((sensor_mode)profile_.Mode,
+		(sensor_sampling)profile_.TemperatureOversampling,
+		(sensor_sampling)profile_.PressureOversampling,
+		(sensor_sampling)profile_.HumidityOversampling,
+		(sensor_filter)profile_.Filter,
+		(standby_duration)profile_.Standby);
+}
+
+/*
+ * Starts one conversion in forced mode and returns at once, unlike
+ * takeForcedMeasurement() which waits for the end of the conversion.
+ * The sensor goes back to sleep when the conversion is done.
+ */
+void BME280Burst::trigger() {
+	if (_measReg.mode == MODE_FORCED) {
+		write8(BME280_REGISTER_CONTROL, _measReg.get());
+	}
+}
+
+void BME280Burst::copyCalibration() {
+	_calib.dig_T1 = _bme280_calib.dig_T1;
+	_calib.dig_T2 = _bme280_calib.dig_T2;
+	_calib.dig_T3 = _bme280_calib.dig_T3;
+
+	_calib.dig_P1 = _bme280_calib.dig_P1;
+	_calib.dig_P2 = _bme280_calib.dig_P2;
+	_calib.dig_P3 = _bme280_calib.dig_P3;
+	_calib.dig_P4 = _bme280_calib.dig_P4;
+	_calib.dig_P5 = _bme280_calib.dig_P5;
+	_calib.dig_P6 = _bme280_calib.dig_P6;
+	_calib.dig_P7 = _bme280_calib.dig_P7;
+	_calib.dig_P8 = _bme280_calib.dig_P8;
+	_calib.dig_P9 = _bme280_calib.dig_P9;
+
+	_calib.dig_H1 = _bme280_calib.dig_H1;
+	_calib.dig_H2 = _bme280_calib.dig_H2;
+	_calib.dig_H3 = _bme280_calib.dig_H3;
+	_calib.dig_H4 = _bme280_calib.dig_H4;
+	_calib.dig_H5 = _bme280_calib.dig_H5;
+	_calib.dig_H6 = _bme280_calib.dig_H6;
+
+	_calib.t_fine_adjust = t_fine_adjust;
+}
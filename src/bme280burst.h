@@ -0,0 +1,50 @@
+// bme280burst.h
+
+#pragma once
+
+#ifndef _BME280BURST_h
+#define _BME280BURST_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <Adafruit_BME280.h>
+
+#include "bme280compensation.h"
+#include "bme280profile.h"
+
+// Uncomment to compensate with the integer algorithms of the datasheet instead
+// of the ones of the Adafruit driver. The results differ in the last digit.
+// #define BME280_FIXED_COMPENSATION
+
+// Adafruit_BME280 with a single burst read of all data registers.
+// readTemperature(), readHumidity() and readPressure() each need their own
+// I2C transactions and re-read the temperature for t_fine. readSample()
+// needs one transaction per cycle and all values come from the same conversion.
+class BME280Burst : public Adafruit_BME280 {
+public:
+    bool begin(uint8_t addr_ = BME280_ADDRESS, TwoWire* wire_ = &Wire);
+
+    bool readSample(BME280Sample& sample_);
+
+    // Burst read with the fixed-point results of the datasheet algorithms
+    bool readFixed(BME280FixedSample& sample_);
+
+    // Programs oversampling, filter and mode. In forced mode every
+    // conversion has to be started with trigger().
+    void setProfile(const BME280Profile& profile_);
+    void trigger();
+
+    const BME280Calibration& calibration() const { return _calib; };
+
+private:
+    bool readRaw(BME280RawData& raw_);
+    void copyCalibration();
+
+    BME280Calibration _calib = {};
+};
+
+#endif
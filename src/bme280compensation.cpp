@@ -0,0 +1,197 @@
+//
+//
+//
+
+#include "bme280compensation.h"
+
+#include <math.h>
+
+/*
+ * Splits the burst read of the data registers (0xF7..0xFE) into the
+ * 20 bit pressure and temperature and the 16 bit humidity ADC value.
+ */
+void BME280UnpackRaw(const uint8_t* buffer_, BME280RawData& raw_) {
+	raw_.adc_P = ((int32_t)buffer_[0] << 12) | ((int32_t)buffer_[1] << 4) | (buffer_[2] >> 4);
+	raw_.adc_T = ((int32_t)buffer_[3] << 12) | ((int32_t)buffer_[4] << 4) | (buffer_[5] >> 4);
+	raw_.adc_H = ((int32_t)buffer_[6] << 8) | buffer_[7];
+}
+
+/*
+ * Calculates t_fine from the raw temperature. The driver marks a skipped
+ * temperature measurement with 0x80000 (0x800000 before the shift).
+ */
+static bool compensateTFine(const BME280Calibration& calib_, int32_t adc_T, int32_t& t_fine) {
+	if (adc_T == 0x80000) {
+		return false;
+	}
+
+	int32_t var1 = (int32_t)((adc_T / 8) - ((int32_t)calib_.dig_T1 * 2));
+	var1 = (var1 * ((int32_t)calib_.dig_T2)) / 2048;
+	int32_t var2 = (int32_t)((adc_T / 16) - ((int32_t)calib_.dig_T1));
+	var2 = (((var2 * var2) / 4096) * ((int32_t)calib_.dig_T3)) / 16384;
+
+	t_fine = var1 + var2 + calib_.t_fine_adjust;
+	return true;
+}
+
+/*
+ * Returns the pressure in Pa, NAN if the pressure measurement was skipped.
+ */
+static float compensatePressure(const BME280Calibration& calib_, int32_t adc_P, int32_t t_fine) {
+	if (adc_P == 0x80000) {
+		return NAN;
+	}
+
+	int64_t var1 = ((int64_t)t_fine) - 128000;
+	int64_t var2 = var1 * var1 * (int64_t)calib_.dig_P6;
+	var2 = var2 + ((var1 * (int64_t)calib_.dig_P5) * 131072);
+	var2 = var2 + (((int64_t)calib_.dig_P4) * 34359738368);
+	var1 = ((var1 * var1 * (int64_t)calib_.dig_P3) / 256) + ((var1 * ((int64_t)calib_.dig_P2) * 4096));
+	int64_t var3 = ((int64_t)1) * 140737488355328;
+	var1 = (var3 + var1) * ((int64_t)calib_.dig_P1) / 8589934592;
+
+	if (var1 == 0) {
+		return 0; // avoid exception caused by division by zero
+	}
+
+	int64_t var4 = 1048576 - adc_P;
+	var4 = (((var4 * 2147483648) - var2) * 3125) / var1;
+	var1 = (((int64_t)calib_.dig_P9) * (var4 / 8192) * (var4 / 8192)) / 33554432;
+	var2 = (((int64_t)calib_.dig_P8) * var4) / 524288;
+	var4 = ((var4 + var1 + var2) / 256) + (((int64_t)calib_.dig_P7) * 16);
+
+	float P = var4 / 256.0;
+	return P;
+}
+
+/*
+ * Returns the relative humidity in %, NAN if the humidity measurement was skipped.
+ */
+static float compensateHumidity(const BME280Calibration& calib_, int32_t adc_H, int32_t t_fine) {
+	if (adc_H == 0x8000) {
+		return NAN;
+	}
+
+	int32_t var1 = t_fine - ((int32_t)76800);
+	int32_t var2 = (int32_t)(adc_H * 16384);
+	int32_t var3 = (int32_t)(((int32_t)calib_.dig_H4) * 1048576);
+	int32_t var4 = ((int32_t)calib_.dig_H5) * var1;
+	int32_t var5 = (((var2 - var3) - var4) + (int32_t)16384) / 32768;
+	var2 = (var1 * ((int32_t)calib_.dig_H6)) / 1024;
+	var3 = (var1 * ((int32_t)calib_.dig_H3)) / 2048;
+	var4 = ((var2 * (var3 + (int32_t)32768)) / 1024) + (int32_t)2097152;
+	var2 = ((var4 * ((int32_t)calib_.dig_H2)) + 8192) / 16384;
+	var3 = var5 * var2;
+	var4 = ((var3 / 32768) * (var3 / 32768)) / 128;
+	var5 = var3 - ((var4 * ((int32_t)calib_.dig_H1)) / 16);
+	var5 = (var5 < 0 ? 0 : var5);
+	var5 = (var5 > 419430400 ? 419430400 : var5);
+	uint32_t H = (uint32_t)(var5 / 4096);
+
+	return (float)H / 1024.0;
+}
+
+/*
+ * Compensates temperature, pressure and humidity of one conversion.
+ * The results are rounded to float like the Adafruit driver does, so the
+ * values are identical to the ones of the single channel reads.
+ */
+void BME280Compensate(const BME280Calibration& calib_, const BME280RawData& raw_, BME280Sample& sample_) {
+	int32_t t_fine = 0;
+
+	if (!compensateTFine(calib_, raw_.adc_T, t_fine)) {
+		sample_.temperature = NAN;
+		sample_.humidity = NAN;
+		sample_.pressure = NAN;
+		sample_.valid = false;
+		return;
+	}
+
+	int32_t T = (t_fine * 5 + 128) / 256;
+	sample_.temperature = (float)T / 100;
+	sample_.pressure = compensatePressure(calib_, raw_.adc_P, t_fine) / 100.0f; // Pa to mBar
+	sample_.humidity = compensateHumidity(calib_, raw_.adc_H, t_fine);
+	sample_.valid = true;
+}
+
+/*
+ * The datasheet versions shift signed values. A right shift of a negative
+ * int is arithmetic on the ESP32 compiler; left shifts are written as
+ * multiplications, which gives the same result without undefined behaviour.
+ */
+static int32_t fixedTFine(const BME280Calibration& calib_, int32_t adc_T) {
+	int32_t var1 = (((adc_T >> 3) - ((int32_t)calib_.dig_T1 * 2)) * ((int32_t)calib_.dig_T2)) >> 11;
+	int32_t var2 = (adc_T >> 4) - ((int32_t)calib_.dig_T1);
+	var2 = (((var2 * var2) >> 12) * ((int32_t)calib_.dig_T3)) >> 14;
+	return var1 + var2 + calib_.t_fine_adjust;
+}
+
+// Pa in Q24.8
+static uint32_t fixedPressure(const BME280Calibration& calib_, int32_t adc_P, int32_t t_fine) {
+	int64_t var1 = ((int64_t)t_fine) - 128000;
+	int64_t var2 = var1 * var1 * (int64_t)calib_.dig_P6;
+	var2 = var2 + ((var1 * (int64_t)calib_.dig_P5) * 131072);
+	var2 = var2 + (((int64_t)calib_.dig_P4) * 34359738368);
+	var1 = ((var1 * var1 * (int64_t)calib_.dig_P3) >> 8) + ((var1 * (int64_t)calib_.dig_P2) * 4096);
+	var1 = ((((int64_t)1) * 140737488355328 + var1) * ((int64_t)calib_.dig_P1)) >> 33;
+
+	if (var1 == 0) {
+		return 0; // avoid exception caused by division by zero
+	}
+
+	int64_t p = 1048576 - adc_P;
+	p = (((p * 2147483648) - var2) * 3125) / var1;
+	var1 = (((int64_t)calib_.dig_P9) * (p >> 13) * (p >> 13)) >> 25;
+	var2 = (((int64_t)calib_.dig_P8) * p) >> 19;
+	p = ((p + var1 + var2) >> 8) + (((int64_t)calib_.dig_P7) * 16);
+
+	return (uint32_t)p;
+}
+
+// %RH in Q22.10
+static uint32_t fixedHumidity(const BME280Calibration& calib_, int32_t adc_H, int32_t t_fine) {
+	int32_t v_x1 = t_fine - ((int32_t)76800);
+	v_x1 = ((((adc_H * 16384) - (((int32_t)calib_.dig_H4) * 1048576) - (((int32_t)calib_.dig_H5) * v_x1)) + ((int32_t)16384)) >> 15) *
+		(((((((v_x1 * ((int32_t)calib_.dig_H6)) >> 10) * (((v_x1 * ((int32_t)calib_.dig_H3)) >> 11) + ((int32_t)32768))) >> 10) + ((int32_t)2097152)) *
+			((int32_t)calib_.dig_H2) + 8192) >> 14);
+	v_x1 = v_x1 - (((((v_x1 >> 15) * (v_x1 >> 15)) >> 7) * ((int32_t)calib_.dig_H1)) >> 4);
+	v_x1 = (v_x1 < 0 ? 0 : v_x1);
+	v_x1 = (v_x1 > 419430400 ? 419430400 : v_x1);
+
+	return (uint32_t)(v_x1 >> 12);
+}
+
+void BME280CompensateFixed(const BME280Calibration& calib_, const BME280RawData& raw_, BME280FixedSample& sample_) {
+	sample_.temperature = 0;
+	sample_.pressure = BME280_FIXED_SKIPPED;
+	sample_.humidity = BME280_FIXED_SKIPPED;
+	sample_.valid = false;
+
+	if (raw_.adc_T == 0x80000) {
+		return;
+	}
+
+	int32_t t_fine = fixedTFine(calib_, raw_.adc_T);
+	sample_.temperature = (t_fine * 5 + 128) >> 8;
+	if (raw_.adc_P != 0x80000) {
+		sample_.pressure = fixedPressure(calib_, raw_.adc_P, t_fine);
+	}
+	if (raw_.adc_H != 0x8000) {
+		sample_.humidity = fixedHumidity(calib_, raw_.adc_H, t_fine);
+	}
+	sample_.valid = true;
+}
+
+void BME280FixedToSample(const BME280FixedSample& fixed_, BME280Sample& sample_) {
+	sample_.valid = fixed_.valid;
+	if (!fixed_.valid) {
+		sample_.temperature = NAN;
+		sample_.humidity = NAN;
+		sample_.pressure = NAN;
+		return;
+	}
+
+	sample_.temperature = fixed_.temperature / 100.0f;
+	sample_.pressure = fixed_.pressure == BME280_FIXED_SKIPPED ? NAN : fixed_.pressure / 25600.0f; // Q24.8 Pa to mBar
+	sample_.humidity = fixed_.humidity == BME280_FIXED_SKIPPED ? NAN : fixed_.humidity / 1024.0f;
+}
@@ -0,0 +1,82 @@
+// bme280compensation.h
+
+#pragma once
+
+#ifndef _BME280COMPENSATION_h
+#define _BME280COMPENSATION_h
+
+#include <stdint.h>
+
+// Raw data block 0xF7..0xFE: press_msb, press_lsb, press_xlsb, temp_msb, temp_lsb, temp_xlsb, hum_msb, hum_lsb
+#define BME280_BURST_REGISTER 0xF7
+#define BME280_BURST_LENGTH 8
+
+// Trimming parameters, copied once from the driver after begin()
+struct BME280Calibration {
+    uint16_t dig_T1;
+    int16_t dig_T2;
+    int16_t dig_T3;
+
+    uint16_t dig_P1;
+    int16_t dig_P2;
+    int16_t dig_P3;
+    int16_t dig_P4;
+    int16_t dig_P5;
+    int16_t dig_P6;
+    int16_t dig_P7;
+    int16_t dig_P8;
+    int16_t dig_P9;
+
+    uint8_t dig_H1;
+    int16_t dig_H2;
+    uint8_t dig_H3;
+    int16_t dig_H4;
+    int16_t dig_H5;
+    int8_t dig_H6;
+
+    int32_t t_fine_adjust;
+};
+
+// Uncompensated ADC values of one conversion
+struct BME280RawData {
+    int32_t adc_P;
+    int32_t adc_T;
+    int32_t adc_H;
+};
+
+// One compensated measurement. All channels come from the same conversion.
+struct BME280Sample {
+    uint32_t timestamp; // millis() when the burst was read
+    double temperature; // degree celsius
+    double humidity;    // %RH
+    double pressure;    // mBar
+    bool valid;
+};
+
+#define BME280_FIXED_SKIPPED 0xFFFFFFFF
+
+// One measurement in the fixed-point formats of the datasheet
+struct BME280FixedSample {
+    int32_t temperature; // 0.01 degree celsius
+    uint32_t pressure;   // Pa, Q24.8 (divide by 256)
+    uint32_t humidity;   // %RH, Q22.10 (divide by 1024)
+    bool valid;
+};
+
+// Splits the 8 byte burst into the three ADC values
+void BME280UnpackRaw(const uint8_t* buffer_, BME280RawData& raw_);
+
+// Compensates all channels from one raw read. The algorithms are the same as
+// Adafruit_BME280::readTemperature(), readPressure() and readHumidity(), but
+// t_fine is calculated only once.
+void BME280Compensate(const BME280Calibration& calib_, const BME280RawData& raw_, BME280Sample& sample_);
+
+// Integer compensation as in the Bosch datasheet (chapter 8.2): int32 for
+// temperature and humidity, int64 for pressure, shifts instead of divisions.
+// Skipped pressure and humidity are BME280_FIXED_SKIPPED.
+void BME280CompensateFixed(const BME280Calibration& calib_, const BME280RawData& raw_, BME280FixedSample& sample_);
+
+// Converts to degree celsius, %RH and mBar
+void BME280FixedToSample(const BME280FixedSample& fixed_, BME280Sample& sample_);
+
+#endif
@@ -0,0 +1,45 @@
+// 
+// 
+// 
+
+#include "bme280profile.h"
+
+/*
+ * weather station: forced mode, 1x oversampling, filter off (datasheet 3.5.1)
+ *     t_measure,max 9.3 ms, no self heating between the measurements
+ * indoor: forced mode, T 2x, P 4x, H 2x, filter x4
+ *     t_measure,max 20.8 ms
+ * low noise: normal mode, T 2x, P 16x, H 1x, filter x16, standby 62.5 ms
+ *     t_measure,max 46.1 ms, a new value every 108.6 ms
+ */
+static const BME280Profile Profiles[ProfileCount] = {
+	{ BME280_MODE_FORCED, 1, 1, 1, 0, 0 },
+	{ BME280_MODE_FORCED, 2, 3, 2, 2, 0 },
+	{ BME280_MODE_NORMAL, 2, 5, 1, 4, 1 }
+};
+
+const BME280Profile& BME280GetProfile(tBME280Profile profile_) {
+	return Profiles[profile_ < ProfileCount ? profile_ : ProfileWeatherStation];
+}
+
+// Number of samples of an oversampling code
+static uint32_t samples(uint8_t oversampling_) {
+	return oversampling_ == 0 ? 0 : 1UL << (oversampling_ - 1);
+}
+
+/*
+ * t_measure,max = 1.25 + 2.3 * T + (2.3 * P + 0.575) + (2.3 * H + 0.575) ms,
+ * the 0.575 ms are only needed when the channel is measured.
+ */
+uint32_t BME280MeasurementTime(const BME280Profile& profile_) {
+	uint32_t time_ = 1250 + 2300 * samples(profile_.TemperatureOversampling);
+
+	if (profile_.PressureOversampling != 0) {
+		time_ += 2300 * samples(profile_.PressureOversampling) + 575;
+	}
+	if (profile_.HumidityOversampling != 0) {
+		time_ += 2300 * samples(profile_.HumidityOversampling) + 575;
+	}
+
+	return time_;
+}
@@ -0,0 +1,39 @@
+// bme280profile.h
+
+#pragma once
+
+#ifndef _BME280PROFILE_h
+#define _BME280PROFILE_h
+
+#include <stdint.h>
+
+// Register codes as written to ctrl_meas, ctrl_hum and config. They are the
+// same values as the enums of Adafruit_BME280.
+#define BME280_MODE_FORCED 1
+#define BME280_MODE_NORMAL 3
+
+enum tBME280Profile : uint8_t {
+    ProfileWeatherStation = 0,
+    ProfileIndoor,
+    ProfileLowNoise,
+    ProfileCount
+};
+
+// Sampling settings of the sensor.
+// Oversampling code n means 2^(n-1) samples, 0 skips the channel.
+// Filter code n means coefficient 2^n, 0 is off.
+struct BME280Profile {
+    uint8_t Mode;
+    uint8_t TemperatureOversampling;
+    uint8_t PressureOversampling;
+    uint8_t HumidityOversampling;
+    uint8_t Filter;
+    uint8_t Standby; // t_sb code, only used in normal mode
+};
+
+const BME280Profile& BME280GetProfile(tBME280Profile profile_);
+
+// Maximum measurement time in us after a trigger (datasheet 9.1, t_measure,max)
+uint32_t BME280MeasurementTime(const BME280Profile& profile_);
+
+#endif
@@ -0,0 +1,149 @@
+// 
+// 
+// 
+
+#include "busplanner.h"
+
+#include <string.h>
+
+BusPlanner::BusPlanner() {
+	this->_slotLength = 1;
+	this->clear();
+}
+
+void BusPlanner::clear() {
+	this->_count = 0;
+	this->_cycle = 0;
+	this->_peak = 0;
+}
+
+int8_t BusPlanner::add(uint32_t period_, uint8_t frames_) {
+	if (this->_count >= MaxMessages || period_ == 0) {
+		return -1;
+	}
+
+	int8_t id_ = this->_count++;
+	this->_messages[id_].Period = period_;
+	this->_messages[id_].Frames = frames_;
+	this->_messages[id_].Slot = 0;
+	return id_;
+}
+
+static uint32_t gcd(uint32_t a_, uint32_t b_) {
+	while (b_ != 0) {
+		uint32_t t_ = a_ % b_;
+		a_ = b_;
+		b_ = t_;
+	}
+	return a_;
+}
+
+/*
+ * Greedy: the most frequent messages and among them the largest ones are
+ * placed first, so they get the early slots. A message goes to the earliest offset where all its occurrences in
+ * the cycle stay within the budget, so the values are sent as early as
+ * possible. A message larger than the budget goes to the earliest empty
+ * offset, without one to the offset with the lowest load.
+ */
+bool BusPlanner::plan(uint32_t slotLength_, uint8_t budget_) {
+	this->_slotLength = slotLength_ > 0 ? slotLength_ : 1;
+	this->_peak = 0;
+
+	// common period in slots
+	uint32_t cycle_ = 1;
+	bool fits_ = true;
+	for (uint8_t i = 0; i < this->_count; i++) {
+		uint32_t period_ = this->_messages[i].Period / this->_slotLength;
+		if (period_ == 0 || this->_messages[i].Period % this->_slotLength != 0) {
+			fits_ = false;
+			break;
+		}
+		cycle_ = cycle_ / gcd(cycle_, period_) * period_;
+		if (cycle_ > MaxSlots) {
+			fits_ = false;
+			break;
+		}
+	}
+	if (!fits_) {
+		for (uint8_t i = 0; i < this->_count; i++) {
+			this->_messages[i].Slot = 0;
+		}
+		this->_cycle = 0;
+		return false;
+	}
+
+	this->_cycle = (uint16_t)cycle_;
+	memset(this->_load, 0, sizeof(this->_load));
+
+	uint8_t order_[MaxMessages];
+	for (uint8_t i = 0; i < this->_count; i++) {
+		order_[i] = i;
+	}
+	for (uint8_t i = 1; i < this->_count; i++) {
+		uint8_t id_ = order_[i];
+		uint8_t j = i;
+		while (j > 0) {
+			const Message& a_ = this->_messages[id_];
+			const Message& b_ = this->_messages[order_[j - 1]];
+			if (a_.Period > b_.Period || (a_.Period == b_.Period && a_.Frames <= b_.Frames)) {
+				break;
+			}
+			order_[j] = order_[j - 1];
+			j--;
+		}
+		order_[j] = id_;
+	}
+
+	bool withinBudget_ = true;
+	for (uint8_t i = 0; i < this->_count; i++) {
+		Message& message_ = this->_messages[order_[i]];
+		uint16_t period_ = message_.Period / this->_slotLength;
+
+		uint16_t best_ = 0;
+		uint8_t bestLoad_ = 0xFF;
+		bool found_ = false;
+		for (uint16_t slot_ = 0; slot_ < period_; slot_++) {
+			uint8_t load_ = this->load(slot_, period_);
+			if (load_ + message_.Frames <= budget_ || load_ == 0) {
+				best_ = slot_;
+				found_ = true;
+				break;
+			}
+			if (load_ < bestLoad_) {
+				best_ = slot_;
+				bestLoad_ = load_;
+			}
+		}
+
+		if (!found_) {
+			withinBudget_ = false;
+		}
+		message_.Slot = best_;
+		this->place(best_, period_, message_.Frames);
+	}
+
+	for (uint16_t i = 0; i < this->_cycle; i++) {
+		if (this->_load[i] > this->_peak) {
+			this->_peak = this->_load[i];
+		}
+	}
+	return withinBudget_;
+}
+
+// Highest load of the slots where a message at slot_ with period_ is sent
+uint8_t BusPlanner::load(uint16_t slot_, uint16_t period_) const {
+	uint8_t max_ = 0;
+	for (uint16_t i = slot_; i < this->_cycle; i += period_) {
+		if (this->_load[i] > max_) {
+			max_ = this->_load[i];
+		}
+	}
+	return max_;
+}
+
+void BusPlanner::place(uint16_t slot_, uint16_t period_, uint8_t frames_) {
+	for (uint16_t i = slot_; i < this->_cycle; i += period_) {
+		uint16_t load_ = this->_load[i] + frames_;
+		this->_load[i] = load_ > 0xFF ? 0xFF : (uint8_t)load_;
+	}
+}
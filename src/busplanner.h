@@ -0,0 +1,57 @@
+// busplanner.h
+
+#pragma once
+
+#ifndef _BUSPLANNER_h
+#define _BUSPLANNER_h
+
+#include <stdint.h>
+
+// Spreads periodic messages over time slots, so that the node puts at most
+// a budget of CAN frames on the bus per slot. Every message gets an offset
+// (in slots) from the start of the cycle, it is then sent every period from
+// there. Periods have to be multiples of the slot length.
+class BusPlanner {
+public:
+    static const uint8_t MaxMessages = 33; // 8 messages of each of up to 4 sensors and the storm alert
+    static const uint16_t MaxSlots = 512; // slots in the common period of all messages
+
+    BusPlanner();
+
+    void clear();
+
+    // Returns the message id, -1 if there is no free entry
+    int8_t add(uint32_t period_, uint8_t frames_);
+
+    // Assigns the offsets. Returns false if the periods do not fit the slot
+    // length or MaxSlots, or if the budget cannot be met; the offsets are
+    // usable anyway then.
+    bool plan(uint32_t slotLength_, uint8_t budget_);
+
+    uint16_t slot(uint8_t id_) const { return _messages[id_].Slot; };
+    uint32_t offset(uint8_t id_) const { return _messages[id_].Slot * _slotLength; };
+
+    // Most frames in one slot of the plan. Only a message larger than the
+    // budget exceeds it, it is then alone in its slot.
+    uint8_t peak() const { return _peak; };
+
+private:
+    struct Message {
+        uint32_t Period; // ms
+        uint8_t Frames;
+        uint16_t Slot;
+    };
+
+    uint8_t load(uint16_t slot_, uint16_t period_) const;
+    void place(uint16_t slot_, uint16_t period_, uint8_t frames_);
+
+    Message _messages[MaxMessages];
+    uint8_t _count;
+
+    uint32_t _slotLength;
+    uint16_t _cycle;            // slots of the common period
+    uint8_t _load[MaxSlots];    // frames per slot of the cycle
+    uint8_t _peak;
+};
+
+#endif
@@ -21,26 +21,98 @@ extern String gStatusSensor;
 #include "N2kMsg.h"
 #include "N2kTypes.h"
 
+// Number of BME280 on this node (1..4), see Sensors[] in the sketch
+#ifndef SENSOR_COUNT
+#define SENSOR_COUNT 1
+#endif
+
+// Virtual NMEA 2000 devices of a sensor. The devices of sensor n are
+// n * DevicesPerSensor + DeviceTemperature/Pressure/Humidity.
 #define DeviceTemperature 0
 #define DevicePressure 1
 #define DeviceHumidity 2
+#define DevicesPerSensor 3
+#define DeviceCount (SENSOR_COUNT * DevicesPerSensor)
 
-extern uint8_t gN2KInstance;
-extern uint8_t gN2KSID;
+// Source addresses, owned by loop() after the start
 extern uint8_t gN2KSource[];
 
-extern tN2kTempSource gTempSource;
-extern tN2kHumiditySource gHumiditySource;
+#include <atomic>
+
+#include "seqlock.h"
+#include "txpolicy.h"
+#include "n2kstats.h"
+#include "outbound.h"
+#include "history.h"
+#include "tendency.h"
+#include "streamstats.h"
+#include "bme280profile.h"
+#include "snapshot.h"
+
+extern N2kStatistics gN2kStats;
+extern History gHistory;
+
+// The web configuration as used by loop(). convertParams() builds a new
+// snapshot and publishes it as a whole, loop() applies it when the version changes.
+struct ConfigSnapshot {
+    uint8_t Instance;
+    uint8_t SID;                 // start value
+    tN2kTempSource TempSource;
+    tN2kHumiditySource HumiditySource;
+    uint8_t Sources[DeviceCount]; // stored source addresses, used at the start
+    TransmitPolicy Policy[ChannelCount];
+    uint32_t MaxAge;             // ms, older values are not sent any more
+    double StormThreshold;       // mBar per 3 h
+    bool StormAlert;
+    tBME280Profile SamplingProfile;
+};
+
+extern SnapshotStore<ConfigSnapshot> gConfig;
+
+// Values of one measurement as they are shown on the web page.
+// Written by loop() (core 1), read by the web server.
+struct SensorData {
+    uint32_t timestamp; // millis() of the measurement
+    double temperature;
+    double humidity;
+    double pressure;
+    double dewPoint;
+    double heatIndex;
+    double tendency1h;  // mBar
+    double tendency3h;  // mBar
+    tTendency tendency;
+    bool storm;
+};
+
+extern SeqLock<SensorData> gSensorData;
+
+// Min, max, mean and standard deviation per channel over the last minute, hour and day.
+// Published before the measurement it contains, so it is never older than gSensorData.
+struct StatisticsData {
+    StatisticsSummary Windows[ChannelCount][WindowCount];
+};
+
+extern SeqLock<StatisticsData> gStatistics;
+
+// Timing of loop() without the sleep, written by loop() and read by the web server
+struct LoopTiming {
+    std::atomic<uint32_t> Iterations{ 0 };
+    std::atomic<uint32_t> LastDuration{ 0 }; // us
+    std::atomic<uint32_t> MaxDuration{ 0 };  // us
+};
+
+extern LoopTiming gLoopTiming;
+
+// Tasks of loop() and loop2, for the stack high-water marks
+extern TaskHandle_t N2kTaskHandle;
+extern TaskHandle_t TaskHandle;
 
-extern double gTemperature;
-extern double gHumidity;
-extern double gPressure;
-extern double gdewPoint;
-extern double gheatIndex;
+// Measurement and alert messages on their way to the bus, owned by loop()
+extern OutboundQueue gOutbound;
 
 extern char Version[];
 
-extern bool gParamsChanged;
-extern bool gSaveParams;
+// Set by loop() when a source address changed, taken by wifiLoop() on the other core
+extern std::atomic<bool> gSaveParams;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,93 @@
+// 
+// 
+// 
+
+#include "derived.h"
+
+#include <math.h>
+
+// Define a function to calculate the dew point
+double dewPoint(double temp_celsius, double humidity) {
+    const double a = 17.27;
+    const double b = 237.7;
+    double alpha = ((a * temp_celsius) / (b + temp_celsius)) + log(humidity / 100.0);
+    return (b * alpha) / (a - alpha);
+
+}
+
+// This function takes the temperature in Celsius and the relative humidity in percentage
+// and returns the heat index temperature in Celsius
+double heatIndexCelsius(double temp_celsius, double humidity) {
+    // These are the constants used in the formula
+    const double c1 = -42.379;
+    const double c2 = 2.04901523;
+    const double c3 = 10.14333127;
+    const double c4 = -0.22475541;
+    const double c5 = -0.00683783;
+    const double c6 = -0.05481717;
+    const double c7 = 0.00122874;
+    const double c8 = 0.00085282;
+    const double c9 = -0.00000199;
+
+    // Convert the temperature from Celsius to Fahrenheit
+    double temp_fahrenheit = temp_celsius * 9.0 / 5.0 + 32;
+
+    // Calculate the heat index in Fahrenheit
+    double heat_fahrenheit = c1 + c2 * temp_fahrenheit + c3 * humidity + c4 * temp_fahrenheit * humidity + c5 * temp_fahrenheit * temp_fahrenheit + c6 * humidity * humidity + c7 * temp_fahrenheit * temp_fahrenheit * humidity + c8 * temp_fahrenheit * humidity * humidity + c9 * temp_fahrenheit * temp_fahrenheit * humidity * humidity;
+
+    // Convert the heat index from Fahrenheit to Celsius
+    double heat_celsius = (heat_fahrenheit - 32) * 5.0 / 9.0;
+
+    // Return the result
+    return heat_celsius;
+}
+
+/*
+ * log(x) = e * ln(2) + log(m) with x = m * 2^e and m in [sqrt(0.5), sqrt(2)).
+ * log(m) = 2 * atanh(s) with s = (m - 1) / (m + 1), |s| <= 0.172, so four
+ * terms of the series are enough for float.
+ */
+float fastLog(float x) {
+    if (!(x > 0)) {
+        return x == 0 ? -INFINITY : NAN;
+    }
+    if (isinf(x)) {
+        return x;
+    }
+
+    int e_;
+    float m_ = frexpf(x, &e_); // m_ in [0.5, 1)
+    if (m_ < 0.70710678f) {
+        m_ *= 2.0f;
+        e_--;
+    }
+
+    float s_ = (m_ - 1.0f) / (m_ + 1.0f);
+    float s2_ = s_ * s_;
+    float series_ = s_ * (2.0f + s2_ * (2.0f / 3.0f + s2_ * (2.0f / 5.0f + s2_ * (2.0f / 7.0f))));
+
+    return e_ * 0.69314718f + series_;
+}
+
+float dewPointFast(float temp_celsius, float humidity) {
+    const float a = 17.27f;
+    const float b = 237.7f;
+    float alpha = ((a * temp_celsius) / (b + temp_celsius)) + fastLog(humidity / 100.0f);
+    return (b * alpha) / (a - alpha);
+}
+
+/*
+ * Same regression as heatIndexCelsius(), grouped by powers of the humidity
+ * and evaluated with Horner's scheme.
+ */
+float heatIndexCelsiusFast(float temp_celsius, float humidity) {
+    float t = temp_celsius * 1.8f + 32.0f;
+
+    float r0 = -42.379f + t * (2.04901523f + t * -0.00683783f);
+    float r1 = 10.14333127f + t * (-0.22475541f + t * 0.00122874f);
+    float r2 = -0.05481717f + t * (0.00085282f + t * -0.00000199f);
+
+    float heat_fahrenheit = r0 + humidity * (r1 + humidity * r2);
+
+    return (heat_fahrenheit - 32.0f) * (5.0f / 9.0f);
+}
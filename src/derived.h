@@ -0,0 +1,45 @@
+// derived.h
+
+#pragma once
+
+#ifndef _DERIVED_h
+#define _DERIVED_h
+
+// Values calculated from temperature (degree celsius) and relative humidity (%)
+
+// Comment out to calculate with the double versions. The ESP32 has a single
+// precision FPU only, double math is done in software.
+#define DERIVED_FLOAT
+
+// Dew point in degree celsius (Magnus formula), double reference
+double dewPoint(double temp_celsius, double humidity);
+
+// Heat index ("feels like") in degree celsius (Rothfusz regression), double reference
+double heatIndexCelsius(double temp_celsius, double humidity);
+
+// Single precision versions. Against the double versions the error is below
+// 3e-5 (dew point) and 4e-4 (heat index) degree celsius for -40..85 degree
+// celsius and 1..100 %RH, swept by test/test_derived.cpp.
+float dewPointFast(float temp_celsius, float humidity);
+float heatIndexCelsiusFast(float temp_celsius, float humidity);
+
+// Natural logarithm in single precision, error below 2e-7 (relative for |log x| > 1)
+float fastLog(float x);
+
+inline double calculateDewPoint(double temp_celsius, double humidity) {
+#if defined(DERIVED_FLOAT)
+    return dewPointFast(temp_celsius, humidity);
+#else
+    return dewPoint(temp_celsius, humidity);
+#endif
+}
+
+inline double calculateHeatIndex(double temp_celsius, double humidity) {
+#if defined(DERIVED_FLOAT)
+    return heatIndexCelsiusFast(temp_celsius, humidity);
+#else
+    return heatIndexCelsius(temp_celsius, humidity);
+#endif
+}
+
+#endif
@@ -0,0 +1,87 @@
+// 
+// 
+// 
+
+#include "diagnostics.h"
+
+Diagnostics gDiagnostics;
+
+LatencyHistogram::LatencyHistogram() {
+	this->reset();
+}
+
+void LatencyHistogram::reset() {
+	for (uint8_t i = 0; i < Buckets; i++) {
+		this->_buckets[i].store(0, std::memory_order_relaxed);
+	}
+	this->_count.store(0, std::memory_order_relaxed);
+	this->_max.store(0, std::memory_order_relaxed);
+}
+
+/*
+ * Only one task records into a histogram, so load and store are enough.
+ */
+void LatencyHistogram::record(uint32_t value_) {
+	std::atomic<uint32_t>& bucket_ = this->_buckets[bucketOf(value_)];
+	bucket_.store(bucket_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	this->_count.store(this->_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	if (value_ > this->_max.load(std::memory_order_relaxed)) {
+		this->_max.store(value_, std::memory_order_relaxed);
+	}
+}
+
+// Number of significant bits, 0 for 0
+uint8_t LatencyHistogram::bucketOf(uint32_t value_) {
+	return value_ == 0 ? 0 : 32 - __builtin_clz(value_);
+}
+
+uint32_t LatencyHistogram::upperBound(uint8_t bucket_) {
+	return bucket_ >= 32 ? 0xFFFFFFFF : (1UL << bucket_) - 1;
+}
+
+/*
+ * Walks the buckets until the share is reached. The result is the upper
+ * bound of that bucket, but never more than the maximum seen. A share
+ * outside of 0..1 is clamped, the cast of the target would overflow.
+ */
+uint32_t LatencyHistogram::percentile(double p_) const {
+	uint32_t count_ = this->count();
+	if (count_ == 0) {
+		return 0;
+	}
+
+	p_ = p_ < 0 ? 0 : (p_ > 1 ? 1 : p_);
+	uint32_t target_ = (uint32_t)(p_ * count_ + 0.5);
+	if (target_ < 1) {
+		target_ = 1;
+	}
+
+	uint32_t sum_ = 0;
+	for (uint8_t i = 0; i < Buckets; i++) {
+		sum_ += this->bucket(i);
+		if (sum_ >= target_) {
+			uint32_t bound_ = upperBound(i);
+			return bound_ < this->max() ? bound_ : this->max();
+		}
+	}
+	return this->max();
+}
+
+const char* Diagnostics::name(tDiagPhase phase_) {
+	switch (phase_) {
+	case DiagLoop: return "loop";
+	case DiagLoop2: return "loop2";
+	case DiagAcquire: return "acquire";
+	case DiagSend: return "send";
+	case DiagParse: return "parse";
+	case DiagWifiLoop: return "wifiLoop";
+	case DiagTriggerLateness: return "triggerLateness";
+	case DiagEpochLateness: return "epochLateness";
+	case DiagQueueAge: return "queueAge";
+	default: return "";
+	}
+}
+
+const char* Diagnostics::unit(tDiagPhase phase_) {
+	return phase_ == DiagTriggerLateness || phase_ == DiagEpochLateness || phase_ == DiagQueueAge ? "ms" : "us";
+}
@@ -0,0 +1,75 @@
+// diagnostics.h
+
+#pragma once
+
+#ifndef _DIAGNOSTICS_h
+#define _DIAGNOSTICS_h
+
+#include <stdint.h>
+#include <atomic>
+
+// Comment out to remove the timing histograms. The DIAG_ macros are empty
+// then and /diagnostics answers with 404.
+#define DIAGNOSTICS
+
+// Durations in powers of two. Bucket 0 counts 0, bucket n counts the values
+// from 2^(n-1) to 2^n - 1. Written by one task, read by the web server.
+class LatencyHistogram {
+public:
+    static const uint8_t Buckets = 33;
+
+    LatencyHistogram();
+
+    void record(uint32_t value_);
+    void reset();
+
+    uint32_t count() const { return _count.load(std::memory_order_relaxed); };
+    uint32_t max() const { return _max.load(std::memory_order_relaxed); };
+    uint32_t bucket(uint8_t bucket_) const { return _buckets[bucket_].load(std::memory_order_relaxed); };
+
+    // Upper bound of the bucket that contains the share p_ (0..1) of the values
+    uint32_t percentile(double p_) const;
+
+    static uint8_t bucketOf(uint32_t value_);
+    static uint32_t upperBound(uint8_t bucket_);
+
+private:
+    std::atomic<uint32_t> _buckets[Buckets];
+    std::atomic<uint32_t> _count;
+    std::atomic<uint32_t> _max;
+};
+
+// Measured phases. The durations are in us, the lateness in ms.
+enum tDiagPhase : uint8_t {
+    DiagLoop = 0,        // one loop() iteration without the sleep
+    DiagLoop2,           // one loop2 iteration without the delay
+    DiagAcquire,         // AcquireEpoch() of all sensors
+    DiagSend,            // sending the queued messages
+    DiagParse,           // NMEA2000.ParseMessages()
+    DiagWifiLoop,        // wifiLoop()
+    DiagTriggerLateness, // start of TriggerJob after its deadline
+    DiagEpochLateness,   // start of the epoch (slot 0) after its deadline
+    DiagQueueAge,        // age of a value when it is sent
+    DiagPhaseCount
+};
+
+struct Diagnostics {
+    LatencyHistogram Phases[DiagPhaseCount];
+
+    static const char* name(tDiagPhase phase_);
+    static const char* unit(tDiagPhase phase_);
+};
+
+extern Diagnostics gDiagnostics;
+
+#ifdef DIAGNOSTICS
+#define DIAG_START(start_) uint32_t start_ = micros()
+#define DIAG_RECORD(phase_, start_) gDiagnostics.Phases[phase_].record(micros() - (start_))
+#define DIAG_VALUE(phase_, value_) gDiagnostics.Phases[phase_].record(value_)
+#else
+#define DIAG_START(start_)
+#define DIAG_RECORD(phase_, start_)
+#define DIAG_VALUE(phase_, value_)
+#endif
+
+#endif
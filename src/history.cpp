@@ -0,0 +1,128 @@
+// 
+// 
+// 
+
+#include "history.h"
+
+#include <math.h>
+
+#if defined(ESP32)
+#define HISTORY_LOCK() portENTER_CRITICAL(&this->_mux)
+#define HISTORY_UNLOCK() portEXIT_CRITICAL(&this->_mux)
+#else
+#define HISTORY_LOCK()
+#define HISTORY_UNLOCK()
+#endif
+
+History::History() {
+	this->_count = 0;
+	this->_started = false;
+	this->_minuteStart = 0;
+	for (uint8_t i = 0; i < 3; i++) {
+		this->_sum[i] = 0;
+		this->_samples[i] = 0;
+	}
+}
+
+/*
+ * Accumulates the measurement into the running minute. When a minute is
+ * over its mean is stored, gaps of several minutes are stored as missing.
+ */
+void History::add(double temperature_, double humidity_, double pressure_, uint32_t now_) {
+	if (!this->_started) {
+		this->_minuteStart = now_;
+		this->_started = true;
+	}
+
+	while (now_ - this->_minuteStart >= Interval) {
+		this->close();
+		this->_minuteStart += Interval;
+	}
+
+	const double values_[3] = { temperature_, humidity_, pressure_ };
+	for (uint8_t i = 0; i < 3; i++) {
+		if (!isnan(values_[i])) {
+			this->_sum[i] += values_[i];
+			this->_samples[i]++;
+		}
+	}
+}
+
+uint32_t History::first() const {
+	HISTORY_LOCK();
+	uint32_t count_ = this->_count;
+	HISTORY_UNLOCK();
+	return count_ > Size ? count_ - Size : 0;
+}
+
+uint32_t History::end() const {
+	HISTORY_LOCK();
+	uint32_t count_ = this->_count;
+	HISTORY_UNLOCK();
+	return count_;
+}
+
+/*
+ * Copies an entry. Returns false if the entry is not stored (any more).
+ */
+bool History::get(uint32_t index_, HistoryEntry& entry_) const {
+	bool valid_ = false;
+
+	HISTORY_LOCK();
+	if (index_ < this->_count && this->_count - index_ <= Size) {
+		entry_ = this->_entries[index_ % Size];
+		valid_ = true;
+	}
+	HISTORY_UNLOCK();
+
+	return valid_;
+}
+
+double History::temperature(const HistoryEntry& entry_) {
+	return entry_.Temperature == HistoryMissingTemperature ? NAN : entry_.Temperature / 100.0;
+}
+
+double History::humidity(const HistoryEntry& entry_) {
+	return entry_.Humidity == HistoryMissingValue ? NAN : entry_.Humidity / 100.0;
+}
+
+double History::pressure(const HistoryEntry& entry_) {
+	return entry_.Pressure == HistoryMissingValue ? NAN : entry_.Pressure / 10.0 + HistoryPressureOffset;
+}
+
+// Rounds to the next step and limits to the range of the field
+static int32_t quantize(double value_, double scale_, int32_t min_, int32_t max_) {
+	double scaled_ = floor(value_ * scale_ + 0.5);
+	if (scaled_ < min_) {
+		return min_;
+	}
+	if (scaled_ > max_) {
+		return max_;
+	}
+	return (int32_t)scaled_;
+}
+
+void History::close() {
+	HistoryEntry entry_;
+
+	entry_.Temperature = this->_samples[0] == 0 ? HistoryMissingTemperature :
+		(int16_t)quantize(this->_sum[0] / this->_samples[0], 100.0, INT16_MIN + 1, INT16_MAX);
+	entry_.Humidity = this->_samples[1] == 0 ? HistoryMissingValue :
+		(uint16_t)quantize(this->_sum[1] / this->_samples[1], 100.0, 0, HistoryMissingValue - 1);
+	entry_.Pressure = this->_samples[2] == 0 ? HistoryMissingValue :
+		(uint16_t)quantize(this->_sum[2] / this->_samples[2] - HistoryPressureOffset, 10.0, 0, HistoryMissingValue - 1);
+
+	for (uint8_t i = 0; i < 3; i++) {
+		this->_sum[i] = 0;
+		this->_samples[i] = 0;
+	}
+
+	this->push(entry_);
+}
+
+void History::push(const HistoryEntry& entry_) {
+	HISTORY_LOCK();
+	this->_entries[this->_count % Size] = entry_;
+	this->_count++;
+	HISTORY_UNLOCK();
+}
@@ -0,0 +1,68 @@
+// history.h
+
+#pragma once
+
+#ifndef _HISTORY_h
+#define _HISTORY_h
+
+#include <stdint.h>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#endif
+
+// One minute of history, quantized to 6 bytes
+struct HistoryEntry {
+    int16_t Temperature; // 0.01 degree celsius
+    uint16_t Humidity;   // 0.01 %
+    uint16_t Pressure;   // 0.1 mBar above HistoryPressureOffset
+};
+static_assert(sizeof(HistoryEntry) == 6, "a history entry has to stay 6 bytes, 24 h are 8640 bytes");
+
+#define HistoryMissingTemperature INT16_MIN
+#define HistoryMissingValue 0xFFFF
+#define HistoryPressureOffset 300.0
+
+// Ring buffer with the mean values of the last 24 hours at 1 minute resolution.
+// add() is called by the measurement task, get() from the web server.
+// Entries are addressed by an absolute index that keeps counting after the wraparound.
+class History {
+public:
+    static const uint16_t Size = 1440;        // 24 h
+    static const uint32_t Interval = 60000;   // ms per entry
+
+    History();
+
+    // Adds a measurement to the running minute. NAN values are ignored.
+    // Minutes without any value are stored as missing.
+    void add(double temperature_, double humidity_, double pressure_, uint32_t now_);
+
+    // Index of the oldest stored entry and one past the newest
+    uint32_t first() const;
+    uint32_t end() const;
+
+    bool get(uint32_t index_, HistoryEntry& entry_) const;
+
+    static double temperature(const HistoryEntry& entry_);
+    static double humidity(const HistoryEntry& entry_);
+    static double pressure(const HistoryEntry& entry_);
+
+private:
+    void close();
+    void push(const HistoryEntry& entry_);
+
+    HistoryEntry _entries[Size];
+    uint32_t _count;
+
+    // running minute
+    bool _started;
+    uint32_t _minuteStart;
+    double _sum[3];
+    uint16_t _samples[3];
+
+#if defined(ESP32)
+    mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+};
+
+#endif
@@ -0,0 +1,23 @@
+// 
+// 
+// 
+
+#include "n2kalert.h"
+
+void SetN2kAlert(tN2kMsg& N2kMsg, const tN2kAlert& alert_) {
+	N2kMsg.SetPGN(126983L);
+	N2kMsg.Priority = 2;
+	N2kMsg.AddByte((alert_.Type & 0x0F) | (alert_.Category << 4));
+	N2kMsg.AddByte(alert_.System);
+	N2kMsg.AddByte(alert_.SubSystem);
+	N2kMsg.Add2ByteUInt(alert_.Id);
+	N2kMsg.AddUInt64(alert_.SourceName);
+	N2kMsg.AddByte(alert_.Instance);
+	N2kMsg.AddByte(alert_.Index);
+	N2kMsg.AddByte(alert_.Occurrence);
+	N2kMsg.AddByte(0xC0); // silence, acknowledge and escalation neither active nor supported
+	N2kMsg.AddUInt64(0xFFFFFFFFFFFFFFFFULL); // not acknowledged
+	N2kMsg.AddByte(N2kAlertTriggerAuto | (alert_.ThresholdStatus << 4));
+	N2kMsg.AddByte(alert_.Priority);
+	N2kMsg.AddByte(alert_.State);
+}
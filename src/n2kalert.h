@@ -0,0 +1,40 @@
+// n2kalert.h
+
+#pragma once
+
+#ifndef _N2KALERT_h
+#define _N2KALERT_h
+
+#include <stdint.h>
+#include <N2kMsg.h>
+
+// Fields of PGN 126983 (Alert) that this device uses. It does not support
+// silencing, acknowledging or escalation.
+struct tN2kAlert {
+    uint8_t Type;            // 1 emergency alarm, 2 alarm, 5 warning, 8 caution
+    uint8_t Category;        // 0 navigational, 1 technical
+    uint8_t System;
+    uint8_t SubSystem;
+    uint16_t Id;
+    uint64_t SourceName;     // NAME of the device that raises the alert
+    uint8_t Instance;
+    uint8_t Index;
+    uint8_t Occurrence;      // counts up every time the alert becomes active
+    uint8_t ThresholdStatus; // 0 normal, 1 threshold exceeded
+    uint8_t Priority;
+    uint8_t State;           // 1 normal, 2 active
+};
+
+#define N2kAlertTypeWarning 5
+#define N2kAlertCategoryNavigational 0
+#define N2kAlertTriggerAuto 1
+#define N2kAlertThresholdNormal 0
+#define N2kAlertThresholdExceeded 1
+#define N2kAlertStateNormal 1
+#define N2kAlertStateActive 2
+
+// Alert status, 28 bytes, fast packet
+#define N2kAlertDataLen 28
+void SetN2kAlert(tN2kMsg& N2kMsg, const tN2kAlert& alert_);
+
+#endif
@@ -0,0 +1,86 @@
+// 
+// 
+// 
+
+#include "n2kstats.h"
+
+// Extended CAN frame without data and bit stuffing: SOF, 29 bit id, SRR, IDE, RTR,
+// r1, r0, DLC, CRC with delimiter, ACK, EOF and interframe space
+#define CAN_FRAME_OVERHEAD_BITS 67
+
+bool N2kStatistics::addPGN(uint32_t pgn_) {
+	for (uint8_t i = 0; i < this->_pgnCount; i++) {
+		if (this->_pgns[i] == pgn_) {
+			return true;
+		}
+	}
+	if (this->_pgnCount >= MaxPGNs) {
+		return false;
+	}
+	this->_pgns[this->_pgnCount++] = pgn_;
+	return true;
+}
+
+uint32_t N2kStatistics::frameCount(int dataLen_) {
+	if (dataLen_ <= 8) {
+		return 1;
+	}
+	// first fast packet frame carries 6 data bytes, the following 7 each
+	return 1 + (dataLen_ - 6 + 6) / 7;
+}
+
+void N2kStatistics::add(N2kCounters& counters_, uint32_t frames_, int dataLen_, bool success_) {
+	counters_.Attempted.fetch_add(1, std::memory_order_relaxed);
+	if (success_) {
+		counters_.Succeeded.fetch_add(1, std::memory_order_relaxed);
+		counters_.Frames.fetch_add(frames_, std::memory_order_relaxed);
+		counters_.Bytes.fetch_add(dataLen_, std::memory_order_relaxed);
+	}
+	else {
+		counters_.Failed.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+/*
+ * Records one SendMsg() result. Frames and bytes are only counted for
+ * messages that were accepted by the library.
+ */
+void N2kStatistics::record(uint32_t pgn_, uint8_t device_, int dataLen_, bool success_) {
+	uint32_t frames_ = frameCount(dataLen_);
+
+	for (uint8_t i = 0; i < this->_pgnCount; i++) {
+		if (this->_pgns[i] == pgn_) {
+			add(this->_pgnCounters[i], frames_, dataLen_, success_);
+			break;
+		}
+	}
+
+	if (device_ < MaxDevices) {
+		add(this->_deviceCounters[device_], frames_, dataLen_, success_);
+	}
+
+	add(this->_total, frames_, dataLen_, success_);
+}
+
+/*
+ * Calculates the frame rate since the last update and the share of the bus
+ * this node uses. Fast packet frames are always 8 bytes long.
+ */
+void N2kStatistics::update(uint32_t now_) {
+	uint32_t elapsed_ = now_ - this->_lastUpdate;
+	if (elapsed_ == 0) {
+		return;
+	}
+
+	uint32_t frames_ = this->_total.Frames.load(std::memory_order_relaxed);
+	uint32_t delta_ = frames_ - this->_lastFrames;
+
+	float framesPerSecond_ = delta_ * 1000.0f / elapsed_;
+	float bitsPerSecond_ = framesPerSecond_ * (CAN_FRAME_OVERHEAD_BITS + 64);
+
+	this->_framesPerSecond.store(framesPerSecond_, std::memory_order_relaxed);
+	this->_busLoad.store(bitsPerSecond_ * 100.0f / BusBitrate, std::memory_order_relaxed);
+
+	this->_lastFrames = frames_;
+	this->_lastUpdate = now_;
+}
@@ -0,0 +1,67 @@
+// n2kstats.h
+
+#pragma once
+
+#ifndef _N2KSTATS_h
+#define _N2KSTATS_h
+
+#include <stdint.h>
+#include <atomic>
+
+// Send counters of one PGN or one virtual device
+struct N2kCounters {
+    std::atomic<uint32_t> Attempted{ 0 };
+    std::atomic<uint32_t> Succeeded{ 0 };
+    std::atomic<uint32_t> Failed{ 0 };
+    std::atomic<uint32_t> Frames{ 0 };
+    std::atomic<uint32_t> Bytes{ 0 };
+};
+
+// Counts the results of NMEA2000.SendMsg() per PGN and per virtual device.
+// record() is called from the transmit path only: no locks, no allocation.
+// Other tasks may read the counters at any time.
+class N2kStatistics {
+public:
+    static const uint8_t MaxPGNs = 8;
+    static const uint8_t MaxDevices = 12;
+
+    // Bitrate of NMEA 2000
+    static const uint32_t BusBitrate = 250000;
+
+    // Call during setup, before the first record()
+    bool addPGN(uint32_t pgn_);
+
+    void record(uint32_t pgn_, uint8_t device_, int dataLen_, bool success_);
+
+    // Call about once per second from the transmit task
+    void update(uint32_t now_);
+
+    uint8_t pgnCount() const { return _pgnCount; };
+    uint32_t pgn(uint8_t index_) const { return _pgns[index_]; };
+    const N2kCounters& pgnCounters(uint8_t index_) const { return _pgnCounters[index_]; };
+    const N2kCounters& deviceCounters(uint8_t device_) const { return _deviceCounters[device_]; };
+    const N2kCounters& total() const { return _total; };
+
+    float framesPerSecond() const { return _framesPerSecond.load(std::memory_order_relaxed); };
+    float busLoad() const { return _busLoad.load(std::memory_order_relaxed); }; // %
+
+    // Number of CAN frames for a message, more than 8 bytes are sent as fast packet
+    static uint32_t frameCount(int dataLen_);
+
+private:
+    static void add(N2kCounters& counters_, uint32_t frames_, int dataLen_, bool success_);
+
+    uint32_t _pgns[MaxPGNs] = {};
+    uint8_t _pgnCount = 0;
+
+    N2kCounters _pgnCounters[MaxPGNs];
+    N2kCounters _deviceCounters[MaxDevices];
+    N2kCounters _total;
+
+    uint32_t _lastUpdate = 0;
+    uint32_t _lastFrames = 0;
+    std::atomic<float> _framesPerSecond{ 0 };
+    std::atomic<float> _busLoad{ 0 };
+};
+
+#endif
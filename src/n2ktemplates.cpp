@@ -0,0 +1,110 @@
+// 
+// 
+// 
+
+#include "n2ktemplates.h"
+#include "common.h"
+
+// SID and instance are the first two bytes of all four PGNs, the value starts after the source
+#define TEMPLATE_SID_INDEX 0
+#define TEMPLATE_VALUE_INDEX 3
+
+/*
+ * Encodes all messages of one epoch with the library encoders. That
+ * patching gives the same bytes as the library is checked by the host
+ * tests (test/test_n2ktemplates.cpp) over the whole value range.
+ */
+void N2kTemplates::build(uint8_t instance_, tN2kTempSource tempSource_, tN2kHumiditySource humiditySource_, uint8_t deviceBase_) {
+	this->_instance = instance_;
+	this->_tempSource = tempSource_;
+	this->_humiditySource = humiditySource_;
+
+	this->setup(TemplateTemperature, deviceBase_ + DeviceTemperature, Encoding2ByteUDouble001);
+	this->setup(TemplateTemperatureExt, deviceBase_ + DeviceTemperature, Encoding3ByteUDouble0001);
+	this->setup(TemplateHumidity, deviceBase_ + DeviceHumidity, Encoding2ByteDouble0004);
+	this->setup(TemplatePressure, deviceBase_ + DevicePressure, Encoding4ByteDouble01);
+	this->setup(TemplateHeatIndex, deviceBase_ + DeviceTemperature, Encoding2ByteUDouble001);
+	this->setup(TemplateHeatIndexExt, deviceBase_ + DeviceTemperature, Encoding3ByteUDouble0001);
+	this->setup(TemplateDewPoint, deviceBase_ + DeviceTemperature, Encoding2ByteUDouble001);
+	this->setup(TemplateDewPointExt, deviceBase_ + DeviceTemperature, Encoding3ByteUDouble0001);
+}
+
+const tN2kMsg& N2kTemplates::patch(tN2kTemplateId id_, uint8_t sid_, double value_) {
+	tN2kTemplate& template_ = this->_templates[id_];
+
+	this->patchInto(template_, sid_, value_);
+	return template_.Msg;
+}
+
+void N2kTemplates::setup(tN2kTemplateId id_, uint8_t device_, tValueEncoding encoding_) {
+	tN2kTemplate& template_ = this->_templates[id_];
+
+	template_.Device = device_;
+	template_.ValueIndex = TEMPLATE_VALUE_INDEX;
+	template_.Encoding = encoding_;
+
+	this->encode(id_, template_.Msg, 0, N2kDoubleNA);
+}
+
+/*
+ * Complete encoding with the library, used to build the templates
+ */
+void N2kTemplates::encode(tN2kTemplateId id_, tN2kMsg& msg_, uint8_t sid_, double value_) {
+	switch (id_) {
+	case TemplateTemperature:
+		SetN2kPGN130312(msg_, sid_, this->_instance, this->_tempSource, value_, N2kDoubleNA);
+		break;
+	case TemplateTemperatureExt:
+		SetN2kPGN130316(msg_, sid_, this->_instance, this->_tempSource, value_, N2kDoubleNA);
+		break;
+	case TemplateHumidity:
+		SetN2kPGN130313(msg_, sid_, this->_instance + 1, this->_humiditySource, value_, N2kDoubleNA);
+		break;
+	case TemplatePressure:
+		SetN2kPGN130314(msg_, sid_, this->_instance + 2, N2kps_Atmospheric, value_);
+		break;
+	case TemplateHeatIndex:
+		SetN2kPGN130312(msg_, sid_, this->_instance + 3, N2kts_HeatIndexTemperature, value_, N2kDoubleNA);
+		break;
+	case TemplateHeatIndexExt:
+		SetN2kPGN130316(msg_, sid_, this->_instance + 3, N2kts_HeatIndexTemperature, value_, N2kDoubleNA);
+		break;
+	case TemplateDewPoint:
+		SetN2kPGN130312(msg_, sid_, this->_instance + 4, N2kts_DewPointTemperature, value_, N2kDoubleNA);
+		break;
+	case TemplateDewPointExt:
+		SetN2kPGN130316(msg_, sid_, this->_instance + 4, N2kts_DewPointTemperature, value_, N2kDoubleNA);
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Rewinds DataLen to the value field and encodes only the value again.
+ * The bytes after the value stay as they were built.
+ */
+void N2kTemplates::patchInto(tN2kTemplate& template_, uint8_t sid_, double value_) {
+	tN2kMsg& msg_ = template_.Msg;
+	int dataLen_ = msg_.DataLen;
+
+	msg_.Data[TEMPLATE_SID_INDEX] = sid_;
+	msg_.DataLen = template_.ValueIndex;
+
+	switch (template_.Encoding) {
+	case Encoding2ByteUDouble001:
+		msg_.Add2ByteUDouble(value_, 0.01);
+		break;
+	case Encoding3ByteUDouble0001:
+		msg_.Add3ByteUDouble(value_, 0.001);
+		break;
+	case Encoding2ByteDouble0004:
+		msg_.Add2ByteDouble(value_, 0.004);
+		break;
+	case Encoding4ByteDouble01:
+		msg_.Add4ByteDouble(value_, 0.1);
+		break;
+	}
+
+	msg_.DataLen = dataLen_;
+}
@@ -0,0 +1,69 @@
+// n2ktemplates.h
+
+#pragma once
+
+#ifndef _N2KTEMPLATES_h
+#define _N2KTEMPLATES_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <N2kMessages.h>
+
+// Messages of one epoch
+enum tN2kTemplateId : uint8_t {
+    TemplateTemperature = 0,    // 130312
+    TemplateTemperatureExt,     // 130316
+    TemplateHumidity,           // 130313
+    TemplatePressure,           // 130314
+    TemplateHeatIndex,          // 130312
+    TemplateHeatIndexExt,       // 130316
+    TemplateDewPoint,           // 130312
+    TemplateDewPointExt,        // 130316
+    TemplateCount
+};
+
+// Prebuilt messages. Header, instance and source bytes are encoded once
+// when the configuration changes. A send only patches the SID and the
+// measured value, using the same encoder as the library.
+class N2kTemplates {
+public:
+    // deviceBase_ is the first virtual device of the sensor
+    void build(uint8_t instance_, tN2kTempSource tempSource_, tN2kHumiditySource humiditySource_, uint8_t deviceBase_ = 0);
+
+    // value_ in the unit of the PGN: Kelvin, % or Pascal
+    const tN2kMsg& patch(tN2kTemplateId id_, uint8_t sid_, double value_);
+
+    uint8_t device(tN2kTemplateId id_) const { return _templates[id_].Device; };
+
+private:
+    enum tValueEncoding : uint8_t {
+        Encoding2ByteUDouble001,   // 130312 actual temperature
+        Encoding3ByteUDouble0001,  // 130316 actual temperature
+        Encoding2ByteDouble0004,   // 130313 actual humidity
+        Encoding4ByteDouble01      // 130314 actual pressure
+    };
+
+    struct tN2kTemplate {
+        tN2kMsg Msg;
+        uint8_t Device;
+        uint8_t ValueIndex;
+        tValueEncoding Encoding;
+    };
+
+    void encode(tN2kTemplateId id_, tN2kMsg& msg_, uint8_t sid_, double value_);
+    void patchInto(tN2kTemplate& template_, uint8_t sid_, double value_);
+
+    void setup(tN2kTemplateId id_, uint8_t device_, tValueEncoding encoding_);
+
+    tN2kTemplate _templates[TemplateCount];
+
+    uint8_t _instance;
+    tN2kTempSource _tempSource;
+    tN2kHumiditySource _humiditySource;
+};
+
+#endif
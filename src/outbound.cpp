@@ -0,0 +1,124 @@
+// 
+// 
+// 
+
+#include "outbound.h"
+#include "n2kstats.h"
+
+OutboundQueue::OutboundQueue() {
+	for (uint8_t i = 0; i < Size; i++) {
+		this->_entries[i].Used = false;
+	}
+	this->_maxAge = 1000;
+	this->_pending.store(0, std::memory_order_relaxed);
+	this->_coalesced.store(0, std::memory_order_relaxed);
+	this->_stale.store(0, std::memory_order_relaxed);
+	this->_dropped.store(0, std::memory_order_relaxed);
+}
+
+// Only loop() writes the counters, so load and store are enough
+void OutboundQueue::increment(std::atomic<uint32_t>& counter_) {
+	counter_.store(counter_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// a_ is sent before b_: lower N2k priority value, then the older value
+bool OutboundQueue::before(const Entry& a_, const Entry& b_) const {
+	if (a_.Msg.Priority != b_.Msg.Priority) {
+		return a_.Msg.Priority < b_.Msg.Priority;
+	}
+	return (int32_t)(a_.Time - b_.Time) < 0;
+}
+
+int8_t OutboundQueue::next() const {
+	int8_t next_ = -1;
+	for (uint8_t i = 0; i < Size; i++) {
+		if (this->_entries[i].Used && (next_ < 0 || this->before(this->_entries[i], this->_entries[next_]))) {
+			next_ = i;
+		}
+	}
+	return next_;
+}
+
+void OutboundQueue::release(Entry& entry_) {
+	entry_.Used = false;
+	this->_pending.store(this->_pending.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+}
+
+/*
+ * Replaces the pending message of the same channel. Without one a free
+ * entry is used, a full queue gives up the entry that would be sent last.
+ */
+bool OutboundQueue::push(const tN2kMsg& msg_, uint8_t device_, uint8_t key_, uint32_t time_) {
+	int8_t free_ = -1;
+	int8_t last_ = -1;
+
+	for (uint8_t i = 0; i < Size; i++) {
+		Entry& entry_ = this->_entries[i];
+		if (!entry_.Used) {
+			if (free_ < 0) {
+				free_ = i;
+			}
+			continue;
+		}
+		if (entry_.Msg.PGN == msg_.PGN && entry_.Device == device_ && entry_.Key == key_) {
+			entry_.Msg = msg_;
+			entry_.Time = time_;
+			increment(this->_coalesced);
+			return true;
+		}
+		if (last_ < 0 || this->before(this->_entries[last_], entry_)) {
+			last_ = i;
+		}
+	}
+
+	bool kept_ = true;
+	if (free_ < 0) {
+		free_ = last_;
+		this->release(this->_entries[free_]);
+		increment(this->_dropped);
+		kept_ = false;
+	}
+
+	Entry& entry_ = this->_entries[free_];
+	entry_.Msg = msg_;
+	entry_.Device = device_;
+	entry_.Key = key_;
+	entry_.Time = time_;
+	entry_.Used = true;
+	this->_pending.store(this->_pending.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	return kept_;
+}
+
+/*
+ * Stale messages are dropped without counting against the frames.
+ */
+uint8_t OutboundQueue::flush(tSender sender_, uint32_t now_, uint8_t maxFrames_) {
+	uint8_t frames_ = 0;
+
+	for (;;) {
+		int8_t next_ = this->next();
+		if (next_ < 0) {
+			break;
+		}
+
+		Entry& entry_ = this->_entries[next_];
+		uint32_t age_ = now_ - entry_.Time;
+		if (age_ > this->_maxAge) {
+			this->release(entry_);
+			increment(this->_stale);
+			continue;
+		}
+
+		uint8_t msgFrames_ = (uint8_t)N2kStatistics::frameCount(entry_.Msg.DataLen);
+		if (frames_ > 0 && frames_ + msgFrames_ > maxFrames_) {
+			break;
+		}
+		if (!sender_(entry_.Msg, entry_.Device, age_)) {
+			break;
+		}
+		this->release(entry_);
+		frames_ += msgFrames_;
+	}
+
+	return frames_;
+}
@@ -0,0 +1,67 @@
+// outbound.h
+
+#pragma once
+
+#ifndef _OUTBOUND_h
+#define _OUTBOUND_h
+
+#include <stdint.h>
+#include <atomic>
+
+#include <N2kMsg.h>
+
+// Pending measurement and alert messages in front of NMEA2000.SendMsg().
+// A message replaces a pending one with the same PGN, device (source) and
+// key, so only the newest value of a channel waits. flush() sends the most
+// important messages first (lowest N2k priority, then the oldest) and drops
+// messages older than the maximal age instead of sending stale values.
+// push() and flush() are called from loop() only, the counters may be read
+// from other tasks.
+class OutboundQueue {
+public:
+    static const uint8_t Size = 33; // an epoch of up to 4 sensors with 8 messages each and the storm alert
+
+    // age_ is the time since the value was taken, in ms
+    typedef bool (*tSender)(const tN2kMsg& msg_, uint8_t device_, uint32_t age_);
+
+    OutboundQueue();
+
+    void setMaxAge(uint32_t maxAge_) { _maxAge = maxAge_; };
+
+    // time_ is when the value was taken. Returns false if an older message
+    // with a lower priority had to be dropped for it.
+    bool push(const tN2kMsg& msg_, uint8_t device_, uint8_t key_, uint32_t time_);
+
+    // Sends up to maxFrames_ CAN frames, at least one message. Stops at the
+    // first failed send, the message stays queued then. Returns the frames sent.
+    uint8_t flush(tSender sender_, uint32_t now_, uint8_t maxFrames_);
+
+    uint8_t pending() const { return _pending.load(std::memory_order_relaxed); };
+    uint32_t coalesced() const { return _coalesced.load(std::memory_order_relaxed); };
+    uint32_t stale() const { return _stale.load(std::memory_order_relaxed); };
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); };
+
+private:
+    struct Entry {
+        tN2kMsg Msg;
+        uint8_t Device;
+        uint8_t Key;
+        uint32_t Time;
+        bool Used;
+    };
+
+    bool before(const Entry& a_, const Entry& b_) const;
+    int8_t next() const;
+    void release(Entry& entry_);
+    static void increment(std::atomic<uint32_t>& counter_);
+
+    Entry _entries[Size];
+    uint32_t _maxAge;
+
+    std::atomic<uint8_t> _pending;
+    std::atomic<uint32_t> _coalesced; // replaced by a newer value
+    std::atomic<uint32_t> _stale;     // older than the maximal age
+    std::atomic<uint32_t> _dropped;   // no space left
+};
+
+#endif
@@ -0,0 +1,157 @@
+// 
+// 
+// 
+
+#include "scheduler.h"
+
+DeadlineScheduler::DeadlineScheduler() {
+	this->_count = 0;
+	this->_started = false;
+	this->_lateness = 0;
+	this->_deadline = 0;
+	this->_startTime = 0;
+}
+
+/*
+ * Adds a periodic job. The first deadline is offset ms after start(),
+ * after that the job runs every period ms on a fixed grid.
+ */
+int8_t DeadlineScheduler::add(tJobCallback callback_, uint32_t period_, uint32_t offset_) {
+	if (this->_count >= MaxJobs || callback_ == nullptr || period_ == 0) {
+		return -1;
+	}
+
+	uint8_t id_ = this->_count;
+	this->_jobs[id_].callback = callback_;
+	this->_jobs[id_].period = period_;
+	this->_jobs[id_].offset = offset_;
+	this->_jobs[id_].deadline = offset_;
+	this->_heap[id_] = id_;
+	this->_count++;
+
+	return id_;
+}
+
+/*
+ * Changes the period of a job. The new period is used after the next run.
+ */
+void DeadlineScheduler::setPeriod(int8_t id_, uint32_t period_) {
+	if (id_ < 0 || id_ >= this->_count || period_ == 0) {
+		return;
+	}
+	this->_jobs[id_].period = period_;
+}
+
+/*
+ * Moves a job on its grid. A started job keeps its period and is shifted
+ * by the difference to the old offset.
+ */
+void DeadlineScheduler::setOffset(int8_t id_, uint32_t offset_) {
+	if (id_ < 0 || id_ >= this->_count) {
+		return;
+	}
+
+	Job& job_ = this->_jobs[id_];
+	job_.deadline += offset_ - job_.offset;
+	job_.offset = offset_;
+	this->rebuild();
+}
+
+void DeadlineScheduler::start(uint32_t now_) {
+	for (uint8_t i = 0; i < this->_count; i++) {
+		this->_jobs[i].deadline = now_ + this->_jobs[i].offset;
+	}
+	this->rebuild();
+	this->_startTime = now_;
+	this->_started = true;
+}
+
+void DeadlineScheduler::stop() {
+	this->_started = false;
+}
+
+/*
+ * Runs every job whose deadline has passed. A job that missed several
+ * periods runs only once and then continues on its grid.
+ */
+uint32_t DeadlineScheduler::run(uint32_t now_) {
+	if (!this->_started || this->_count == 0) {
+		return Idle;
+	}
+
+	while ((int32_t)(now_ - this->_jobs[this->_heap[0]].deadline) >= 0) {
+		Job& job_ = this->_jobs[this->_heap[0]];
+		this->_lateness = now_ - job_.deadline;
+
+		do {
+			job_.deadline += job_.period;
+		} while ((int32_t)(now_ - job_.deadline) >= 0);
+		this->_deadline = job_.deadline - job_.period;
+
+		this->siftDown(0);
+		job_.callback();
+	}
+
+	return this->timeUntilNext(now_);
+}
+
+uint32_t DeadlineScheduler::nextDeadline() const {
+	return this->_jobs[this->_heap[0]].deadline;
+}
+
+uint32_t DeadlineScheduler::timeUntilNext(uint32_t now_) const {
+	if (!this->_started || this->_count == 0) {
+		return Idle;
+	}
+
+	int32_t wait_ = (int32_t)(this->nextDeadline() - now_);
+	return wait_ > 0 ? (uint32_t)wait_ : 0;
+}
+
+// Compares deadlines, also across the millis() overflow
+bool DeadlineScheduler::before(uint8_t a_, uint8_t b_) const {
+	return (int32_t)(this->_jobs[a_].deadline - this->_jobs[b_].deadline) < 0;
+}
+
+void DeadlineScheduler::siftUp(uint8_t pos_) {
+	while (pos_ > 0) {
+		uint8_t parent_ = (pos_ - 1) / 2;
+		if (!this->before(this->_heap[pos_], this->_heap[parent_])) {
+			break;
+		}
+		uint8_t tmp_ = this->_heap[pos_];
+		this->_heap[pos_] = this->_heap[parent_];
+		this->_heap[parent_] = tmp_;
+		pos_ = parent_;
+	}
+}
+
+void DeadlineScheduler::siftDown(uint8_t pos_) {
+	for (;;) {
+		uint8_t smallest_ = pos_;
+		uint8_t left_ = 2 * pos_ + 1;
+		uint8_t right_ = left_ + 1;
+
+		if (left_ < this->_count && this->before(this->_heap[left_], this->_heap[smallest_])) {
+			smallest_ = left_;
+		}
+		if (right_ < this->_count && this->before(this->_heap[right_], this->_heap[smallest_])) {
+			smallest_ = right_;
+		}
+		if (smallest_ == pos_) {
+			break;
+		}
+
+		uint8_t tmp_ = this->_heap[pos_];
+		this->_heap[pos_] = this->_heap[smallest_];
+		this->_heap[smallest_] = tmp_;
+		pos_ = smallest_;
+	}
+}
+
+void DeadlineScheduler::rebuild() {
+	for (uint8_t i = 0; i < this->_count; i++) {
+		this->_heap[i] = i;
+		this->siftUp(i);
+	}
+}
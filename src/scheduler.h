@@ -0,0 +1,68 @@
+// scheduler.h
+
+#pragma once
+
+#ifndef _SCHEDULER_h
+#define _SCHEDULER_h
+
+#include <stdint.h>
+
+typedef void (*tJobCallback)();
+
+// Periodic jobs, kept in a min-heap ordered by their next deadline.
+// The caller passes the time in, so run() tells how long the task can sleep
+// until the earliest job is due instead of polling every job.
+class DeadlineScheduler {
+public:
+    static const uint8_t MaxJobs = 8;
+    static const uint32_t Idle = 0xFFFFFFFF;
+
+    DeadlineScheduler();
+
+    // Returns the job id, -1 if there is no free slot
+    int8_t add(tJobCallback callback_, uint32_t period_, uint32_t offset_);
+    void setPeriod(int8_t id_, uint32_t period_);
+    void setOffset(int8_t id_, uint32_t offset_);
+
+    // Jobs become due offset ms after start
+    void start(uint32_t now_);
+    void stop();
+    bool started() const { return _started; };
+
+    // Runs all jobs that are due and returns the ms until the next deadline
+    uint32_t run(uint32_t now_);
+
+    // How late the running job was started, in ms. Valid inside the callback.
+    uint32_t lateness() const { return _lateness; };
+    // The point of its grid the running job stands for: the latest of its
+    // deadlines that passed, missed ones are skipped. Valid inside the callback.
+    uint32_t deadline() const { return _deadline; };
+    // The time passed to start()
+    uint32_t startTime() const { return _startTime; };
+
+    uint32_t nextDeadline() const;
+    uint32_t timeUntilNext(uint32_t now_) const;
+
+private:
+    struct Job {
+        tJobCallback callback;
+        uint32_t period;
+        uint32_t offset;
+        uint32_t deadline;
+    };
+
+    bool before(uint8_t a_, uint8_t b_) const;
+    void siftUp(uint8_t pos_);
+    void siftDown(uint8_t pos_);
+    void rebuild();
+
+    Job _jobs[MaxJobs];
+    uint8_t _heap[MaxJobs];
+    uint8_t _count;
+    bool _started;
+    uint32_t _lateness;
+    uint32_t _deadline;
+    uint32_t _startTime;
+};
+
+#endif
@@ -0,0 +1,95 @@
+// seqlock.h
+
+#pragma once
+
+#ifndef _SEQLOCK_h
+#define _SEQLOCK_h
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#endif
+
+// Sequence lock for one writer and any number of readers on other cores.
+// The writer never blocks. A reader copies the value and retries if the
+// writer was active in the meantime, so it always gets one complete value.
+// The value is stored as 32 bit words, which the ESP32 reads and writes atomically.
+// On the ESP32 the write runs in a critical section. Otherwise a reader with a
+// higher priority on the same core could preempt the writer and spin forever.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable type");
+
+public:
+    SeqLock() {
+        for (size_t i = 0; i < Words; i++) {
+            _words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Only one task may publish
+    void publish(const T& value_) {
+        uint32_t buffer_[Words] = {};
+        memcpy(buffer_, &value_, sizeof(T));
+
+#if defined(ESP32)
+        portENTER_CRITICAL(&_mux);
+#endif
+        uint32_t seq_ = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq_ + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < Words; i++) {
+            _words[i].store(buffer_[i], std::memory_order_relaxed);
+        }
+
+        _seq.store(seq_ + 2, std::memory_order_release);
+#if defined(ESP32)
+        portEXIT_CRITICAL(&_mux);
+#endif
+    }
+
+    // Returns the sequence number of the copied value. 0 means nothing was published yet.
+    uint32_t read(T& value_) const {
+        uint32_t buffer_[Words];
+        uint32_t seq1_;
+        uint32_t seq2_;
+
+        do {
+            seq1_ = _seq.load(std::memory_order_acquire);
+            while (seq1_ & 1) {
+                seq1_ = _seq.load(std::memory_order_acquire);
+            }
+
+            for (size_t i = 0; i < Words; i++) {
+                buffer_[i] = _words[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            seq2_ = _seq.load(std::memory_order_relaxed);
+        } while (seq1_ != seq2_);
+
+        memcpy(&value_, buffer_, sizeof(T));
+        return seq1_ / 2;
+    }
+
+    // Number of published values
+    uint32_t sequence() const {
+        return _seq.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static const size_t Words = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> _seq{ 0 };
+    std::atomic<uint32_t> _words[Words];
+#if defined(ESP32)
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+};
+
+#endif
@@ -0,0 +1,86 @@
+// snapshot.h
+
+#pragma once
+
+#ifndef _SNAPSHOT_h
+#define _SNAPSHOT_h
+
+#include <stdint.h>
+#include <atomic>
+
+// Read-copy-update of a value with one writer and one reader task.
+// The writer fills a buffer that nobody reads and publishes it with one
+// atomic store. The reader holds the published buffer between acquire() and
+// release(); it does not change under the reader, a newer value goes into
+// another buffer. With three buffers the writer always finds a free one:
+// one is published, one may be held by the reader. Nobody waits.
+template <typename T>
+class SnapshotStore {
+public:
+    SnapshotStore() {
+        for (uint8_t i = 0; i < Buffers; i++) {
+            _versions[i] = 0;
+        }
+    }
+
+    // Writer: returns a free buffer with a copy of the published value
+    T& edit() {
+        uint8_t current_ = _current.load(std::memory_order_acquire);
+        uint8_t reader_ = _reader.load(std::memory_order_seq_cst);
+
+        _editing = 0;
+        while (_editing == current_ || _editing == reader_) {
+            _editing++;
+        }
+
+        _buffers[_editing] = _buffers[current_];
+        _versions[_editing] = _versions[current_] + 1;
+        return _buffers[_editing];
+    }
+
+    // Writer: publishes the buffer of the last edit() and returns its version.
+    // seq_cst like the stores and loads of acquire(): the next edit() loads
+    // _reader after this store, and a release store could be ordered after
+    // that load, so both sides could miss the other's buffer.
+    uint32_t publish() {
+        uint32_t version_ = _versions[_editing];
+        _current.store(_editing, std::memory_order_seq_cst);
+        return version_;
+    }
+
+    // Reader: the published value, valid until release().
+    // Announces the buffer first and checks that it is still the published
+    // one, so the writer cannot have picked it for an edit.
+    const T& acquire() {
+        uint8_t index_;
+        do {
+            index_ = _current.load(std::memory_order_seq_cst);
+            _reader.store(index_, std::memory_order_seq_cst);
+        } while (index_ != _current.load(std::memory_order_seq_cst));
+
+        _held = index_;
+        return _buffers[index_];
+    }
+
+    // Reader: version of the held value, 0 is the initial value
+    uint32_t version() const {
+        return _versions[_held];
+    }
+
+    void release() {
+        _reader.store(None, std::memory_order_release);
+    }
+
+private:
+    static const uint8_t Buffers = 3;
+    static const uint8_t None = 0xFF;
+
+    T _buffers[Buffers] = {};
+    uint32_t _versions[Buffers];
+    std::atomic<uint8_t> _current{ 0 };
+    std::atomic<uint8_t> _reader{ None };
+    uint8_t _editing = 0; // writer only
+    uint8_t _held = 0;    // reader only
+};
+
+#endif
@@ -0,0 +1,74 @@
+// 
+// 
+// 
+
+#include "streamstats.h"
+
+void StatisticsAccumulator::clear() {
+	this->Mean = 0;
+	this->M2 = 0;
+	this->Count = 0;
+	this->Min = INFINITY;
+	this->Max = -INFINITY;
+}
+
+/*
+ * Welford's update, stable also for values with a large offset like the pressure
+ */
+void StatisticsAccumulator::add(float value_) {
+	this->Count++;
+	double delta_ = value_ - this->Mean;
+	this->Mean += delta_ / this->Count;
+	this->M2 += delta_ * (value_ - this->Mean);
+
+	if (value_ < this->Min) {
+		this->Min = value_;
+	}
+	if (value_ > this->Max) {
+		this->Max = value_;
+	}
+}
+
+/*
+ * Combines two accumulators (Chan et al.), the result is the same as if
+ * all values had been added to one.
+ */
+void StatisticsAccumulator::merge(const StatisticsAccumulator& other_) {
+	if (other_.Count == 0) {
+		return;
+	}
+	if (this->Count == 0) {
+		*this = other_;
+		return;
+	}
+
+	uint32_t count_ = this->Count + other_.Count;
+	double delta_ = other_.Mean - this->Mean;
+	this->Mean += delta_ * other_.Count / count_;
+	this->M2 += other_.M2 + delta_ * delta_ * ((double)this->Count * other_.Count / count_);
+	this->Count = count_;
+
+	if (other_.Min < this->Min) {
+		this->Min = other_.Min;
+	}
+	if (other_.Max > this->Max) {
+		this->Max = other_.Max;
+	}
+}
+
+void summarize(const StatisticsAccumulator& accumulator_, StatisticsSummary& summary_) {
+	summary_.Count = accumulator_.Count;
+
+	if (accumulator_.Count == 0) {
+		summary_.Min = NAN;
+		summary_.Max = NAN;
+		summary_.Mean = NAN;
+		summary_.StdDev = NAN;
+		return;
+	}
+
+	summary_.Min = accumulator_.Min;
+	summary_.Max = accumulator_.Max;
+	summary_.Mean = accumulator_.Mean;
+	summary_.StdDev = accumulator_.Count > 1 ? sqrt(accumulator_.M2 / (accumulator_.Count - 1)) : 0;
+}
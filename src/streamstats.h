@@ -0,0 +1,122 @@
+// streamstats.h
+
+#pragma once
+
+#ifndef _STREAMSTATS_h
+#define _STREAMSTATS_h
+
+#include <stdint.h>
+#include <math.h>
+
+// Count, mean, sum of squared deviations (Welford) and range of a set of values.
+// Two accumulators can be merged without the values.
+struct StatisticsAccumulator {
+    double Mean;
+    double M2;
+    uint32_t Count;
+    float Min;
+    float Max;
+
+    void clear();
+    void add(float value_);
+    void merge(const StatisticsAccumulator& other_);
+};
+
+// Result of a window, all values NAN if the window has no values
+struct StatisticsSummary {
+    float Min;
+    float Max;
+    float Mean;
+    float StdDev;
+    uint32_t Count;
+};
+
+void summarize(const StatisticsAccumulator& accumulator_, StatisticsSummary& summary_);
+
+// Statistics over a sliding window of Buckets * BucketLength ms. The values
+// are accumulated into the running bucket. When it is full it replaces the
+// oldest bucket and the closed buckets are merged once, so add() and
+// summary() do not depend on the number of values in the window. The window
+// moves in steps of one bucket and always contains the running bucket.
+// Memory is fixed, nothing is allocated.
+template <uint16_t Buckets, uint32_t BucketLength>
+class WindowStatistics {
+public:
+    WindowStatistics() {
+        this->clear();
+    }
+
+    void clear() {
+        for (uint16_t i = 0; i < Buckets; i++) {
+            this->_buckets[i].clear();
+        }
+        this->_current.clear();
+        this->_closed.clear();
+        this->_next = 0;
+        this->_started = false;
+        this->_bucketStart = 0;
+    }
+
+    // NAN values are not counted, but move the window
+    void add(float value_, uint32_t now_) {
+        if (!this->_started) {
+            this->_bucketStart = now_;
+            this->_started = true;
+        }
+
+        if (now_ - this->_bucketStart >= BucketLength) {
+            this->advance(now_);
+        }
+
+        if (!isnan(value_)) {
+            this->_current.add(value_);
+        }
+    }
+
+    void summary(StatisticsSummary& summary_) const {
+        StatisticsAccumulator window_ = this->_closed;
+        window_.merge(this->_current);
+        summarize(window_, summary_);
+    }
+
+private:
+    // Closes the running bucket and clears the buckets of a gap
+    void advance(uint32_t now_) {
+        uint32_t elapsed_ = (now_ - this->_bucketStart) / BucketLength;
+        this->_bucketStart += elapsed_ * BucketLength;
+
+        this->_buckets[this->_next] = this->_current;
+        this->_next = (this->_next + 1) % Buckets;
+        this->_current.clear();
+
+        for (uint32_t i = 1; i < elapsed_ && i <= Buckets; i++) {
+            this->_buckets[this->_next].clear();
+            this->_next = (this->_next + 1) % Buckets;
+        }
+
+        this->_closed.clear();
+        for (uint16_t i = 0; i < Buckets; i++) {
+            this->_closed.merge(this->_buckets[i]);
+        }
+    }
+
+    StatisticsAccumulator _buckets[Buckets];
+    StatisticsAccumulator _current;
+    StatisticsAccumulator _closed;
+    uint16_t _next;
+    bool _started;
+    uint32_t _bucketStart;
+};
+
+enum tWindow : uint8_t {
+    WindowMinute = 0,
+    WindowHour,
+    WindowDay,
+    WindowCount
+};
+
+typedef WindowStatistics<6, 10000> MinuteStatistics;  // 1 min in 10 s buckets
+typedef WindowStatistics<30, 120000> HourStatistics;  // 1 h in 2 min buckets
+typedef WindowStatistics<24, 3600000> DayStatistics;  // 24 h in 1 h buckets
+
+#endif
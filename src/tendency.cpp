@@ -0,0 +1,120 @@
+// 
+// 
+// 
+
+#include "tendency.h"
+
+#include <math.h>
+
+PressureTendency::PressureTendency() {
+	this->_threshold = 4.0;
+	this->_end = 0;
+	this->_change1h = NAN;
+	this->_change3h = NAN;
+	this->_tendency = TendencyUnknown;
+	this->_storm = false;
+}
+
+void PressureTendency::setStormThreshold(double threshold_) {
+	this->_threshold = threshold_;
+}
+
+/*
+ * Returns the pressure of the entry, or of the nearest entry within MaxGap
+ * minutes if it is missing. NAN if there is none.
+ */
+double PressureTendency::pressureAt(const History& history_, uint32_t index_, uint32_t first_, uint32_t end_) const {
+	HistoryEntry entry_;
+
+	for (uint32_t gap_ = 0; gap_ <= MaxGap; gap_++) {
+		if (index_ >= first_ + gap_ && history_.get(index_ - gap_, entry_)) {
+			double pressure_ = History::pressure(entry_);
+			if (!isnan(pressure_)) {
+				return pressure_;
+			}
+		}
+		if (gap_ > 0 && index_ + gap_ < end_ && history_.get(index_ + gap_, entry_)) {
+			double pressure_ = History::pressure(entry_);
+			if (!isnan(pressure_)) {
+				return pressure_;
+			}
+		}
+	}
+
+	return NAN;
+}
+
+/*
+ * Called after every measurement. Does nothing until the history closes the
+ * next minute. Until 3 h are recorded the 3 h change is estimated from the
+ * last hour, for steady, rising and falling only: a dip of 1.4 mBar in the
+ * first hour would otherwise count as 4.2 mBar in 3 h. Rapidly falling and
+ * the storm warning need the measured 3 h change.
+ */
+bool PressureTendency::update(const History& history_) {
+	uint32_t end_ = history_.end();
+	if (end_ == this->_end) {
+		return false;
+	}
+	this->_end = end_;
+
+	uint32_t first_ = history_.first();
+	uint32_t newest_ = end_ - 1;
+	double now_ = pressureAt(history_, newest_, first_, end_);
+
+	this->_change1h = NAN;
+	this->_change3h = NAN;
+	if (newest_ >= first_ + Minutes1h) {
+		this->_change1h = now_ - pressureAt(history_, newest_ - Minutes1h, first_, end_);
+	}
+	if (newest_ >= first_ + Minutes3h) {
+		this->_change3h = now_ - pressureAt(history_, newest_ - Minutes3h, first_, end_);
+	}
+
+	double change_ = this->_change3h;
+	bool estimated_ = isnan(change_);
+	if (estimated_) {
+		change_ = this->_change1h * 3;
+	}
+
+	if (isnan(change_)) {
+		this->_tendency = TendencyUnknown;
+	}
+	else if (change_ <= -this->_threshold && !estimated_) {
+		this->_tendency = TendencyRapidlyFalling;
+	}
+	else if (change_ <= -SteadyBand) {
+		this->_tendency = TendencyFalling;
+	}
+	else if (change_ >= SteadyBand) {
+		this->_tendency = TendencyRising;
+	}
+	else {
+		this->_tendency = TendencySteady;
+	}
+
+	// the warning is cleared only when the drop is clearly below the threshold again
+	if (!this->_storm) {
+		this->_storm = this->_tendency == TendencyRapidlyFalling;
+	}
+	else if (estimated_ || change_ > -(this->_threshold - StormHysteresis)) {
+		this->_storm = false;
+	}
+
+	return true;
+}
+
+const char* PressureTendency::name(tTendency tendency_) {
+	switch (tendency_) {
+	case TendencySteady:
+		return "steady";
+	case TendencyRising:
+		return "rising";
+	case TendencyFalling:
+		return "falling";
+	case TendencyRapidlyFalling:
+		return "rapidly falling";
+	default:
+		return "unknown";
+	}
+}
@@ -0,0 +1,57 @@
+// tendency.h
+
+#pragma once
+
+#ifndef _TENDENCY_h
+#define _TENDENCY_h
+
+#include <stdint.h>
+
+#include "history.h"
+
+enum tTendency : uint8_t {
+    TendencyUnknown,
+    TendencySteady,
+    TendencyRising,
+    TendencyFalling,
+    TendencyRapidlyFalling
+};
+
+// Pressure change over the last 1 h and 3 h from the minute means of the history.
+// update() reads three entries per new minute (a few more around gaps), so the
+// cost does not depend on the length of the history.
+class PressureTendency {
+public:
+    static const uint32_t Minutes1h = 60;
+    static const uint32_t Minutes3h = 180;
+    static const uint32_t MaxGap = 5;             // minutes searched around a missing entry
+    static constexpr double SteadyBand = 1.0;     // mBar per 3 h
+    static constexpr double StormHysteresis = 0.5; // mBar per 3 h
+
+    PressureTendency();
+
+    // Drop in mBar per 3 h that is classified as rapidly falling and raises the storm warning
+    void setStormThreshold(double threshold_);
+
+    // Returns true if the history got a new minute and the tendency was updated
+    bool update(const History& history_);
+
+    double change1h() const { return this->_change1h; };
+    double change3h() const { return this->_change3h; };
+    tTendency tendency() const { return this->_tendency; };
+    bool storm() const { return this->_storm; };
+
+    static const char* name(tTendency tendency_);
+
+private:
+    double pressureAt(const History& history_, uint32_t index_, uint32_t first_, uint32_t end_) const;
+
+    double _threshold;
+    uint32_t _end;
+    double _change1h;
+    double _change3h;
+    tTendency _tendency;
+    bool _storm;
+};
+
+#endif
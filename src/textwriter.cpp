@@ -0,0 +1,65 @@
+// 
+// 
+// 
+
+#include "textwriter.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// Longest text of one printf() call
+#define TEXTWRITER_FORMAT_LEN 160
+
+TextWriter::TextWriter(char* buffer_, size_t size_, size_t skip_) {
+	this->_buffer = buffer_;
+	this->_size = size_;
+	this->_skip = skip_;
+	this->_length = 0;
+	this->_position = 0;
+	this->_full = false;
+}
+
+void TextWriter::print(const char* text_) {
+	this->print(text_, strlen(text_));
+}
+
+/*
+ * Appends text_. Bytes before the skip position are only counted,
+ * bytes that do not fit any more set full().
+ */
+void TextWriter::print(const char* text_, size_t length_) {
+	size_t start_ = 0;
+
+	if (this->_position < this->_skip) {
+		size_t skipped_ = this->_skip - this->_position;
+		start_ = skipped_ < length_ ? skipped_ : length_;
+	}
+	this->_position += length_;
+
+	size_t copy_ = length_ - start_;
+	if (copy_ > this->_size - this->_length) {
+		copy_ = this->_size - this->_length;
+		this->_full = true;
+	}
+
+	memcpy(this->_buffer + this->_length, text_ + start_, copy_);
+	this->_length += copy_;
+}
+
+void TextWriter::printf(const char* format_, ...) {
+	char text_[TEXTWRITER_FORMAT_LEN];
+	va_list args_;
+
+	va_start(args_, format_);
+	int length_ = vsnprintf(text_, sizeof(text_), format_, args_);
+	va_end(args_);
+
+	if (length_ < 0) {
+		return;
+	}
+	if ((size_t)length_ >= sizeof(text_)) {
+		length_ = sizeof(text_) - 1;
+	}
+	this->print(text_, length_);
+}
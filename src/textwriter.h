@@ -0,0 +1,40 @@
+// textwriter.h
+
+#pragma once
+
+#ifndef _TEXTWRITER_h
+#define _TEXTWRITER_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Writes text into a fixed buffer, no heap is used.
+// With skip_ > 0 the first skip_ bytes of the text are dropped, so a
+// response can be rendered again for each chunk the web server asks for.
+class TextWriter {
+public:
+    TextWriter(char* buffer_, size_t size_, size_t skip_ = 0);
+
+    void print(const char* text_);
+    void print(const char* text_, size_t length_);
+    void printf(const char* format_, ...) __attribute__((format(printf, 2, 3)));
+
+    // Bytes in the buffer
+    size_t length() const { return _length; };
+    // Bytes of the whole text, including skipped and dropped ones
+    size_t position() const { return _position; };
+    // The buffer was too small for the rest of the text
+    bool full() const { return _full; };
+
+    const char* buffer() const { return _buffer; };
+
+private:
+    char* _buffer;
+    size_t _size;
+    size_t _skip;
+    size_t _length;
+    size_t _position;
+    bool _full;
+};
+
+#endif
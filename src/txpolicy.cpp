@@ -0,0 +1,63 @@
+// 
+// 
+// 
+
+#include "txpolicy.h"
+
+#include <math.h>
+
+ChannelTransmitter::ChannelTransmitter() {
+	this->_policy.Deadband = 0;
+	this->_policy.MinInterval = 0;
+	this->_policy.MaxInterval = 0;
+	this->_tolerance = 0;
+	this->_lastValue = 0;
+	this->_lastTime = 0;
+	this->_sent = false;
+}
+
+void ChannelTransmitter::setPolicy(const TransmitPolicy& policy_) {
+	this->_policy = policy_;
+}
+
+void ChannelTransmitter::reset() {
+	this->_sent = false;
+}
+
+/*
+ * Decides if a value is sent. The first value is always sent, then the
+ * minimum interval blocks, the heartbeat forces and the deadband decides.
+ * A change between a valid value and NAN counts as a change.
+ * Both intervals are checked with the tolerance added to the elapsed time.
+ */
+bool ChannelTransmitter::due(double value_, uint32_t now_) {
+	bool send_ = false;
+
+	if (!this->_sent) {
+		send_ = true;
+	}
+	else {
+		uint32_t elapsed_ = now_ - this->_lastTime + this->_tolerance;
+
+		if (elapsed_ < this->_policy.MinInterval) {
+			return false;
+		}
+
+		if (this->_policy.MaxInterval > 0 && elapsed_ >= this->_policy.MaxInterval) {
+			send_ = true;
+		}
+		else if (isnan(value_) || isnan(this->_lastValue)) {
+			send_ = isnan(value_) != isnan(this->_lastValue);
+		}
+		else if (fabs(value_ - this->_lastValue) >= this->_policy.Deadband) {
+			send_ = true;
+		}
+	}
+
+	if (send_) {
+		this->_lastValue = value_;
+		this->_lastTime = now_;
+		this->_sent = true;
+	}
+	return send_;
+}
@@ -0,0 +1,54 @@
+// txpolicy.h
+
+#pragma once
+
+#ifndef _TXPOLICY_h
+#define _TXPOLICY_h
+
+#include <stdint.h>
+
+// Measured channels, each has its own transmit policy
+enum tChannel : uint8_t {
+    ChannelTemperature = 0,
+    ChannelHumidity,
+    ChannelPressure,
+    ChannelDewPoint,
+    ChannelHeatIndex,
+    ChannelCount
+};
+
+// A value is sent when it moved by at least Deadband since the last send,
+// but not more often than MinInterval and at least every MaxInterval (heartbeat).
+struct TransmitPolicy {
+    double Deadband;      // in the unit of the channel, 0 sends every value
+    uint32_t MinInterval; // ms
+    uint32_t MaxInterval; // ms
+};
+
+class ChannelTransmitter {
+public:
+    ChannelTransmitter();
+
+    void setPolicy(const TransmitPolicy& policy_);
+    const TransmitPolicy& policy() const { return _policy; };
+
+    // Values come once per epoch with some jitter. A value this many ms
+    // early still counts as on time, so a MinInterval of one epoch does not
+    // drop every other epoch. Half the epoch period is a good choice.
+    void setTolerance(uint32_t tolerance_) { _tolerance = tolerance_; };
+
+    // Returns true if value_ has to be sent now and remembers it as sent
+    bool due(double value_, uint32_t now_);
+
+    // The next value is sent regardless of the deadband
+    void reset();
+
+private:
+    TransmitPolicy _policy;
+    uint32_t _tolerance;
+    double _lastValue;
+    uint32_t _lastTime;
+    bool _sent;
+};
+
+#endif
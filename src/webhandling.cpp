@@ -15,14 +15,19 @@
 #include "webhandling.h"
 #include "favicon.h"
 #include "neotimer.h"
+#include "textwriter.h"
+#include "writebehind.h"
+#include "diagnostics.h"
+#include "version.h"
 
 #include <DNSServer.h>
 #include <IotWebConfAsyncUpdateServer.h>
 #include <IotWebRoot.h>
+#include <RebootManager.h>
 
 
 // -- Configuration specific key. The value should be modified if config structure was changed.
-#define CONFIG_VERSION "A2"
+#define CONFIG_VERSION "A6"
 
 // -- When CONFIG_PIN is pulled to ground on startup, the Thing will use the initial
 //      password to buld an AP. (E.g. in case of lost password)
@@ -44,29 +49,71 @@ const char thingName[] = "NMEA2000-BME280";
 
 // -- Method declarations.
 void handleData(AsyncWebServerRequest* request);
+void handleMetrics(AsyncWebServerRequest* request);
 void handleRoot(AsyncWebServerRequest* request);
+void handleFavicon(AsyncWebServerRequest* request);
+void handleHistory(AsyncWebServerRequest* request);
+void handleDiagnostics(AsyncWebServerRequest* request);
+void pushEvents();
 void convertParams();
 
 // -- Callback methods.
 void configSaved();
 void wifiConnected();
 
-bool gParamsChanged = true;
-bool gSaveParams = false;
+std::atomic<bool> gSaveParams{ false };
+WriteBehind SourceWriter;
 uint8_t APModeOfflineTime = 0;
 
 DNSServer dnsServer;
 AsyncWebServer server(80);
 AsyncWebServerWrapper asyncWebServerWrapper(&server);
 AsyncUpdateServer AsyncUpdater;
+AsyncEventSource events("/events");
 Neotimer APModeTimer = Neotimer();
 
 AsyncIotWebConf iotWebConf(thingName, &dnsServer, &asyncWebServerWrapper, wifiInitialApPassword, CONFIG_VERSION);
 
 NMEAConfig Config = NMEAConfig();
+TransmitConfig TransmitSettings = TransmitConfig();
+WeatherConfig WeatherSettings = WeatherConfig();
 
 iotwebconf::ParameterGroup SourcesGroup = iotwebconf::ParameterGroup("SourcesGroup", "Source");
 
+char TempSourceValues[][STRING_LEN] = {
+    "1",
+    "2",
+    "3",
+    "4",
+    "7",
+    "8",
+    "13",
+    "14",
+};
+
+char TempSourceNames[][STRING_LEN] = { 
+    "outside", 
+    "inside", 
+    "engine room", 
+    "main cabin", 
+    "refridgeration",
+    "heating system", 
+    "freezer", 
+    "exhaust gas"
+};
+
+char HumiditySourceValues[][STRING_LEN] = {
+    "1",
+    "2",
+    "255"
+};
+
+char HumiditySourceNames[][STRING_LEN] = {
+    "inside",
+    "outside",
+    "unknown"
+};
+
 char TempSourceValue[STRING_LEN];
 iotwebconf::SelectParameter TempSource = iotwebconf::SelectParameter("Temperature",
     "TempSource", 
@@ -91,6 +138,33 @@ iotwebconf::SelectParameter HumiditySource = iotwebconf::SelectParameter("Humidi
     "2" // undefined
 );
 
+iotwebconf::ParameterGroup SensorGroup = iotwebconf::ParameterGroup("SensorGroup", "Sensor");
+
+// in the order of tBME280Profile
+char SamplingProfileValues[ProfileCount][STRING_LEN] = {
+    "0",
+    "1",
+    "2"
+};
+
+char SamplingProfileNames[ProfileCount][STRING_LEN] = {
+    "weather station (forced, 1x, 9 ms)",
+    "indoor (forced, filter x4, 21 ms)",
+    "low noise (normal, filter x16, 46 ms)"
+};
+
+char SamplingProfileValue[STRING_LEN];
+iotwebconf::SelectParameter SamplingProfile = iotwebconf::SelectParameter("Sampling profile",
+    "SamplingProfile",
+    SamplingProfileValue,
+    STRING_LEN,
+    (char*)SamplingProfileValues,
+    (char*)SamplingProfileNames,
+    sizeof(SamplingProfileValues) / STRING_LEN,
+    STRING_LEN,
+    "0" // weather station
+);
+
 class CustomHtmlFormatProvider : public iotwebconf::HtmlFormatProvider {
 protected:
     virtual String getFormEnd() {
@@ -117,9 +191,13 @@ void wifiInit() {
 
     SourcesGroup.addItem(&TempSource);
     SourcesGroup.addItem(&HumiditySource);
+    SensorGroup.addItem(&SamplingProfile);
 
     iotWebConf.addParameterGroup(&Config);
     iotWebConf.addParameterGroup(&SourcesGroup);
+    iotWebConf.addParameterGroup(&SensorGroup);
+    iotWebConf.addParameterGroup(&TransmitSettings);
+    iotWebConf.addParameterGroup(&WeatherSettings);
 
     iotWebConf.addSystemParameter(&APModeOfflineParam);
     
@@ -146,19 +224,15 @@ void wifiInit() {
         }
     );
 
-    server.on("/favicon.ico", HTTP_GET, [](AsyncWebServerRequest* request) {
-        AsyncWebServerResponse* response = request->beginResponse_P(200, "image/x-icon", favicon_ico, sizeof(favicon_ico));
-        request->send(response);
-        }
-    );
-
-    server.on("/apple-touch-icon.png", HTTP_GET, [](AsyncWebServerRequest* request) {
-        AsyncWebServerResponse* response = request->beginResponse_P(200, "image/png", favicon_ico, sizeof(favicon_ico));
-        request->send(response);
-        }
-    );
+    // favicon_ico holds a PNG image, both routes send it as such
+    server.on("/favicon.ico", HTTP_GET, [](AsyncWebServerRequest* request) { handleFavicon(request); });
+    server.on("/apple-touch-icon.png", HTTP_GET, [](AsyncWebServerRequest* request) { handleFavicon(request); });
 
     server.on("/data", HTTP_GET, [](AsyncWebServerRequest* request) { handleData(request); });
+    server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest* request) { handleMetrics(request); });
+    server.on("/diagnostics", HTTP_GET, [](AsyncWebServerRequest* request) { handleDiagnostics(request); });
+    server.on("/history", HTTP_GET, [](AsyncWebServerRequest* request) { handleHistory(request); });
+    server.addHandler(&events);
     server.onNotFound([](AsyncWebServerRequest* request) {
         AsyncWebRequestWrapper asyncWebRequestWrapper(request);
         iotWebConf.handleNotFound(&asyncWebRequestWrapper);
@@ -174,20 +248,39 @@ void wifiInit() {
     Serial.println("Ready.");
 }
 
+// One bit per virtual device whose claimed address differs from the stored one
+uint32_t dirtySources() {
+    uint32_t dirty_ = 0;
+    for (uint8_t i = 0; i < DeviceCount; i++) {
+        if (gN2KSource[i] != Config.Source(i)) {
+            dirty_ |= 1UL << i;
+        }
+    }
+    return dirty_;
+}
+
 void wifiLoop() {
     // -- doLoop should be called as frequently as possible.
     iotWebConf.doLoop();
     ArduinoOTA.handle();
 
-    if (gSaveParams) {
-        Serial.println(F("Parameters are changed,save them"));
+    pushEvents();
 
-        Config.SetSource(gN2KSource[DeviceTemperature]);
-        Config.SetSourceHumidity(gN2KSource[DeviceHumidity]);
-        Config.SetSourcePressure(gN2KSource[DevicePressure]);
+    // Claimed source addresses are written behind, an address claim storm
+    // ends in a single flash write once the addresses settled.
+    if (gSaveParams.exchange(false)) {
+        SourceWriter.update(dirtySources(), millis());
+    }
+
+    if (SourceWriter.due(millis())) {
+        Serial.println(F("Source addresses are changed, save them"));
+
+        for (uint8_t i = 0; i < DeviceCount; i++) {
+            Config.SetSource(i, gN2KSource[i]);
+        }
 
         iotWebConf.saveConfig();
-        gSaveParams = false;
+        SourceWriter.written(millis());
     }
 
     if (APModeTimer.done()) {
@@ -207,23 +300,375 @@ void wifiConnected() {
     ArduinoOTA.begin();
 }
 
+// Drawn once per boot and part of every ETag. The sequence numbers behind
+// the tags start again after a reboot, so a tag of an earlier boot or
+// firmware would otherwise match a body the browser has never seen.
+uint32_t BootNonce = 0;
+
+uint32_t bootNonce() {
+	if (BootNonce == 0) {
+		BootNonce = esp_random() | 1;
+	}
+	return BootNonce;
+}
+
+// "1.3.2.31-0123abcd-1" in quotes
+void formatETag(char* tag_, size_t size_, uint32_t sequence_) {
+	snprintf(tag_, size_, "\"%s-%08lx-%lu\"", VERSION, (unsigned long)bootNonce(), (unsigned long)sequence_);
+}
+
+// /data is rendered once per measurement and every request for the same
+// measurement gets the same body, sent without a copy. The two buffers
+// alternate, so a response still being sent is not overwritten by the next body.
+// The size follows from renderDataJson(): numbers have at most
+// JSON_NUMBER_LEN characters, seven values, and four numbers per channel and
+// window in the statistics. DATA_FIXED_LEN covers rssi, tendency, storm, mac,
+// ip and the brackets. Keep the counts in line with it.
+#define JSON_NUMBER_LEN 10   // "-999999.99", larger values are sent as null
+#define JSON_NUMBER_LIMIT 999999.99
+#define DATA_FIXED_LEN 128
+#define DATA_VALUE_LEN (16 + JSON_NUMBER_LEN)           // "Temperature":-999999.99,
+#define DATA_WINDOW_LEN (8 + 4 * (JSON_NUMBER_LEN + 1)) // "24h":[min,max,mean,stddev],
+#define DATA_CHANNEL_LEN (16 + WindowCount * DATA_WINDOW_LEN)
+#define DATA_BUFFER_LEN (DATA_FIXED_LEN + 7 * DATA_VALUE_LEN + ChannelCount * DATA_CHANNEL_LEN)
+char DataBuffer[2][DATA_BUFFER_LEN];
+size_t DataLength = 0;
+uint8_t DataIndex = 0;
+uint32_t DataSequence = 0;
+bool DataRendered = false;
+char DataETag[48];
+
+// No sensor value comes near JSON_NUMBER_LIMIT, a larger one is broken
+bool printableJsonNumber(double value_) {
+	return isfinite(value_) && fabs(value_) <= JSON_NUMBER_LIMIT;
+}
+
+void printJsonValue(TextWriter& writer_, const char* name_, double value_, bool last_ = false) {
+	if (printableJsonNumber(value_)) {
+		writer_.printf("\"%s\":%.2f%s", name_, value_, last_ ? "" : ",");
+	}
+	else {
+		writer_.printf("\"%s\":null%s", name_, last_ ? "" : ",");
+	}
+}
+
+// Names in the order of tChannel and tWindow
+const char* const ChannelNames[ChannelCount] = { "Temperature", "Humidity", "Pressure", "DewPoint", "HeatIndex" };
+const char* const WindowNames[WindowCount] = { "1m", "1h", "24h" };
+
+void printJsonNumber(TextWriter& writer_, double value_, const char* separator_) {
+	if (printableJsonNumber(value_)) {
+		writer_.printf("%.2f%s", value_, separator_);
+	}
+	else {
+		writer_.printf("null%s", separator_);
+	}
+}
+
+// "Statistics":{"Temperature":{"1m":[min,max,mean,stddev],...},...}
+void printJsonStatistics(TextWriter& writer_, const StatisticsData& statistics_) {
+	writer_.print("\"Statistics\":{");
+	for (uint8_t i = 0; i < ChannelCount; i++) {
+		writer_.printf("\"%s\":{", ChannelNames[i]);
+		for (uint8_t j = 0; j < WindowCount; j++) {
+			const StatisticsSummary& summary_ = statistics_.Windows[i][j];
+			writer_.printf("\"%s\":[", WindowNames[j]);
+			printJsonNumber(writer_, summary_.Min, ",");
+			printJsonNumber(writer_, summary_.Max, ",");
+			printJsonNumber(writer_, summary_.Mean, ",");
+			printJsonNumber(writer_, summary_.StdDev, "]");
+			writer_.print(j + 1 < WindowCount ? "," : "}");
+		}
+		writer_.print(i + 1 < ChannelCount ? "," : "},");
+	}
+}
+
+// Writes the JSON of one measurement, used for /data and /events.
+// Returns 0 if it does not fit.
+size_t renderDataJson(char* buffer_, size_t size_, const SensorData& data_) {
+	StatisticsData statistics_;
+	gStatistics.read(statistics_);
+
+	TextWriter writer_(buffer_, size_);
+	writer_.printf("{\"rssi\":%d,", WiFi.RSSI());
+	printJsonValue(writer_, "Temperature", data_.temperature);
+	printJsonValue(writer_, "DewPoint", data_.dewPoint);
+	printJsonValue(writer_, "HeatIndex", data_.heatIndex);
+	printJsonValue(writer_, "Pressure", data_.pressure);
+	printJsonValue(writer_, "Humidity", data_.humidity);
+	printJsonValue(writer_, "Tendency1h", data_.tendency1h);
+	printJsonValue(writer_, "Tendency3h", data_.tendency3h);
+	writer_.printf("\"Tendency\":\"%s\",\"Storm\":%s,", PressureTendency::name(data_.tendency), data_.storm ? "true" : "false");
+	printJsonStatistics(writer_, statistics_);
+
+	uint8_t mac_[6];
+	IPAddress ip_ = WiFi.localIP();
+	WiFi.macAddress(mac_);
+	writer_.printf("\"mac\":\"%02X:%02X:%02X:%02X:%02X:%02X\",", mac_[0], mac_[1], mac_[2], mac_[3], mac_[4], mac_[5]);
+	writer_.printf("\"ip\":\"%u.%u.%u.%u\"}", ip_[0], ip_[1], ip_[2], ip_[3]);
+
+	// A cut off body would be invalid JSON
+	if (writer_.full()) {
+		WebSerial.printf("Data needs %u bytes, the buffer has %u\n", (unsigned)writer_.position(), (unsigned)size_);
+		return 0;
+	}
+	return writer_.length();
+}
+
+void renderData() {
+	SensorData data_;
+	uint32_t sequence_ = gSensorData.read(data_);
+
+	if (DataRendered && sequence_ == DataSequence) {
+		return;
+	}
+
+	DataIndex ^= 1;
+	DataLength = renderDataJson(DataBuffer[DataIndex], DATA_BUFFER_LEN, data_);
+	DataSequence = sequence_;
+	DataRendered = true;
+	formatETag(DataETag, sizeof(DataETag), sequence_);
+}
+
+// Pushes every new measurement once to all clients of /events. Runs in the
+// wifiLoop() task, so it renders into its own buffer. The event source
+// sends the same payload to every client.
+char EventBuffer[DATA_BUFFER_LEN];
+uint32_t EventSequence = 0;
+
+void pushEvents() {
+	if (gSensorData.sequence() == EventSequence) {
+		return;
+	}
+
+	SensorData data_;
+	EventSequence = gSensorData.read(data_);
+
+	if (events.count() == 0) {
+		return;
+	}
+
+	size_t length_ = renderDataJson(EventBuffer, DATA_BUFFER_LEN - 1, data_);
+	if (length_ == 0) {
+		return;
+	}
+	EventBuffer[length_] = 0;
+	events.send(EventBuffer, "data", EventSequence);
+}
+
 void handleData(AsyncWebServerRequest* request) {
-	String json_ = "{";
-	json_ += "\"rssi\":" + String(WiFi.RSSI()) + ",";
-	json_ += "\"Temperature\":" + String(gTemperature, 2) + ",";
-	json_ += "\"DewPoint\":" + String(gdewPoint, 2) + ",";
-	json_ += "\"HeatIndex\":" + String(gheatIndex, 2) + ",";
-	json_ += "\"Pressure\":" + String(gPressure, 2) + ",";
-	json_ += "\"Humidity\":" + String(gHumidity, 2);
-	json_ += "}";
-	request->send(200, "application/json", json_);
+	renderData();
+
+	const AsyncWebHeader* header_ = request->getHeader("If-None-Match");
+	if (header_ != nullptr && strcmp(header_->value().c_str(), DataETag) == 0) {
+		AsyncWebServerResponse* response = request->beginResponse(304);
+		response->addHeader("ETag", DataETag);
+		request->send(response);
+		return;
+	}
+
+	if (DataLength == 0) {
+		request->send(500, "text/plain", F("Data buffer too small"));
+		return;
+	}
+
+	AsyncWebServerResponse* response = request->beginResponse_P(200, "application/json", (const uint8_t*)DataBuffer[DataIndex], DataLength);
+	response->addHeader("ETag", DataETag);
+	response->addHeader("Cache-Control", "no-cache");
+	request->send(response);
+}
+
+// The metrics are rendered into this buffer and sent from there without a copy.
+// Only one scrape is answered at a time, the buffer is free again when the
+// connection of the scrape is closed.
+// The size follows from the metric families in handleMetrics(): each family
+// has its HELP and TYPE lines, the send counters have four samples (ok, failed,
+// frames, bytes) per PGN and per device. Keep the counts in line with it.
+#define METRIC_FAMILY_LEN 144
+#define METRIC_SAMPLE_LEN 80
+#define METRIC_FAMILIES 28
+#define METRIC_SAMPLES (24 + 4 * N2kStatistics::MaxPGNs + 4 * DeviceCount)
+#define METRICS_BUFFER_LEN (METRIC_FAMILIES * METRIC_FAMILY_LEN + METRIC_SAMPLES * METRIC_SAMPLE_LEN)
+char MetricsBuffer[METRICS_BUFFER_LEN];
+bool MetricsBusy = false;
+
+// Devices of the first sensor are "temperature", of the second "temperature2" and so on
+const char* DeviceNames[DevicesPerSensor] = { "temperature", "pressure", "humidity" };
+
+void printMetricHeader(TextWriter& writer_, const char* name_, const char* type_, const char* help_) {
+    writer_.printf("# HELP %s %s\n# TYPE %s %s\n", name_, help_, name_, type_);
+}
+
+void printGauge(TextWriter& writer_, const char* name_, const char* help_, double value_) {
+    printMetricHeader(writer_, name_, "gauge", help_);
+    writer_.printf("%s %.3f\n", name_, value_);
+}
+
+enum tCounterField { CounterSucceeded, CounterFailed, CounterFrames, CounterBytes };
+
+uint32_t counterValue(const N2kCounters& counters_, tCounterField field_) {
+    switch (field_) {
+    case CounterSucceeded: return counters_.Succeeded.load(std::memory_order_relaxed);
+    case CounterFailed: return counters_.Failed.load(std::memory_order_relaxed);
+    case CounterFrames: return counters_.Frames.load(std::memory_order_relaxed);
+    default: return counters_.Bytes.load(std::memory_order_relaxed);
+    }
+}
+
+// One sample per PGN (byDevice_ false) or per virtual device, extra_ adds labels
+void printCounterSamples(TextWriter& writer_, const char* name_, bool byDevice_, const char* extra_, tCounterField field_) {
+    if (byDevice_) {
+        for (uint8_t i = 0; i < DeviceCount && i < N2kStatistics::MaxDevices; i++) {
+            char sensor_[4] = "";
+            if (i >= DevicesPerSensor) {
+                snprintf(sensor_, sizeof(sensor_), "%u", i / DevicesPerSensor + 1);
+            }
+            writer_.printf("%s{device=\"%s%s\"%s} %lu\n", name_, DeviceNames[i % DevicesPerSensor], sensor_, extra_, (unsigned long)counterValue(gN2kStats.deviceCounters(i), field_));
+        }
+    }
+    else {
+        for (uint8_t i = 0; i < gN2kStats.pgnCount(); i++) {
+            writer_.printf("%s{pgn=\"%lu\"%s} %lu\n", name_, (unsigned long)gN2kStats.pgn(i), extra_, (unsigned long)counterValue(gN2kStats.pgnCounters(i), field_));
+        }
+    }
+}
+
+void printCounterFamilies(TextWriter& writer_, bool byDevice_) {
+    const char* messages_ = byDevice_ ? "n2k_device_messages_total" : "n2k_pgn_messages_total";
+    const char* frames_ = byDevice_ ? "n2k_device_frames_total" : "n2k_pgn_frames_total";
+    const char* bytes_ = byDevice_ ? "n2k_device_bytes_total" : "n2k_pgn_bytes_total";
+
+    printMetricHeader(writer_, messages_, "counter", "NMEA 2000 messages by send result");
+    printCounterSamples(writer_, messages_, byDevice_, ",result=\"ok\"", CounterSucceeded);
+    printCounterSamples(writer_, messages_, byDevice_, ",result=\"failed\"", CounterFailed);
+
+    printMetricHeader(writer_, frames_, "counter", "CAN frames of the sent messages");
+    printCounterSamples(writer_, frames_, byDevice_, "", CounterFrames);
+
+    printMetricHeader(writer_, bytes_, "counter", "Data bytes of the sent messages");
+    printCounterSamples(writer_, bytes_, byDevice_, "", CounterBytes);
+}
+
+void handleMetrics(AsyncWebServerRequest* request) {
+    if (MetricsBusy) {
+        request->send(503);
+        return;
+    }
+    MetricsBusy = true;
+    request->onDisconnect([]() { MetricsBusy = false; });
+
+    SensorData data_;
+    uint32_t sequence_ = gSensorData.read(data_);
+    double age_ = sequence_ > 0 ? (millis() - data_.timestamp) / 1000.0 : NAN;
+
+    TextWriter writer_(MetricsBuffer, METRICS_BUFFER_LEN);
+
+    printGauge(writer_, "bme280_temperature_celsius", "Temperature of the last measurement", data_.temperature);
+    printGauge(writer_, "bme280_humidity_percent", "Relative humidity of the last measurement", data_.humidity);
+    printGauge(writer_, "bme280_pressure_hpa", "Pressure of the last measurement", data_.pressure);
+    printGauge(writer_, "bme280_dew_point_celsius", "Dew point of the last measurement", data_.dewPoint);
+    printGauge(writer_, "bme280_heat_index_celsius", "Heat index of the last measurement", data_.heatIndex);
+    printGauge(writer_, "bme280_sample_age_seconds", "Age of the last measurement", age_);
+    printGauge(writer_, "bme280_sample_sequence", "Number of measurements since boot", sequence_);
+
+    printGauge(writer_, "device_uptime_seconds", "Time since boot", millis() / 1000.0);
+    printGauge(writer_, "device_reboot_count", "Number of reboots", RebootManager::getRebootCount());
+    printGauge(writer_, "device_heap_free_bytes", "Free heap", ESP.getFreeHeap());
+    printGauge(writer_, "device_heap_min_free_bytes", "Lowest free heap since boot", ESP.getMinFreeHeap());
+    printGauge(writer_, "device_heap_max_alloc_bytes", "Largest free heap block", ESP.getMaxAllocHeap());
+    printGauge(writer_, "device_wifi_rssi_dbm", "WiFi signal strength", WiFi.RSSI());
+
+    printMetricHeader(writer_, "device_loop_iterations_total", "counter", "Number of loop() iterations");
+    writer_.printf("device_loop_iterations_total %lu\n", (unsigned long)gLoopTiming.Iterations.load(std::memory_order_relaxed));
+    printGauge(writer_, "device_loop_duration_us", "Duration of the last loop() iteration", gLoopTiming.LastDuration.load(std::memory_order_relaxed));
+    printGauge(writer_, "device_loop_duration_max_us", "Longest loop() iteration", gLoopTiming.MaxDuration.load(std::memory_order_relaxed));
+
+    printMetricHeader(writer_, "device_config_writes_total", "counter", "Source address writes to flash since boot");
+    writer_.printf("device_config_writes_total %lu\n", (unsigned long)SourceWriter.writes());
+    printGauge(writer_, "device_config_pending", "Source addresses waiting to be written", SourceWriter.dirty() != 0);
+
+    printGauge(writer_, "n2k_queue_pending", "Messages waiting to be sent", gOutbound.pending());
+    printMetricHeader(writer_, "n2k_queue_discarded_total", "counter", "Queued messages that were not sent");
+    writer_.printf("n2k_queue_discarded_total{reason=\"replaced\"} %lu\n", (unsigned long)gOutbound.coalesced());
+    writer_.printf("n2k_queue_discarded_total{reason=\"stale\"} %lu\n", (unsigned long)gOutbound.stale());
+    writer_.printf("n2k_queue_discarded_total{reason=\"full\"} %lu\n", (unsigned long)gOutbound.dropped());
+
+    printCounterFamilies(writer_, false);
+    printCounterFamilies(writer_, true);
+    printGauge(writer_, "n2k_frames_per_second", "CAN frames sent per second", gN2kStats.framesPerSecond());
+    printGauge(writer_, "n2k_bus_load_percent", "Estimated share of the bus used by this node", gN2kStats.busLoad());
+
+    // A cut off scrape would look like valid metrics with samples missing
+    if (writer_.full()) {
+        WebSerial.printf("Metrics need %u bytes, the buffer has %u\n", (unsigned)writer_.position(), (unsigned)METRICS_BUFFER_LEN);
+        request->send(500, "text/plain", F("Metrics buffer too small"));
+        return;
+    }
+
+    AsyncWebServerResponse* response = request->beginResponse_P(200, "text/plain; version=0.0.4", (const uint8_t*)MetricsBuffer, writer_.length());
+    request->send(response);
+}
+
+// Free stack in bytes that was never used, null without the task
+void printStackHighWater(TextWriter& writer_, const char* name_, TaskHandle_t task_, bool last_) {
+    if (task_ == NULL) {
+        writer_.printf("\"%s\":null%s", name_, last_ ? "" : ",");
+    }
+    else {
+        writer_.printf("\"%s\":%lu%s", name_, (unsigned long)uxTaskGetStackHighWaterMark(task_), last_ ? "" : ",");
+    }
+}
+
+// Timing histograms and high-water marks as JSON. Shares the buffer with the metrics.
+void handleDiagnostics(AsyncWebServerRequest* request) {
+#ifdef DIAGNOSTICS
+    if (MetricsBusy) {
+        request->send(503);
+        return;
+    }
+    MetricsBusy = true;
+    request->onDisconnect([]() { MetricsBusy = false; });
+
+    TextWriter writer_(MetricsBuffer, METRICS_BUFFER_LEN);
+
+    writer_.printf("{\"Phases\":{");
+    for (uint8_t i = 0; i < DiagPhaseCount; i++) {
+        const LatencyHistogram& histogram_ = gDiagnostics.Phases[i];
+        writer_.printf("%s\"%s\":{\"Unit\":\"%s\",\"Count\":%lu,\"Max\":%lu,\"P50\":%lu,\"P99\":%lu,\"Buckets\":[",
+            i == 0 ? "" : ",", Diagnostics::name(tDiagPhase(i)), Diagnostics::unit(tDiagPhase(i)),
+            (unsigned long)histogram_.count(), (unsigned long)histogram_.max(),
+            (unsigned long)histogram_.percentile(0.5), (unsigned long)histogram_.percentile(0.99));
+
+        // buckets after the one of the maximum are empty
+        uint8_t last_ = LatencyHistogram::bucketOf(histogram_.max());
+        for (uint8_t j = 0; j <= last_; j++) {
+            writer_.printf("%s%lu", j == 0 ? "" : ",", (unsigned long)histogram_.bucket(j));
+        }
+        writer_.printf("]}");
+    }
+    writer_.printf("},\"Stack\":{");
+    printStackHighWater(writer_, "loop", N2kTaskHandle, false);
+    printStackHighWater(writer_, "loop2", TaskHandle, true);
+    writer_.printf("},\"Heap\":{\"Free\":%lu,\"MinFree\":%lu,\"MaxAlloc\":%lu}}",
+        (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMinFreeHeap(), (unsigned long)ESP.getMaxAllocHeap());
+
+    AsyncWebServerResponse* response = request->beginResponse_P(200, "application/json", (const uint8_t*)MetricsBuffer, writer_.length());
+    request->send(response);
+#else
+    request->send(404);
+#endif
 }
 
 class MyHtmlRootFormatProvider : public HtmlRootFormatProvider {
 protected:
     virtual String getScriptInner() {
         String _s = HtmlRootFormatProvider::getScriptInner();
-        _s.replace("{millisecond}", "5000");
+        // Values are pushed through /events, polling /data is only the fallback
+        _s.replace("{millisecond}", "(window.EventSource ? 60000 : 5000)");
+        _s += F("if (!!window.EventSource) {\n");
+        _s += F("   var source = new EventSource('/events');\n");
+        _s += F("   source.addEventListener('data', function(e) { updateData(JSON.parse(e.data)); }, false);\n");
+        _s += F("}\n");
         _s += F("function updateData(jsonData) {\n");
         _s += F("   document.getElementById('RSSIValue').innerHTML = jsonData.rssi + \"dBm\" \n");
 		_s += F("   document.getElementById('TemperaturValue').innerHTML = jsonData.Temperature + \"&deg;C\" \n");
@@ -231,22 +676,61 @@ protected:
 		_s += F("   document.getElementById('HeatIndexValue').innerHTML = jsonData.HeatIndex + \"&deg;C\" \n");
 		_s += F("   document.getElementById('PressureValue').innerHTML = jsonData.Pressure + \"mBar\" \n");
 		_s += F("   document.getElementById('HumidityValue').innerHTML = jsonData.Humidity + \"%\" \n");
+		_s += F("   var tendency = jsonData.Tendency; \n");
+		_s += F("   if (jsonData.Tendency3h !== null) tendency += \" (\" + jsonData.Tendency3h + \" mBar/3h)\"; \n");
+		_s += F("   else if (jsonData.Tendency1h !== null) tendency += \" (\" + jsonData.Tendency1h + \" mBar/1h)\"; \n");
+		_s += F("   if (jsonData.Storm) tendency = \"<b>storm warning</b>, \" + tendency; \n");
+		_s += F("   document.getElementById('TendencyValue').innerHTML = tendency \n");
+		_s += F("   document.getElementById('MACValue').innerHTML = jsonData.mac \n");
+		_s += F("   document.getElementById('IPValue').innerHTML = jsonData.ip \n");
+
+        _s += F("}\n");
 
+        // pressure chart of the last 24 h from /history
+        _s += F("function drawHistory() {\n");
+        _s += F("   fetch('/history').then(function(r) { return r.text(); }).then(function(t) {\n");
+        _s += F("      var rows = t.trim().split('\\n').slice(1).map(function(l) { return parseFloat(l.split(',')[3]); }).filter(function(v) { return !isNaN(v); });\n");
+        _s += F("      var c = document.getElementById('PressureChart');\n");
+        _s += F("      if (!c || rows.length < 2) return;\n");
+        _s += F("      var g = c.getContext('2d');\n");
+        _s += F("      var min = Math.min.apply(null, rows), max = Math.max.apply(null, rows);\n");
+        _s += F("      if (max - min < 2) { var m = (max + min) / 2; min = m - 1; max = m + 1; }\n");
+        _s += F("      g.clearRect(0, 0, c.width, c.height);\n");
+        _s += F("      g.beginPath();\n");
+        _s += F("      rows.forEach(function(v, i) {\n");
+        _s += F("         var x = i * (c.width - 1) / (rows.length - 1);\n");
+        _s += F("         var y = c.height - 1 - (v - min) * (c.height - 1) / (max - min);\n");
+        _s += F("         if (i == 0) g.moveTo(x, y); else g.lineTo(x, y);\n");
+        _s += F("      });\n");
+        _s += F("      g.stroke();\n");
+        _s += F("      document.getElementById('PressureRange').innerHTML = min.toFixed(1) + ' - ' + max.toFixed(1) + ' mBar';\n");
+        _s += F("   });\n");
         _s += F("}\n");
+        _s += F("window.addEventListener('load', function() { drawHistory(); setInterval(drawHistory, 60000); });\n");
 
         return _s;
     }
 };
 
-void handleRoot(AsyncWebServerRequest* request) {
-    AsyncWebRequestWrapper asyncWebRequestWrapper(request);
-    if (iotWebConf.handleCaptivePortal(&asyncWebRequestWrapper)) {
-        return;
-    }
-
-    std::string content_;
+// The root page does not change between requests, the live values come from /data.
+// It is built on the first request after boot or a configuration change and
+// then sent from memory without a copy. Only one copy is kept: while a
+// response still sends it, a changed page is not rebuilt and the old one
+// with its own ETag is sent until the last response is done.
+std::string RootPage;
+uint8_t RootPageSending = 0;
+bool RootPageValid = false;
+uint32_t RootPageVersion = 0;
+// The page number alone repeats after every reboot and firmware update, so a
+// browser would keep the page of the old firmware, see formatETag().
+char RootPageETag[48];
+
+void buildRootPage() {
+    std::string& content_ = RootPage;
     MyHtmlRootFormatProvider fp_;
 
+    content_.clear();
+
 	content_ += fp_.getHtmlHead(iotWebConf.getThingName()).c_str();
 
     content_ += String(F("<link rel=\"icon\" type=\"image/png\" sizes=\"96x96\" href=\"/apple-touch-icon.png\">\n")).c_str();
@@ -273,13 +757,19 @@ void handleRoot(AsyncWebServerRequest* request) {
 	content_ += fp_.getHtmlTableRowSpan("Feels like:", "no data", "HeatIndexValue").c_str();
 	content_ += fp_.getHtmlTableRowSpan("Pressure:", "no data", "PressureValue").c_str();
 	content_ += fp_.getHtmlTableRowSpan("Humidity:", "no data", "HumidityValue").c_str();
+	content_ += fp_.getHtmlTableRowSpan("Tendency:", "no data", "TendencyValue").c_str();
 	content_ += fp_.getHtmlTableEnd().c_str();
 	content_ += fp_.getHtmlFieldsetEnd().c_str();
 
+	content_ += fp_.getHtmlFieldset("Pressure (24 h)").c_str();
+	content_ += String(F("<canvas id=\"PressureChart\" width=\"300\" height=\"120\"></canvas>\n")).c_str();
+	content_ += String(F("<div align=\"right\"><span id=\"PressureRange\">no data</span></div>\n")).c_str();
+	content_ += fp_.getHtmlFieldsetEnd().c_str();
+
 	content_ += fp_.getHtmlFieldset("Network").c_str();
 	content_ += fp_.getHtmlTable().c_str();
-	content_ += fp_.getHtmlTableRowText("MAC Address:", WiFi.macAddress().c_str()).c_str();
-	content_ += fp_.getHtmlTableRowText("IP Address:", WiFi.localIP().toString().c_str()).c_str();
+	content_ += fp_.getHtmlTableRowSpan("MAC Address:", "no data", "MACValue").c_str();
+	content_ += fp_.getHtmlTableRowSpan("IP Address:", "no data", "IPValue").c_str();
 	content_ += fp_.getHtmlTableEnd().c_str();
 	content_ += fp_.getHtmlFieldsetEnd().c_str();
 
@@ -298,34 +788,140 @@ void handleRoot(AsyncWebServerRequest* request) {
     content_ += fp_.getHtmlTableEnd().c_str();
     content_ += fp_.getHtmlEnd().c_str();
 
-    AsyncWebServerResponse* response = request->beginChunkedResponse("text/html", [content_](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+    RootPageVersion++;
+    RootPageValid = true;
+    formatETag(RootPageETag, sizeof(RootPageETag), RootPageVersion);
+}
+
+void handleRoot(AsyncWebServerRequest* request) {
+    AsyncWebRequestWrapper asyncWebRequestWrapper(request);
+    if (iotWebConf.handleCaptivePortal(&asyncWebRequestWrapper)) {
+        return;
+    }
+
+    if (!RootPageValid && RootPageSending == 0) {
+        buildRootPage();
+    }
+
+    const AsyncWebHeader* header_ = request->getHeader("If-None-Match");
+    if (header_ != nullptr && strcmp(header_->value().c_str(), RootPageETag) == 0) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", RootPageETag);
+        request->send(response);
+        return;
+    }
+
+    RootPageSending++;
+    request->onDisconnect([]() { RootPageSending--; });
 
-        std::string chunk_ = "";
-        size_t len_ = min(content_.length() - index, maxLen);
-        if (len_ > 0) {
-            chunk_ = content_.substr(index, len_ - 1);
-            chunk_.copy((char*)buffer, chunk_.length());
+    AsyncWebServerResponse* response = request->beginResponse_P(200, "text/html", (const uint8_t*)RootPage.c_str(), RootPage.length());
+    response->addHeader("Server", "ESP Async Web Server");
+    response->addHeader("ETag", RootPageETag);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
+// /history is sent as CSV with rows of a fixed width. The web server asks
+// for the body piece by piece and the row of each piece follows from its
+// offset, so the body is never held in memory.
+#define HISTORY_ROW_LEN 28
+const char HistoryHeader[] = "minute,temperature,humidity,pressure\n";
+
+// minute_ is 0 for the newest entry and negative for older ones
+void printHistoryRow(TextWriter& writer_, int32_t minute_, const HistoryEntry* entry_) {
+    char temperature_[8] = "";
+    char humidity_[7] = "";
+    char pressure_[7] = "";
+
+    if (entry_ != nullptr) {
+        double value_ = History::temperature(*entry_);
+        if (!isnan(value_)) {
+            snprintf(temperature_, sizeof(temperature_), "%.2f", value_);
+        }
+        value_ = History::humidity(*entry_);
+        if (!isnan(value_)) {
+            snprintf(humidity_, sizeof(humidity_), "%.2f", value_);
         }
-        if (index + len_ <= content_.length())
-            return chunk_.length();
-        else
-            return 0;
+        value_ = History::pressure(*entry_);
+        if (!isnan(value_)) {
+            snprintf(pressure_, sizeof(pressure_), "%.1f", value_);
+        }
+    }
 
+    writer_.printf("%5ld,%7s,%6s,%6s\n", (long)minute_, temperature_, humidity_, pressure_);
+}
+
+size_t renderHistoryChunk(char* buffer_, size_t maxLen_, size_t index_, uint32_t first_, uint32_t end_) {
+    const size_t headerLen_ = sizeof(HistoryHeader) - 1;
+    size_t row_ = 0;
+    size_t skip_ = index_;
+
+    if (index_ >= headerLen_) {
+        row_ = (index_ - headerLen_) / HISTORY_ROW_LEN;
+        skip_ = (index_ - headerLen_) % HISTORY_ROW_LEN;
+    }
+
+    TextWriter writer_(buffer_, maxLen_, skip_);
+    if (index_ < headerLen_) {
+        writer_.print(HistoryHeader);
+    }
+
+    for (uint32_t i = first_ + row_; i < end_ && !writer_.full(); i++) {
+        HistoryEntry entry_;
+        bool valid_ = gHistory.get(i, entry_);
+        printHistoryRow(writer_, (int32_t)i - (int32_t)(end_ - 1), valid_ ? &entry_ : nullptr);
+    }
+
+    return writer_.length();
+}
+
+void handleHistory(AsyncWebServerRequest* request) {
+    uint32_t first_ = gHistory.first();
+    uint32_t end_ = gHistory.end();
+    size_t length_ = sizeof(HistoryHeader) - 1 + (end_ - first_) * HISTORY_ROW_LEN;
+
+    AsyncWebServerResponse* response = request->beginResponse("text/csv", length_, [first_, end_](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        return renderHistoryChunk((char*)buffer, maxLen, index, first_, end_);
         });
-    response->addHeader("Server", "ESP Async Web Server");
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
+void handleFavicon(AsyncWebServerRequest* request) {
+    AsyncWebServerResponse* response = request->beginResponse_P(200, "image/png", favicon_ico, sizeof(favicon_ico));
+    response->addHeader("Cache-Control", "public, max-age=86400");
     request->send(response);
 }
 
 void convertParams() {
-    gTempSource = tN2kTempSource(atoi(TempSourceValue));
-    gHumiditySource = tN2kHumiditySource(atoi(HumiditySourceValue));
+    ConfigSnapshot& config_ = gConfig.edit();
+
+    config_.TempSource = tN2kTempSource(atoi(TempSourceValue));
+    config_.HumiditySource = tN2kHumiditySource(atoi(HumiditySourceValue));
+    config_.SamplingProfile = tBME280Profile(atoi(SamplingProfileValue));
+
+    config_.Instance = Config.Instance();
+    config_.SID = Config.SID();
+
+    for (uint8_t i = 0; i < DeviceCount; i++) {
+        config_.Sources[i] = Config.Source(i);
+    }
+
+    TransmitPolicy temperature_ = { TransmitSettings.DeadbandTemperature(), TransmitSettings.MinInterval(), TransmitSettings.MaxInterval() };
+    TransmitPolicy humidity_ = { TransmitSettings.DeadbandHumidity(), TransmitSettings.MinInterval(), TransmitSettings.MaxInterval() };
+    TransmitPolicy pressure_ = { TransmitSettings.DeadbandPressure(), TransmitSettings.MinInterval(), TransmitSettings.MaxInterval() };
+
+    config_.Policy[ChannelTemperature] = temperature_;
+    config_.Policy[ChannelHumidity] = humidity_;
+    config_.Policy[ChannelPressure] = pressure_;
+    config_.Policy[ChannelDewPoint] = temperature_;
+    config_.Policy[ChannelHeatIndex] = temperature_;
+    config_.MaxAge = TransmitSettings.MaxAge();
 
-    gN2KInstance = Config.Instance();
-    gN2KSID = Config.SID();
+    config_.StormAlert = WeatherSettings.StormAlert();
+    config_.StormThreshold = WeatherSettings.StormThreshold();
 
-    gN2KSource[DeviceTemperature] = Config.Source();
-    gN2KSource[DevicePressure] = Config.SourcePressure();
-    gN2KSource[DeviceHumidity] = Config.SourceHumidity();
+    gConfig.publish();
 
     APModeOfflineTime = atoi(APModeOfflineValue);
 
@@ -334,5 +930,5 @@ void convertParams() {
 
 void configSaved() {
     convertParams();
-    gParamsChanged = true;
+    RootPageValid = false; // the thing name may have changed
 }
\ No newline at end of file
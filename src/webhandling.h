@@ -14,122 +14,143 @@
 #include <IotWebConfOptionalGroup.h>
 #include <WebSerial.h>
 
+#include "common.h"
+
 #define STRING_LEN 64
 #define NUMBER_LEN 5
 
-static char TempSourceValues[][STRING_LEN] = {
-    "1",
-    "2",
-    "3",
-    "4",
-    "7",
-    "8",
-    "13",
-    "14",
-};
-
-static char TempSourceNames[][STRING_LEN] = { 
-    "outside", 
-    "inside", 
-    "engine room", 
-    "main cabin", 
-    "refridgeration",
-    "heating system", 
-    "freezer", 
-    "exhaust gas"
-};
-
-static char HumiditySourceValues[][STRING_LEN] = {
-    "1",
-    "2",
-    "255"
-};
-
-static char HumiditySourceNames[][STRING_LEN] = {
-    "inside",
-    "outside",
-    "unknown"
-};
-
 // -- Initial password to connect to the Thing, when it creates an own Access Point.
 const char wifiInitialApPassword[] = "123456789";
 
 extern void wifiInit();
 extern void wifiLoop();
 
-static WiFiClient wifiClient;
 extern AsyncIotWebConf iotWebConf;
 
+// Hidden parameter that keeps the source address of one virtual device
+struct SourceSetting {
+    char Id[STRING_LEN];
+    char Value[NUMBER_LEN];
+    char Default[NUMBER_LEN];
+    iotwebconf::NumberParameter Param = iotwebconf::NumberParameter("Source", Id, Value, NUMBER_LEN, Default, nullptr, nullptr);
+};
+
 class NMEAConfig : public iotwebconf::ParameterGroup {
 public:
     NMEAConfig() : ParameterGroup("nmeaconfig", "NMEA configuration") {
         snprintf(instanceID, STRING_LEN, "%s-instance", this->getId());
         snprintf(sidID, STRING_LEN, "%s-sid", this->getId());
-        snprintf(sourceID, STRING_LEN, "%s-source", this->getId());
 
         this->addItem(&this->InstanceParam);
         this->addItem(&this->SIDParam);
 
-        iotWebConf.addHiddenParameter(&SourceParam);
-
-        // additional sources
-        snprintf(sourceIDPressure, STRING_LEN, "%s-sourcepressure", this->getId());
-        snprintf(sourceIDHumidity, STRING_LEN, "%s-sourcehumidity", this->getId());
-
-        iotWebConf.addHiddenParameter(&SourcePressureParam);
-        iotWebConf.addHiddenParameter(&SourceHumidityParam);
-
+        // One source per virtual device. The ids of the first sensor are the
+        // ones of the single sensor firmware, so saved addresses are kept.
+        for (uint8_t i = 0; i < DeviceCount; i++) {
+            if (i < DevicesPerSensor) {
+                const char* names_[DevicesPerSensor] = { "source", "sourcepressure", "sourcehumidity" };
+                snprintf(Sources[i].Id, STRING_LEN, "%s-%s", this->getId(), names_[i]);
+            }
+            else {
+                snprintf(Sources[i].Id, STRING_LEN, "%s-source%u", this->getId(), i);
+            }
+            snprintf(Sources[i].Default, NUMBER_LEN, "%u", 22 + i);
+            iotWebConf.addHiddenParameter(&Sources[i].Param);
+        }
     }
 
     uint8_t Instance() { return atoi(InstanceValue); };
     uint8_t SID() { return atoi(SIDValue); };
-    uint8_t Source() { return atoi(SourceValue); };
-
-    void SetSource(uint8_t source_) {
-        String s;
-        s = (String)source_;
-        strncpy(SourceParam.valueBuffer, s.c_str(), NUMBER_LEN);
-    }
 
-    // additional sources
-    uint8_t SourcePressure() { return atoi(SourcePressureValue); };
-    uint8_t SourceHumidity() { return atoi(SourceHumidityValue); };
+    uint8_t Source(uint8_t device_) { return atoi(Sources[device_].Value); };
 
-    void SetSourcePressure(uint8_t source_) {
-        String s;
-        s = (String)source_;
-        strncpy(SourcePressureParam.valueBuffer, s.c_str(), NUMBER_LEN);
+    void SetSource(uint8_t device_, uint8_t source_) {
+        snprintf(Sources[device_].Value, NUMBER_LEN, "%u", source_);
     }
 
-    void SetSourceHumidity(uint8_t source_) {
-        String s;
-        s = (String)source_;
-        strncpy(SourceHumidityParam.valueBuffer, s.c_str(), NUMBER_LEN);
-    }
 private:
     iotwebconf::NumberParameter InstanceParam = iotwebconf::NumberParameter("Instance", instanceID, InstanceValue, NUMBER_LEN, "255", "1..255", "min='1' max='254' step='1'");
     iotwebconf::NumberParameter SIDParam = iotwebconf::NumberParameter("SID", sidID, SIDValue, NUMBER_LEN, "255", "1..255", "min='1' max='255' step='1'");
-    iotwebconf::NumberParameter SourceParam = iotwebconf::NumberParameter("Source", sourceID, SourceValue, NUMBER_LEN, "22", nullptr, nullptr);
 
     char InstanceValue[NUMBER_LEN];
     char SIDValue[NUMBER_LEN];
-    char SourceValue[NUMBER_LEN];
-
 
     char instanceID[STRING_LEN];
     char sidID[STRING_LEN];
-    char sourceID[STRING_LEN];
 
-    // additional sources
-    iotwebconf::NumberParameter SourcePressureParam = iotwebconf::NumberParameter("SourcePressure", sourceIDPressure, SourcePressureValue, NUMBER_LEN, "23", nullptr, nullptr);
-    iotwebconf::NumberParameter SourceHumidityParam = iotwebconf::NumberParameter("SourceHumidity", sourceIDHumidity, SourceHumidityValue, NUMBER_LEN, "24", nullptr, nullptr);
-    char SourcePressureValue[NUMBER_LEN];
-    char SourceHumidityValue[NUMBER_LEN];
+    SourceSetting Sources[DeviceCount];
+};
+
+class TransmitConfig : public iotwebconf::ParameterGroup {
+public:
+    TransmitConfig() : ParameterGroup("transmitconfig", "Transmit policy") {
+        snprintf(deadbandTemperatureID, STRING_LEN, "%s-dbtemperature", this->getId());
+        snprintf(deadbandHumidityID, STRING_LEN, "%s-dbhumidity", this->getId());
+        snprintf(deadbandPressureID, STRING_LEN, "%s-dbpressure", this->getId());
+        snprintf(minIntervalID, STRING_LEN, "%s-mininterval", this->getId());
+        snprintf(maxIntervalID, STRING_LEN, "%s-maxinterval", this->getId());
+        snprintf(maxAgeID, STRING_LEN, "%s-maxage", this->getId());
+
+        this->addItem(&this->DeadbandTemperatureParam);
+        this->addItem(&this->DeadbandHumidityParam);
+        this->addItem(&this->DeadbandPressureParam);
+        this->addItem(&this->MinIntervalParam);
+        this->addItem(&this->MaxIntervalParam);
+        this->addItem(&this->MaxAgeParam);
+    }
 
-    char sourceIDPressure[STRING_LEN];
-    char sourceIDHumidity[STRING_LEN];
+    double DeadbandTemperature() { return atof(DeadbandTemperatureValue); };
+    double DeadbandHumidity() { return atof(DeadbandHumidityValue); };
+    double DeadbandPressure() { return atof(DeadbandPressureValue); };
+    uint32_t MinInterval() { return atol(MinIntervalValue); }; // ms
+    uint32_t MaxInterval() { return atol(MaxIntervalValue) * 1000; }; // s to ms
+    uint32_t MaxAge() { return atol(MaxAgeValue); }; // ms
 
+private:
+    iotwebconf::NumberParameter DeadbandTemperatureParam = iotwebconf::NumberParameter("Temperature deadband (&deg;C)", deadbandTemperatureID, DeadbandTemperatureValue, NUMBER_LEN, "0.1", "0..10", "min='0' max='10' step='0.05'");
+    iotwebconf::NumberParameter DeadbandHumidityParam = iotwebconf::NumberParameter("Humidity deadband (%)", deadbandHumidityID, DeadbandHumidityValue, NUMBER_LEN, "0.5", "0..10", "min='0' max='10' step='0.1'");
+    iotwebconf::NumberParameter DeadbandPressureParam = iotwebconf::NumberParameter("Pressure deadband (mBar)", deadbandPressureID, DeadbandPressureValue, NUMBER_LEN, "0.1", "0..10", "min='0' max='10' step='0.05'");
+    iotwebconf::NumberParameter MinIntervalParam = iotwebconf::NumberParameter("Minimum interval (ms)", minIntervalID, MinIntervalValue, NUMBER_LEN, "500", "500..5000", "min='500' max='5000' step='500'");
+    iotwebconf::NumberParameter MaxIntervalParam = iotwebconf::NumberParameter("Heartbeat interval (s)", maxIntervalID, MaxIntervalValue, NUMBER_LEN, "5", "1..600", "min='1' max='600' step='1'");
+    iotwebconf::NumberParameter MaxAgeParam = iotwebconf::NumberParameter("Maximum age (ms)", maxAgeID, MaxAgeValue, sizeof(MaxAgeValue), "1000", "500..10000", "min='500' max='10000' step='100'");
+
+    char DeadbandTemperatureValue[NUMBER_LEN];
+    char DeadbandHumidityValue[NUMBER_LEN];
+    char DeadbandPressureValue[NUMBER_LEN];
+    char MinIntervalValue[NUMBER_LEN];
+    char MaxIntervalValue[NUMBER_LEN];
+    char MaxAgeValue[NUMBER_LEN + 1]; // up to 10000
+
+    char deadbandTemperatureID[STRING_LEN];
+    char deadbandHumidityID[STRING_LEN];
+    char deadbandPressureID[STRING_LEN];
+    char minIntervalID[STRING_LEN];
+    char maxIntervalID[STRING_LEN];
+    char maxAgeID[STRING_LEN];
 };
 
-#endif
+class WeatherConfig : public iotwebconf::ParameterGroup {
+public:
+    WeatherConfig() : ParameterGroup("weatherconfig", "Storm warning") {
+        snprintf(stormAlertID, STRING_LEN, "%s-stormalert", this->getId());
+        snprintf(stormThresholdID, STRING_LEN, "%s-stormthreshold", this->getId());
 
+        this->addItem(&this->StormAlertParam);
+        this->addItem(&this->StormThresholdParam);
+    }
+
+    bool StormAlert() { return StormAlertParam.isChecked(); };
+    double StormThreshold() { return atof(StormThresholdValue); }; // mBar per 3 h
+
+private:
+    iotwebconf::CheckboxParameter StormAlertParam = iotwebconf::CheckboxParameter("Send alert on NMEA 2000", stormAlertID, StormAlertValue, NUMBER_LEN, true);
+    iotwebconf::NumberParameter StormThresholdParam = iotwebconf::NumberParameter("Pressure drop (mBar in 3 h)", stormThresholdID, StormThresholdValue, NUMBER_LEN, "4", "1..10", "min='1' max='10' step='0.5'");
+
+    char StormAlertValue[NUMBER_LEN];
+    char StormThresholdValue[NUMBER_LEN];
+
+    char stormAlertID[STRING_LEN];
+    char stormThresholdID[STRING_LEN];
+};
+
+#endif
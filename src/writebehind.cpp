@@ -0,0 +1,65 @@
+// 
+// 
+// 
+
+#include "writebehind.h"
+
+WriteBehind::WriteBehind() {
+	this->_dirty = 0;
+	this->_firstChange = 0;
+	this->_lastChange = 0;
+	this->_budget = MaxWritesPerHour;
+	this->_refillTime = 0;
+	this->_writes = 0;
+	this->_changes = 0;
+}
+
+/*
+ * Called for every reported change. Each one restarts the settle time, also
+ * when the same fields change again (a device claiming one address after
+ * the other). The first change starts the maximal delay, a mask of 0 drops
+ * the pending write.
+ */
+void WriteBehind::update(uint32_t dirty_, uint32_t now_) {
+	if (this->_dirty == 0) {
+		this->_firstChange = now_;
+	}
+	this->_dirty = dirty_;
+	this->_lastChange = now_;
+	this->_changes++;
+}
+
+/*
+ * Due when the fields settled or waited MaxDelay, and a write is left in
+ * the budget. Without budget the write waits for the next refill.
+ */
+bool WriteBehind::due(uint32_t now_) {
+	this->refill(now_);
+
+	if (this->_dirty == 0 || this->_budget == 0) {
+		return false;
+	}
+
+	return now_ - this->_lastChange >= SettleTime || now_ - this->_firstChange >= MaxDelay;
+}
+
+void WriteBehind::written(uint32_t now_) {
+	this->refill(now_);
+
+	if (this->_budget == MaxWritesPerHour) {
+		this->_refillTime = now_;
+	}
+	if (this->_budget > 0) {
+		this->_budget--;
+	}
+	this->_dirty = 0;
+	this->_writes++;
+}
+
+// One write comes back every Refill ms, up to MaxWritesPerHour
+void WriteBehind::refill(uint32_t now_) {
+	while (this->_budget < MaxWritesPerHour && now_ - this->_refillTime >= Refill) {
+		this->_budget++;
+		this->_refillTime += Refill;
+	}
+}
@@ -0,0 +1,51 @@
+// writebehind.h
+
+#pragma once
+
+#ifndef _WRITEBEHIND_h
+#define _WRITEBEHIND_h
+
+#include <stdint.h>
+
+// Decides when changed settings are written to flash. Changes are collected
+// until they did not change for SettleTime (but at most MaxDelay), and the
+// writes are limited to MaxWritesPerHour. The caller passes the fields that
+// differ from the stored ones as a bit mask, so a value that changes back
+// cancels its pending write.
+class WriteBehind {
+public:
+    static const uint32_t SettleTime = 5000;        // ms without a change before writing
+    static const uint32_t MaxDelay = 60000;         // ms from the first change to the write
+    static const uint8_t MaxWritesPerHour = 6;
+    static const uint32_t Refill = 3600000 / MaxWritesPerHour; // ms per write
+
+    WriteBehind();
+
+    // dirty_ has one bit per field that differs from the stored value
+    void update(uint32_t dirty_, uint32_t now_);
+
+    // Returns true if the pending changes have to be written now
+    bool due(uint32_t now_);
+
+    // Call after the write, the budget is charged and the fields are clean
+    void written(uint32_t now_);
+
+    uint32_t dirty() const { return _dirty; };
+    uint32_t writes() const { return _writes; };
+    uint32_t changes() const { return _changes; };
+
+private:
+    void refill(uint32_t now_);
+
+    uint32_t _dirty;
+    uint32_t _firstChange;
+    uint32_t _lastChange;
+
+    uint8_t _budget;
+    uint32_t _refillTime;
+
+    uint32_t _writes;   // flash writes since boot
+    uint32_t _changes;  // reported changes since boot
+};
+
+#endif
@@ -0,0 +1,58 @@
+// bench_bme280compensation.cpp
+
+// Compensation of one raw sample: the fixed-point datasheet algorithm
+// against the driver's one with float results
+
+#include <benchmark/benchmark.h>
+
+#include "bme280compensation.h"
+#include "simbme280.h"
+
+static BME280Calibration calibration() {
+    const SimBME280::Calibration& sim_ = SimBME280::DatasheetCalibration;
+    BME280Calibration calib_ = {
+        sim_.T1, sim_.T2, sim_.T3,
+        sim_.P1, sim_.P2, sim_.P3, sim_.P4, sim_.P5, sim_.P6, sim_.P7, sim_.P8, sim_.P9,
+        sim_.H1, sim_.H2, sim_.H3, sim_.H4, sim_.H5, sim_.H6,
+        0
+    };
+    return calib_;
+}
+
+static void BM_CompensateFixed(benchmark::State& state) {
+    BME280Calibration calib_ = calibration();
+    BME280RawData raw_ = { 415148, 519888, 30000 };
+    BME280FixedSample sample_;
+    for (auto _ : state) {
+        BME280CompensateFixed(calib_, raw_, sample_);
+        benchmark::DoNotOptimize(sample_);
+        raw_.adc_P = raw_.adc_P > 420000 ? 410000 : raw_.adc_P + 1;
+    }
+}
+BENCHMARK(BM_CompensateFixed);
+
+static void BM_CompensateFixedToSample(benchmark::State& state) {
+    BME280Calibration calib_ = calibration();
+    BME280RawData raw_ = { 415148, 519888, 30000 };
+    BME280FixedSample fixed_;
+    BME280Sample sample_;
+    for (auto _ : state) {
+        BME280CompensateFixed(calib_, raw_, fixed_);
+        BME280FixedToSample(fixed_, sample_);
+        benchmark::DoNotOptimize(sample_);
+        raw_.adc_P = raw_.adc_P > 420000 ? 410000 : raw_.adc_P + 1;
+    }
+}
+BENCHMARK(BM_CompensateFixedToSample);
+
+static void BM_CompensateFloat(benchmark::State& state) {
+    BME280Calibration calib_ = calibration();
+    BME280RawData raw_ = { 415148, 519888, 30000 };
+    BME280Sample sample_;
+    for (auto _ : state) {
+        BME280Compensate(calib_, raw_, sample_);
+        benchmark::DoNotOptimize(sample_);
+        raw_.adc_P = raw_.adc_P > 420000 ? 410000 : raw_.adc_P + 1;
+    }
+}
+BENCHMARK(BM_CompensateFloat);
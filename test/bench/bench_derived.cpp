@@ -0,0 +1,64 @@
+// bench_derived.cpp
+
+// Dew point and heat index in double and single precision, the double
+// versions are the ones the firmware used before
+
+#include <benchmark/benchmark.h>
+
+#include <math.h>
+
+#include "derived.h"
+
+static void BM_DewPoint(benchmark::State& state) {
+    double temperature_ = 21.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dewPoint(temperature_, 55.0));
+        temperature_ = temperature_ > 30.0 ? 10.0 : temperature_ + 0.01;
+    }
+}
+BENCHMARK(BM_DewPoint);
+
+static void BM_DewPointFast(benchmark::State& state) {
+    float temperature_ = 21.0f;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dewPointFast(temperature_, 55.0f));
+        temperature_ = temperature_ > 30.0f ? 10.0f : temperature_ + 0.01f;
+    }
+}
+BENCHMARK(BM_DewPointFast);
+
+static void BM_HeatIndex(benchmark::State& state) {
+    double temperature_ = 21.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(heatIndexCelsius(temperature_, 55.0));
+        temperature_ = temperature_ > 40.0 ? 20.0 : temperature_ + 0.01;
+    }
+}
+BENCHMARK(BM_HeatIndex);
+
+static void BM_HeatIndexFast(benchmark::State& state) {
+    float temperature_ = 21.0f;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(heatIndexCelsiusFast(temperature_, 55.0f));
+        temperature_ = temperature_ > 40.0f ? 20.0f : temperature_ + 0.01f;
+    }
+}
+BENCHMARK(BM_HeatIndexFast);
+
+static void BM_Log(benchmark::State& state) {
+    double x_ = 0.01;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(log(x_));
+        x_ = x_ > 1.0 ? 0.01 : x_ + 0.001;
+    }
+}
+BENCHMARK(BM_Log);
+
+static void BM_FastLog(benchmark::State& state) {
+    float x_ = 0.01f;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fastLog(x_));
+        x_ = x_ > 1.0f ? 0.01f : x_ + 0.001f;
+    }
+}
+BENCHMARK(BM_FastLog);
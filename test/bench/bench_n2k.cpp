@@ -0,0 +1,57 @@
+// bench_n2k.cpp
+
+// A measurement message from the prebuilt template against a full encode,
+// for each of the four value encodings
+
+#include <benchmark/benchmark.h>
+
+#include "N2kMessages.h"
+#include "n2ktemplates.h"
+
+// One template of each encoding and a value in the range of the sensor
+static const struct {
+    tN2kTemplateId Id;
+    double Value;
+    double Step;
+} Encodings[] = {
+    { TemplateTemperature, 294.52, 0.01 },      // 130312, 2 byte 0.01
+    { TemplateTemperatureExt, 294.52, 0.001 },  // 130316, 3 byte 0.001
+    { TemplateHumidity, 45.2, 0.004 },          // 130313, 2 byte signed 0.004
+    { TemplatePressure, 101325.0, 0.1 }         // 130314, 4 byte signed 0.1
+};
+
+static void BM_TemplatePatch(benchmark::State& state) {
+    N2kTemplates templates_;
+    templates_.build(1, N2kts_MainCabinTemperature, N2khs_InsideHumidity);
+
+    tN2kTemplateId id_ = Encodings[state.range(0)].Id;
+    double value_ = Encodings[state.range(0)].Value;
+    double step_ = Encodings[state.range(0)].Step;
+    uint8_t sid_ = 0;
+    for (auto _ : state) {
+        const tN2kMsg& msg_ = templates_.patch(id_, sid_++, value_);
+        benchmark::DoNotOptimize(msg_.Data);
+        value_ += step_;
+    }
+}
+BENCHMARK(BM_TemplatePatch)->DenseRange(0, 3);
+
+static void BM_FullEncode(benchmark::State& state) {
+    tN2kMsg msg_;
+
+    tN2kTemplateId id_ = Encodings[state.range(0)].Id;
+    double value_ = Encodings[state.range(0)].Value;
+    double step_ = Encodings[state.range(0)].Step;
+    uint8_t sid_ = 0;
+    for (auto _ : state) {
+        switch (id_) {
+        case TemplateTemperature: SetN2kPGN130312(msg_, sid_++, 1, N2kts_MainCabinTemperature, value_, N2kDoubleNA); break;
+        case TemplateTemperatureExt: SetN2kPGN130316(msg_, sid_++, 1, N2kts_MainCabinTemperature, value_, N2kDoubleNA); break;
+        case TemplateHumidity: SetN2kPGN130313(msg_, sid_++, 2, N2khs_InsideHumidity, value_, N2kDoubleNA); break;
+        default: SetN2kPGN130314(msg_, sid_++, 3, N2kps_Atmospheric, value_); break;
+        }
+        benchmark::DoNotOptimize(msg_.Data);
+        value_ += step_;
+    }
+}
+BENCHMARK(BM_FullEncode)->DenseRange(0, 3);
@@ -0,0 +1,17 @@
+// bench_sketch.cpp
+
+// One loop() iteration of the booted sketch, including the epochs it runs
+
+#include <benchmark/benchmark.h>
+
+#include "hostsketch.h"
+#include "hostcan.h"
+
+static void BM_Loop(benchmark::State& state) {
+    HostSketch::boot();
+    for (auto _ : state) {
+        HostSketch::step();
+        gHostCan.clearSent();
+    }
+}
+BENCHMARK(BM_Loop);
@@ -0,0 +1,43 @@
+// bench_streamstats.cpp
+
+// Cost of one sample in the sliding window statistics, including the
+// buckets it closes, and of a summary
+
+#include <benchmark/benchmark.h>
+
+#include "streamstats.h"
+
+// A sample every 500 ms as the sketch adds them
+template <typename TWindow>
+static void BM_StatsAdd(benchmark::State& state) {
+    TWindow window_;
+    uint32_t now_ = 0;
+    float value_ = 1013.25f;
+    for (auto _ : state) {
+        window_.add(value_, now_);
+        now_ += 500;
+        value_ += 0.01f;
+        if (value_ > 1020.0f) {
+            value_ = 1013.25f;
+        }
+    }
+    benchmark::DoNotOptimize(window_);
+}
+BENCHMARK_TEMPLATE(BM_StatsAdd, MinuteStatistics);
+BENCHMARK_TEMPLATE(BM_StatsAdd, HourStatistics);
+BENCHMARK_TEMPLATE(BM_StatsAdd, DayStatistics);
+
+template <typename TWindow>
+static void BM_StatsSummary(benchmark::State& state) {
+    TWindow window_;
+    for (uint32_t i = 0; i < 200000; i++) {
+        window_.add(1013.25f + (i % 100) / 100.0f, i * 500);
+    }
+    StatisticsSummary summary_;
+    for (auto _ : state) {
+        window_.summary(summary_);
+        benchmark::DoNotOptimize(summary_);
+    }
+}
+BENCHMARK_TEMPLATE(BM_StatsSummary, MinuteStatistics);
+BENCHMARK_TEMPLATE(BM_StatsSummary, DayStatistics);
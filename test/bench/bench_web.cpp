@@ -0,0 +1,60 @@
+// bench_web.cpp
+
+// Requests to the web handlers of the booted sketch, the body drained in
+// segments as the TCP stack sends it. Reports requests per second and the
+// heap allocations of the handler and the response per request.
+
+#include <benchmark/benchmark.h>
+
+#include "hostsketch.h"
+#include "ESPAsyncWebServer.h"
+
+static void request(benchmark::State& state, const char* url_, const char* etag_ = nullptr) {
+    HostSketch::boot();
+    HostSketch::run(2000);
+
+    // The ETag of the current response, for the conditional requests
+    String match_;
+    if (etag_ != nullptr) {
+        AsyncWebServerRequest first_(HTTP_GET, url_);
+        AsyncWebServer::instance()->handle(first_);
+        match_ = *first_.response()->header(etag_);
+    }
+
+    size_t bytes_ = 0;
+    size_t allocations_ = 0;
+    for (auto _ : state) {
+        AsyncWebServerRequest request_(HTTP_GET, url_);
+        if (etag_ != nullptr) {
+            request_.addHeader("If-None-Match", match_);
+        }
+
+        size_t before_ = HostHeap::allocations();
+        AsyncWebServer::instance()->handle(request_);
+        bytes_ += request_.response()->drain();
+        allocations_ += HostHeap::allocations() - before_;
+    }
+    state.SetBytesProcessed(bytes_);
+    state.counters["req/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+    state.counters["allocs/req"] = benchmark::Counter(allocations_, benchmark::Counter::kAvgIterations);
+}
+
+static void BM_Data(benchmark::State& state) {
+    request(state, "/data");
+}
+BENCHMARK(BM_Data);
+
+static void BM_DataNotModified(benchmark::State& state) {
+    request(state, "/data", "ETag");
+}
+BENCHMARK(BM_DataNotModified);
+
+static void BM_Metrics(benchmark::State& state) {
+    request(state, "/metrics");
+}
+BENCHMARK(BM_Metrics);
+
+static void BM_Root(benchmark::State& state) {
+    request(state, "/");
+}
+BENCHMARK(BM_Root);
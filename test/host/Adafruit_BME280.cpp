@@ -0,0 +1,280 @@
+//
+//
+//
+
+#include "Adafruit_BME280.h"
+
+bool Adafruit_I2CDevice::begin(bool addrDetect_) {
+	return !addrDetect_ || this->detected();
+}
+
+bool Adafruit_I2CDevice::detected() {
+	return this->_wire->transfer(this->_addr, nullptr, 0, nullptr, 0);
+}
+
+bool Adafruit_I2CDevice::read(uint8_t* buffer_, size_t len_, bool stop_) {
+	(void)stop_;
+	return this->_wire->transfer(this->_addr, nullptr, 0, buffer_, len_);
+}
+
+bool Adafruit_I2CDevice::write(const uint8_t* buffer_, size_t len_, bool stop_, const uint8_t* prefixBuffer_, size_t prefixLen_) {
+	(void)stop_;
+	uint8_t data_[32];
+	size_t length_ = 0;
+
+	for (size_t i = 0; i < prefixLen_ && length_ < sizeof(data_); i++) {
+		data_[length_++] = prefixBuffer_[i];
+	}
+	for (size_t i = 0; i < len_ && length_ < sizeof(data_); i++) {
+		data_[length_++] = buffer_[i];
+	}
+	return this->_wire->transfer(this->_addr, data_, length_, nullptr, 0);
+}
+
+bool Adafruit_I2CDevice::write_then_read(const uint8_t* writeBuffer_, size_t writeLen_, uint8_t* readBuffer_, size_t readLen_, bool stop_) {
+	(void)stop_;
+	return this->_wire->transfer(this->_addr, writeBuffer_, writeLen_, readBuffer_, readLen_);
+}
+
+Adafruit_BME280::Adafruit_BME280() {
+}
+
+Adafruit_BME280::~Adafruit_BME280() {
+	delete this->i2c_dev;
+}
+
+bool Adafruit_BME280::begin(uint8_t addr_, TwoWire* theWire_) {
+	delete this->i2c_dev;
+	this->i2c_dev = new Adafruit_I2CDevice(addr_, theWire_);
+	if (!this->i2c_dev->begin()) {
+		return false;
+	}
+	return this->init();
+}
+
+bool Adafruit_BME280::init() {
+	this->_sensorID = this->read8(BME280_REGISTER_CHIPID);
+	if (this->_sensorID != 0x60) {
+		return false;
+	}
+
+	// reset the device using soft-reset, this makes sure the IIR is off, etc.
+	this->write8(BME280_REGISTER_SOFTRESET, 0xB6);
+	delay(10);
+
+	// if chip is still reading calibration, delay
+	while (this->isReadingCalibration()) {
+		delay(10);
+	}
+
+	this->readCoefficients();
+	this->setSampling();
+	delay(100);
+	return true;
+}
+
+void Adafruit_BME280::setSampling(sensor_mode mode_, sensor_sampling tempSampling_, sensor_sampling pressSampling_,
+	sensor_sampling humSampling_, sensor_filter filter_, standby_duration duration_) {
+	this->_measReg.mode = mode_;
+	this->_measReg.osrs_t = tempSampling_;
+	this->_measReg.osrs_p = pressSampling_;
+
+	this->_humReg.osrs_h = humSampling_;
+	this->_configReg.filter = filter_;
+	this->_configReg.t_sb = duration_;
+	this->_configReg.spi3w_en = 0;
+
+	// making sure sensor is in sleep mode before setting configuration
+	// as it otherwise may be ignored
+	this->write8(BME280_REGISTER_CONTROL, MODE_SLEEP);
+
+	// you must make sure to also set REGISTER_CONTROL after setting the
+	// CONTROLHUMID register, otherwise the values won't be applied (see
+	// DS 5.4.3)
+	this->write8(BME280_REGISTER_CONTROLHUMID, this->_humReg.get());
+	this->write8(BME280_REGISTER_CONFIG, this->_configReg.get());
+	this->write8(BME280_REGISTER_CONTROL, this->_measReg.get());
+}
+
+bool Adafruit_BME280::takeForcedMeasurement() {
+	bool return_value = false;
+	// If we are in forced mode, the BME sensor goes back to sleep after each
+	// measurement and we need to set it to forced mode once at this point, so
+	// it will take the next measurement and then return to sleep again.
+	// In normal mode simply does new measurements periodically.
+	if (this->_measReg.mode == MODE_FORCED) {
+		return_value = true;
+		// set to forced mode, i.e. "take next measurement"
+		this->write8(BME280_REGISTER_CONTROL, this->_measReg.get());
+		// Store current time to measure the timeout
+		uint32_t timeout_start = millis();
+		// wait until measurement has been completed, otherwise we would read the
+		// the values from the last measurement or the timeout occurred after 2 sec.
+		while (this->read8(BME280_REGISTER_STATUS) & 0x08) {
+			// In case of a timeout, stop the while loop
+			if ((millis() - timeout_start) > 2000) {
+				return_value = false;
+				break;
+			}
+			delay(1);
+		}
+	}
+	return return_value;
+}
+
+float Adafruit_BME280::readTemperature() {
+	int32_t var1, var2;
+
+	int32_t adc_T = this->read24(BME280_REGISTER_TEMPDATA);
+	if (adc_T == 0x800000) // value in case temp measurement was disabled
+		return NAN;
+	adc_T >>= 4;
+
+	var1 = (int32_t)((adc_T / 8) - ((int32_t)this->_bme280_calib.dig_T1 * 2));
+	var1 = (var1 * ((int32_t)this->_bme280_calib.dig_T2)) / 2048;
+	var2 = (int32_t)((adc_T / 16) - ((int32_t)this->_bme280_calib.dig_T1));
+	var2 = (((var2 * var2) / 4096) * ((int32_t)this->_bme280_calib.dig_T3)) / 16384;
+
+	this->t_fine = var1 + var2 + this->t_fine_adjust;
+
+	int32_t T = (this->t_fine * 5 + 128) / 256;
+
+	return (float)T / 100;
+}
+
+float Adafruit_BME280::readPressure() {
+	int64_t var1, var2, var3, var4;
+
+	this->readTemperature(); // must be done first to get t_fine
+
+	int32_t adc_P = this->read24(BME280_REGISTER_PRESSUREDATA);
+	if (adc_P == 0x800000) // value in case pressure measurement was disabled
+		return NAN;
+	adc_P >>= 4;
+
+	var1 = ((int64_t)this->t_fine) - 128000;
+	var2 = var1 * var1 * (int64_t)this->_bme280_calib.dig_P6;
+	var2 = var2 + ((var1 * (int64_t)this->_bme280_calib.dig_P5) * 131072);
+	var2 = var2 + (((int64_t)this->_bme280_calib.dig_P4) * 34359738368);
+	var1 = ((var1 * var1 * (int64_t)this->_bme280_calib.dig_P3) / 256) +
+		((var1 * ((int64_t)this->_bme280_calib.dig_P2) * 4096));
+	var3 = ((int64_t)1) * 140737488355328;
+	var1 = (var3 + var1) * ((int64_t)this->_bme280_calib.dig_P1) / 8589934592;
+
+	if (var1 == 0) {
+		return 0; // avoid exception caused by division by zero
+	}
+
+	var4 = 1048576 - adc_P;
+	var4 = (((var4 * 2147483648) - var2) * 3125) / var1;
+	var1 = (((int64_t)this->_bme280_calib.dig_P9) * (var4 / 8192) * (var4 / 8192)) / 33554432;
+	var2 = (((int64_t)this->_bme280_calib.dig_P8) * var4) / 524288;
+	var4 = ((var4 + var1 + var2) / 256) + (((int64_t)this->_bme280_calib.dig_P7) * 16);
+
+	float P = var4 / 256.0;
+
+	return P;
+}
+
+float Adafruit_BME280::readHumidity() {
+	int32_t var1, var2, var3, var4, var5;
+
+	this->readTemperature(); // must be done first to get t_fine
+
+	int32_t adc_H = this->read16(BME280_REGISTER_HUMIDDATA);
+	if (adc_H == 0x8000) // value in case humidity measurement was disabled
+		return NAN;
+
+	var1 = this->t_fine - ((int32_t)76800);
+	var2 = (int32_t)(adc_H * 16384);
+	var3 = (int32_t)(((int32_t)this->_bme280_calib.dig_H4) * 1048576);
+	var4 = ((int32_t)this->_bme280_calib.dig_H5) * var1;
+	var5 = (((var2 - var3) - var4) + (int32_t)16384) / 32768;
+	var2 = (var1 * ((int32_t)this->_bme280_calib.dig_H6)) / 1024;
+	var3 = (var1 * ((int32_t)this->_bme280_calib.dig_H3)) / 2048;
+	var4 = ((var2 * (var3 + (int32_t)32768)) / 1024) + (int32_t)2097152;
+	var2 = ((var4 * ((int32_t)this->_bme280_calib.dig_H2)) + 8192) / 16384;
+	var3 = var5 * var2;
+	var4 = ((var3 / 32768) * (var3 / 32768)) / 128;
+	var5 = var3 - ((var4 * ((int32_t)this->_bme280_calib.dig_H1)) / 16);
+	var5 = (var5 < 0 ? 0 : var5);
+	var5 = (var5 > 419430400 ? 419430400 : var5);
+	uint32_t H = (uint32_t)(var5 / 4096);
+
+	return (float)H / 1024.0;
+}
+
+float Adafruit_BME280::getTemperatureCompensation() {
+	return float((this->t_fine_adjust * 5) >> 8) / 100.0;
+}
+
+void Adafruit_BME280::setTemperatureCompensation(float adjustment_) {
+	// convert the value in C into and adjustment to t_fine
+	this->t_fine_adjust = ((int32_t(adjustment_ * 100) * 256)) / 5;
+}
+
+void Adafruit_BME280::readCoefficients() {
+	this->_bme280_calib.dig_T1 = this->read16_LE(BME280_REGISTER_DIG_T1);
+	this->_bme280_calib.dig_T2 = this->readS16_LE(BME280_REGISTER_DIG_T2);
+	this->_bme280_calib.dig_T3 = this->readS16_LE(BME280_REGISTER_DIG_T3);
+
+	this->_bme280_calib.dig_P1 = this->read16_LE(BME280_REGISTER_DIG_P1);
+	this->_bme280_calib.dig_P2 = this->readS16_LE(BME280_REGISTER_DIG_P2);
+	this->_bme280_calib.dig_P3 = this->readS16_LE(BME280_REGISTER_DIG_P3);
+	this->_bme280_calib.dig_P4 = this->readS16_LE(BME280_REGISTER_DIG_P4);
+	this->_bme280_calib.dig_P5 = this->readS16_LE(BME280_REGISTER_DIG_P5);
+	this->_bme280_calib.dig_P6 = this->readS16_LE(BME280_REGISTER_DIG_P6);
+	this->_bme280_calib.dig_P7 = this->readS16_LE(BME280_REGISTER_DIG_P7);
+	this->_bme280_calib.dig_P8 = this->readS16_LE(BME280_REGISTER_DIG_P8);
+	this->_bme280_calib.dig_P9 = this->readS16_LE(BME280_REGISTER_DIG_P9);
+
+	this->_bme280_calib.dig_H1 = this->read8(BME280_REGISTER_DIG_H1);
+	this->_bme280_calib.dig_H2 = this->readS16_LE(BME280_REGISTER_DIG_H2);
+	this->_bme280_calib.dig_H3 = this->read8(BME280_REGISTER_DIG_H3);
+	this->_bme280_calib.dig_H4 = ((int8_t)this->read8(BME280_REGISTER_DIG_H4) * 16) |
+		(this->read8(BME280_REGISTER_DIG_H4 + 1) & 0xF);
+	this->_bme280_calib.dig_H5 = ((int8_t)this->read8(BME280_REGISTER_DIG_H5 + 1) * 16) |
+		(this->read8(BME280_REGISTER_DIG_H5) >> 4);
+	this->_bme280_calib.dig_H6 = (int8_t)this->read8(BME280_REGISTER_DIG_H6);
+}
+
+bool Adafruit_BME280::isReadingCalibration() {
+	uint8_t const rStatus = this->read8(BME280_REGISTER_STATUS);
+	return (rStatus & (1 << 0)) != 0;
+}
+
+void Adafruit_BME280::write8(byte reg_, byte value_) {
+	byte buffer_[2] = { reg_, value_ };
+	this->i2c_dev->write(buffer_, 2);
+}
+
+uint8_t Adafruit_BME280::read8(byte reg_) {
+	uint8_t buffer_[1] = { reg_ };
+	this->i2c_dev->write_then_read(buffer_, 1, buffer_, 1);
+	return buffer_[0];
+}
+
+uint16_t Adafruit_BME280::read16(byte reg_) {
+	uint8_t buffer_[2] = { reg_, 0 };
+	this->i2c_dev->write_then_read(buffer_, 1, buffer_, 2);
+	return uint16_t(buffer_[0]) << 8 | uint16_t(buffer_[1]);
+}
+
+uint32_t Adafruit_BME280::read24(byte reg_) {
+	uint8_t buffer_[3] = { reg_, 0, 0 };
+	this->i2c_dev->write_then_read(buffer_, 1, buffer_, 3);
+	return uint32_t(buffer_[0]) << 16 | uint32_t(buffer_[1]) << 8 | uint32_t(buffer_[2]);
+}
+
+uint16_t Adafruit_BME280::read16_LE(byte reg_) {
+	uint16_t temp_ = this->read16(reg_);
+	return (temp_ >> 8) | (temp_ << 8);
+}
+
+int16_t Adafruit_BME280::readS16(byte reg_) {
+	return (int16_t)this->read16(reg_);
+}
+
+int16_t Adafruit_BME280::readS16_LE(byte reg_) {
+	return (int16_t)this->read16_LE(reg_);
+}
@@ -0,0 +1,30 @@
+// Adafruit_I2CDevice.h
+
+#pragma once
+
+#ifndef _HOST_ADAFRUIT_I2CDEVICE_h
+#define _HOST_ADAFRUIT_I2CDEVICE_h
+
+#include "Wire.h"
+
+// Adafruit_BusIO device on the simulated bus, one call is one transaction
+class Adafruit_I2CDevice {
+public:
+    Adafruit_I2CDevice(uint8_t addr_, TwoWire* theWire_ = &Wire) : _addr(addr_), _wire(theWire_) {}
+
+    // Probes the address with an empty write
+    bool begin(bool addrDetect_ = true);
+    bool detected();
+
+    bool read(uint8_t* buffer_, size_t len_, bool stop_ = true);
+    bool write(const uint8_t* buffer_, size_t len_, bool stop_ = true, const uint8_t* prefixBuffer_ = nullptr, size_t prefixLen_ = 0);
+    bool write_then_read(const uint8_t* writeBuffer_, size_t writeLen_, uint8_t* readBuffer_, size_t readLen_, bool stop_ = false);
+
+    uint8_t address() const { return _addr; };
+
+private:
+    uint8_t _addr;
+    TwoWire* _wire;
+};
+
+#endif
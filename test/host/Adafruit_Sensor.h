@@ -0,0 +1,5 @@
+// Adafruit_Sensor.h
+
+#pragma once
+
+// The unified sensor interface is not used by the firmware
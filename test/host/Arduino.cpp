@@ -0,0 +1,231 @@
+//
+//
+//
+
+#include "Arduino.h"
+
+#include <atomic>
+#include <new>
+#include <cstddef>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+/*
+ * Simulated time in us. Threads of the stress tests do not use it, the
+ * atomic only keeps a stray read from being a data race.
+ */
+static std::atomic<uint64_t> ClockMicros{ 0 };
+
+uint32_t HostClock::millis() {
+	return (uint32_t)(ClockMicros.load(std::memory_order_relaxed) / 1000);
+}
+
+uint32_t HostClock::micros() {
+	return (uint32_t)ClockMicros.load(std::memory_order_relaxed);
+}
+
+uint64_t HostClock::now() {
+	return ClockMicros.load(std::memory_order_relaxed);
+}
+
+void HostClock::set(uint32_t ms_) {
+	ClockMicros.store((uint64_t)ms_ * 1000, std::memory_order_relaxed);
+}
+
+void HostClock::advance(uint32_t ms_) {
+	ClockMicros.fetch_add((uint64_t)ms_ * 1000, std::memory_order_relaxed);
+}
+
+void HostClock::advanceMicros(uint32_t us_) {
+	ClockMicros.fetch_add(us_, std::memory_order_relaxed);
+}
+
+void String::replace(const String& find_, const String& replace_) {
+	if (find_._text.empty()) {
+		return;
+	}
+
+	size_t pos_ = 0;
+	while ((pos_ = this->_text.find(find_._text, pos_)) != std::string::npos) {
+		this->_text.replace(pos_, find_._text.length(), replace_._text);
+		pos_ += replace_._text.length();
+	}
+}
+
+size_t Print::print(const char* text_) {
+	size_t length_ = strlen(text_);
+	this->write(text_, length_);
+	return length_;
+}
+
+size_t Print::print(char c_) {
+	this->write(&c_, 1);
+	return 1;
+}
+
+size_t Print::print(int value_) {
+	return this->printf("%d", value_);
+}
+
+size_t Print::print(unsigned int value_) {
+	return this->printf("%u", value_);
+}
+
+size_t Print::print(long value_) {
+	return this->printf("%ld", value_);
+}
+
+size_t Print::print(unsigned long value_) {
+	return this->printf("%lu", value_);
+}
+
+size_t Print::print(double value_, int digits_) {
+	return this->printf("%.*f", digits_, value_);
+}
+
+size_t Print::printf(const char* format_, ...) {
+	char buffer_[256];
+	va_list args_;
+
+	va_start(args_, format_);
+	int length_ = vsnprintf(buffer_, sizeof(buffer_), format_, args_);
+	va_end(args_);
+
+	if (length_ < 0) {
+		return 0;
+	}
+	if ((size_t)length_ >= sizeof(buffer_)) {
+		length_ = sizeof(buffer_) - 1;
+	}
+	this->write(buffer_, length_);
+	return length_;
+}
+
+void HardwareSerial::write(const char* text_, size_t length_) {
+	HostLog::write(text_, length_);
+}
+
+/*
+ * The log keeps the last 64 KB, enough for the messages a test checks
+ */
+static std::string& logText() {
+	static std::string text_;
+	return text_;
+}
+
+void HostLog::write(const char* text_, size_t length_) {
+	static const bool echo_ = getenv("HOST_LOG") != nullptr;
+	std::string& log_ = logText();
+
+	if (echo_) {
+		fwrite(text_, 1, length_, stderr);
+	}
+	log_.append(text_, length_);
+	if (log_.length() > 65536) {
+		log_.erase(0, log_.length() - 65536);
+	}
+}
+
+const std::string& HostLog::text() {
+	return logText();
+}
+
+void HostLog::clear() {
+	logText().clear();
+}
+
+static std::atomic<size_t> HeapAllocations{ 0 };
+static std::atomic<size_t> HeapInUse{ 0 };
+static std::atomic<size_t> HeapPeak{ 0 };
+static std::atomic<size_t> HeapMaxInUse{ 0 };
+
+size_t HostHeap::allocations() {
+	return HeapAllocations.load(std::memory_order_relaxed);
+}
+
+size_t HostHeap::inUse() {
+	return HeapInUse.load(std::memory_order_relaxed);
+}
+
+size_t HostHeap::peak() {
+	return HeapPeak.load(std::memory_order_relaxed);
+}
+
+void HostHeap::resetPeak() {
+	HeapPeak.store(HeapInUse.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+static void raise(std::atomic<size_t>& max_, size_t value_) {
+	size_t current_ = max_.load(std::memory_order_relaxed);
+	while (value_ > current_ && !max_.compare_exchange_weak(current_, value_, std::memory_order_relaxed)) {
+	}
+}
+
+uint32_t EspClass::getFreeHeap() {
+	size_t used_ = HostHeap::inUse();
+	return used_ >= HeapSize ? 0 : (uint32_t)(HeapSize - used_);
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+	size_t used_ = HeapMaxInUse.load(std::memory_order_relaxed);
+	return used_ >= HeapSize ? 0 : (uint32_t)(HeapSize - used_);
+}
+
+void EspClass::restart() {
+	Serial.println(F("ESP.restart() ignored on the host"));
+}
+
+/*
+ * Every allocation has a header with its size, so delete can count
+ * the bytes that are freed.
+ */
+static const size_t HeapHeader = alignof(std::max_align_t);
+
+static void* countedAlloc(size_t size_) {
+	void* block_ = malloc(size_ + HeapHeader);
+	if (block_ == nullptr) {
+		throw std::bad_alloc();
+	}
+	*(size_t*)block_ = size_;
+
+	HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	size_t inUse_ = HeapInUse.fetch_add(size_, std::memory_order_relaxed) + size_;
+	raise(HeapPeak, inUse_);
+	raise(HeapMaxInUse, inUse_);
+
+	return (char*)block_ + HeapHeader;
+}
+
+static void countedFree(void* pointer_) {
+	if (pointer_ == nullptr) {
+		return;
+	}
+	void* block_ = (char*)pointer_ - HeapHeader;
+	HeapInUse.fetch_sub(*(size_t*)block_, std::memory_order_relaxed);
+	free(block_);
+}
+
+void* operator new(size_t size_) {
+	return countedAlloc(size_);
+}
+
+void* operator new[](size_t size_) {
+	return countedAlloc(size_);
+}
+
+void operator delete(void* pointer_) noexcept {
+	countedFree(pointer_);
+}
+
+void operator delete[](void* pointer_) noexcept {
+	countedFree(pointer_);
+}
+
+void operator delete(void* pointer_, size_t) noexcept {
+	countedFree(pointer_);
+}
+
+void operator delete[](void* pointer_, size_t) noexcept {
+	countedFree(pointer_);
+}
@@ -0,0 +1,154 @@
+// Arduino.h
+
+#pragma once
+
+#ifndef _HOST_ARDUINO_h
+#define _HOST_ARDUINO_h
+
+// Host stand-in for the parts of the Arduino ESP32 core that the firmware
+// uses. Time comes from HostClock, so tests and benchmarks decide how fast
+// it runs; the heap functions report what the host build allocates.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+
+#include "hostclock.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define PROGMEM
+#define IRAM_ATTR
+#define pgm_read_byte(addr_) (*(const uint8_t*)(addr_))
+
+#define HIGH 0x1
+#define LOW 0x0
+#define LED_BUILTIN 2
+
+inline unsigned long millis() { return HostClock::millis(); }
+inline unsigned long micros() { return HostClock::micros(); }
+inline void delay(uint32_t ms_) { HostClock::advance(ms_); }
+
+// The hardware random number generator, a new sequence in every process
+uint32_t esp_random();
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+class String {
+public:
+    String() {}
+    String(const char* text_) : _text(text_ == nullptr ? "" : text_) {}
+    String(const __FlashStringHelper* text_) : String(reinterpret_cast<const char*>(text_)) {}
+    String(const std::string& text_) : _text(text_) {}
+    explicit String(int value_) : _text(std::to_string(value_)) {}
+    explicit String(unsigned int value_) : _text(std::to_string(value_)) {}
+    explicit String(unsigned long value_) : _text(std::to_string(value_)) {}
+
+    String& operator+=(const String& text_) { _text += text_._text; return *this; }
+    String& operator+=(const char* text_) { _text += text_; return *this; }
+    String& operator+=(const __FlashStringHelper* text_) { _text += reinterpret_cast<const char*>(text_); return *this; }
+    String& operator+=(char c_) { _text += c_; return *this; }
+
+    friend String operator+(const String& a_, const String& b_) { return String(a_._text + b_._text); }
+    friend String operator+(const String& a_, const char* b_) { return String(a_._text + b_); }
+
+    bool operator==(const String& other_) const { return _text == other_._text; }
+    bool operator==(const char* other_) const { return _text == other_; }
+
+    void replace(const String& find_, const String& replace_);
+
+    const char* c_str() const { return _text.c_str(); }
+    unsigned int length() const { return (unsigned int)_text.length(); }
+    const std::string& str() const { return _text; }
+
+private:
+    std::string _text;
+};
+
+// Output of Serial and WebSerial goes to HostLog
+class Print {
+public:
+    virtual ~Print() {}
+
+    size_t print(const char* text_);
+    size_t print(const String& text_) { return print(text_.c_str()); }
+    size_t print(const __FlashStringHelper* text_) { return print(reinterpret_cast<const char*>(text_)); }
+    size_t print(char c_);
+    size_t print(int value_);
+    size_t print(unsigned int value_);
+    size_t print(long value_);
+    size_t print(unsigned long value_);
+    size_t print(double value_, int digits_ = 2);
+
+    template <typename T>
+    size_t println(const T& value_) { return print(value_) + println(); }
+    size_t println() { return print("\n"); }
+
+    size_t printf(const char* format_, ...) __attribute__((format(printf, 2, 3)));
+
+protected:
+    virtual void write(const char* text_, size_t length_) = 0;
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud_) { (void)baud_; }
+    int available() { return 0; }
+    int read() { return -1; }
+    operator bool() const { return true; }
+
+protected:
+    void write(const char* text_, size_t length_) override;
+};
+
+extern HardwareSerial Serial;
+
+class IPAddress {
+public:
+    IPAddress(uint8_t a_ = 0, uint8_t b_ = 0, uint8_t c_ = 0, uint8_t d_ = 0) : _bytes{ a_, b_, c_, d_ } {}
+    uint8_t operator[](int index_) const { return _bytes[index_]; }
+
+private:
+    uint8_t _bytes[4];
+};
+
+// Heap figures of the host build. Every operator new and delete is counted,
+// the free heap is a nominal ESP32 heap minus the bytes in use.
+class EspClass {
+public:
+    static const uint32_t HeapSize = 320 * 1024;
+
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap() { return getFreeHeap(); }
+    void restart();
+};
+
+extern EspClass ESP;
+
+// Messages of Serial and WebSerial, written to stderr when HOST_LOG is set
+namespace HostLog {
+    void write(const char* text_, size_t length_);
+    // Text written since the last clear(), at most the last 64 KB
+    const std::string& text();
+    void clear();
+}
+
+// Allocation counters behind EspClass, for the memory measurements
+namespace HostHeap {
+    size_t allocations();  // operator new calls since boot
+    size_t inUse();        // bytes
+    size_t peak();         // bytes in use at most since resetPeak()
+    void resetPeak();
+}
+
+#endif
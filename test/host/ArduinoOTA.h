@@ -0,0 +1,17 @@
+// ArduinoOTA.h
+
+#pragma once
+
+#ifndef _HOST_ARDUINOOTA_h
+#define _HOST_ARDUINOOTA_h
+
+class ArduinoOTAClass {
+public:
+    void setHostname(const char* hostname_) { (void)hostname_; }
+    void begin() {}
+    void handle() {}
+};
+
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif
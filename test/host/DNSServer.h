@@ -0,0 +1,13 @@
+// DNSServer.h
+
+#pragma once
+
+#ifndef _HOST_DNSSERVER_h
+#define _HOST_DNSSERVER_h
+
+class DNSServer {
+public:
+    void processNextRequest() {}
+};
+
+#endif
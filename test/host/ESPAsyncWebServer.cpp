@@ -0,0 +1,228 @@
+//
+//
+//
+
+#include "ESPAsyncWebServer.h"
+
+#include <strings.h>
+
+AsyncWebServer* AsyncWebServer::_instance = nullptr;
+
+AsyncWebServerResponse::AsyncWebServerResponse(int code_, const String& contentType_, const uint8_t* content_, size_t length_) {
+	this->_code = code_;
+	this->_contentType = contentType_;
+	this->_content = content_;
+	this->_length = length_;
+	this->_chunks = 0;
+}
+
+AsyncWebServerResponse::AsyncWebServerResponse(int code_, const String& contentType_, const String& content_) {
+	this->_code = code_;
+	this->_contentType = contentType_;
+	this->_text = content_.str();
+	this->_content = nullptr;
+	this->_length = this->_text.length();
+	this->_chunks = 0;
+}
+
+AsyncWebServerResponse::AsyncWebServerResponse(const String& contentType_, size_t length_, AwsResponseFiller filler_) {
+	this->_code = 200;
+	this->_contentType = contentType_;
+	this->_content = nullptr;
+	this->_filler = filler_;
+	this->_length = length_;
+	this->_chunks = 0;
+}
+
+const String* AsyncWebServerResponse::header(const char* name_) const {
+	for (const AsyncWebHeader& header_ : this->_headers) {
+		if (strcasecmp(header_.name().c_str(), name_) == 0) {
+			return &header_.value();
+		}
+	}
+	return nullptr;
+}
+
+/*
+ * Copies the body piece by piece into a send buffer, as the server does
+ * when the TCP window opens. A filler that returns 0 ends the body early.
+ */
+size_t AsyncWebServerResponse::drain(std::string* body_, size_t chunk_) {
+	std::vector<uint8_t> buffer_(chunk_);
+	size_t index_ = 0;
+
+	while (index_ < this->_length) {
+		size_t size_ = this->_length - index_ < chunk_ ? this->_length - index_ : chunk_;
+
+		if (this->_filler) {
+			size_ = this->_filler(buffer_.data(), size_, index_);
+			if (size_ == 0) {
+				break;
+			}
+		}
+		else if (this->_content != nullptr) {
+			memcpy(buffer_.data(), this->_content + index_, size_);
+		}
+		else {
+			memcpy(buffer_.data(), this->_text.data() + index_, size_);
+		}
+
+		if (body_ != nullptr) {
+			body_->append((const char*)buffer_.data(), size_);
+		}
+		index_ += size_;
+		this->_chunks++;
+	}
+	return index_;
+}
+
+AsyncWebServerRequest::~AsyncWebServerRequest() {
+	this->disconnect();
+}
+
+const AsyncWebHeader* AsyncWebServerRequest::getHeader(const char* name_) const {
+	for (const AsyncWebHeader& header_ : this->_headers) {
+		if (strcasecmp(header_.name().c_str(), name_) == 0) {
+			return &header_;
+		}
+	}
+	return nullptr;
+}
+
+bool AsyncWebServerRequest::hasArg(const char* name_) const {
+	for (const AsyncWebHeader& arg_ : this->_args) {
+		if (arg_.name() == name_) {
+			return true;
+		}
+	}
+	return false;
+}
+
+const String& AsyncWebServerRequest::arg(const char* name_) const {
+	static const String empty_;
+	for (const AsyncWebHeader& arg_ : this->_args) {
+		if (arg_.name() == name_) {
+			return arg_.value();
+		}
+	}
+	return empty_;
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code_, const String& contentType_, const String& content_) {
+	this->_pending.reset(new AsyncWebServerResponse(code_, contentType_, content_));
+	return this->_pending.get();
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse_P(int code_, const String& contentType_, const uint8_t* content_, size_t length_) {
+	this->_pending.reset(new AsyncWebServerResponse(code_, contentType_, content_, length_));
+	return this->_pending.get();
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(const String& contentType_, size_t length_, AwsResponseFiller filler_) {
+	this->_pending.reset(new AsyncWebServerResponse(contentType_, length_, filler_));
+	return this->_pending.get();
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response_) {
+	if (response_ == this->_pending.get()) {
+		this->_pending.release();
+	}
+	this->_response.reset(response_);
+}
+
+void AsyncWebServerRequest::send(int code_, const String& contentType_, const String& content_) {
+	this->_response.reset(new AsyncWebServerResponse(code_, contentType_, content_));
+}
+
+void AsyncWebServerRequest::disconnect() {
+	std::vector<std::function<void()>> callbacks_;
+	callbacks_.swap(this->_onDisconnect);
+	for (std::function<void()>& callback_ : callbacks_) {
+		callback_();
+	}
+}
+
+size_t AsyncEventSource::count() const {
+	size_t count_ = 0;
+	for (const Client& client_ : this->_clients) {
+		if (client_.Connected) {
+			count_++;
+		}
+	}
+	return count_;
+}
+
+/*
+ * Formats the event once in the SSE format and queues it for every client
+ */
+void AsyncEventSource::send(const char* message_, const char* event_, uint32_t id_, uint32_t reconnect_) {
+	std::string text_;
+	char number_[16];
+
+	if (reconnect_ != 0) {
+		snprintf(number_, sizeof(number_), "%lu", (unsigned long)reconnect_);
+		text_ += "retry: ";
+		text_ += number_;
+		text_ += "\r\n";
+	}
+	if (id_ != 0) {
+		snprintf(number_, sizeof(number_), "%lu", (unsigned long)id_);
+		text_ += "id: ";
+		text_ += number_;
+		text_ += "\r\n";
+	}
+	if (event_ != nullptr) {
+		text_ += "event: ";
+		text_ += event_;
+		text_ += "\r\n";
+	}
+	text_ += "data: ";
+	text_ += message_;
+	text_ += "\r\n\r\n";
+	this->_formatted++;
+
+	std::shared_ptr<const std::string> shared_ = std::make_shared<const std::string>(std::move(text_));
+	uint64_t now_ = HostClock::now();
+	for (Client& client_ : this->_clients) {
+		if (client_.Connected) {
+			client_.Received.push_back({ shared_, now_ });
+		}
+	}
+}
+
+int AsyncEventSource::connect() {
+	this->_clients.push_back({ true, {} });
+	return (int)this->_clients.size() - 1;
+}
+
+void AsyncEventSource::disconnect(int client_) {
+	this->_clients[client_].Connected = false;
+}
+
+void AsyncEventSource::clear() {
+	this->_clients.clear();
+	this->_formatted = 0;
+}
+
+AsyncWebServer::AsyncWebServer(uint16_t port_) {
+	(void)port_;
+	_instance = this;
+}
+
+void AsyncWebServer::on(const char* uri_, WebRequestMethod method_, ArRequestHandlerFunction handler_) {
+	this->_routes.push_back({ uri_, method_, handler_ });
+}
+
+bool AsyncWebServer::handle(AsyncWebServerRequest& request_) {
+	for (Route& route_ : this->_routes) {
+		if (route_.Uri == request_.url() && (route_.Method & request_.method()) != 0) {
+			route_.Handler(&request_);
+			return true;
+		}
+	}
+	if (this->_notFound) {
+		this->_notFound(&request_);
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,178 @@
+// ESPAsyncWebServer.h
+
+#pragma once
+
+#ifndef _HOST_ESPASYNCWEBSERVER_h
+#define _HOST_ESPASYNCWEBSERVER_h
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+
+// Routes, requests and responses of ESPAsyncWebServer without the network.
+// A test builds a request, lets the server dispatch it and drains the body
+// of the response in chunks as the TCP stack would.
+
+enum WebRequestMethod {
+    HTTP_GET = 0b00000001,
+    HTTP_POST = 0b00000010,
+    HTTP_ANY = 0b01111111
+};
+
+class AsyncWebHeader {
+public:
+    AsyncWebHeader(const String& name_, const String& value_) : _name(name_), _value(value_) {}
+
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+
+private:
+    String _name;
+    String _value;
+};
+
+typedef std::function<size_t(uint8_t* buffer, size_t maxLen, size_t index)> AwsResponseFiller;
+
+class AsyncWebServerResponse {
+public:
+    // Maximum segment size, the most the server asks for at a time
+    static const size_t ChunkSize = 1460;
+
+    AsyncWebServerResponse(int code_, const String& contentType_, const uint8_t* content_, size_t length_);
+    AsyncWebServerResponse(int code_, const String& contentType_, const String& content_);
+    AsyncWebServerResponse(const String& contentType_, size_t length_, AwsResponseFiller filler_);
+
+    void addHeader(const String& name_, const String& value_) { _headers.emplace_back(name_, value_); }
+
+    int code() const { return _code; }
+    const String& contentType() const { return _contentType; }
+    size_t contentLength() const { return _length; }
+    // Value of a header, nullptr without it
+    const String* header(const char* name_) const;
+
+    // Host: the body in pieces of at most chunk_ bytes, appended to body_ if given
+    size_t drain(std::string* body_ = nullptr, size_t chunk_ = ChunkSize);
+    uint32_t chunks() const { return _chunks; }
+
+private:
+    int _code;
+    String _contentType;
+    std::vector<AsyncWebHeader> _headers;
+    const uint8_t* _content;
+    std::string _text;
+    AwsResponseFiller _filler;
+    size_t _length;
+    uint32_t _chunks;
+};
+
+class AsyncWebServerRequest {
+public:
+    AsyncWebServerRequest(WebRequestMethod method_, const String& url_) : _method(method_), _url(url_) {}
+    // Disconnects
+    ~AsyncWebServerRequest();
+
+    WebRequestMethod method() const { return _method; }
+    const String& url() const { return _url; }
+
+    const AsyncWebHeader* getHeader(const char* name_) const;
+    bool hasArg(const char* name_) const;
+    const String& arg(const char* name_) const;
+    size_t args() const { return _args.size(); }
+
+    AsyncWebServerResponse* beginResponse(int code_, const String& contentType_ = String(), const String& content_ = String());
+    AsyncWebServerResponse* beginResponse_P(int code_, const String& contentType_, const uint8_t* content_, size_t length_);
+    AsyncWebServerResponse* beginResponse(const String& contentType_, size_t length_, AwsResponseFiller filler_);
+
+    void send(AsyncWebServerResponse* response_);
+    void send(int code_, const String& contentType_ = String(), const String& content_ = String());
+
+    void onDisconnect(std::function<void()> callback_) { _onDisconnect.push_back(callback_); }
+
+    // Host: request headers and form arguments
+    void addHeader(const String& name_, const String& value_) { _headers.emplace_back(name_, value_); }
+    void addArg(const String& name_, const String& value_) { _args.emplace_back(name_, value_); }
+    // The response that was sent, nullptr if none
+    AsyncWebServerResponse* response() const { return _response.get(); }
+    // The client closed the connection, runs the onDisconnect() callbacks once
+    void disconnect();
+
+private:
+    WebRequestMethod _method;
+    String _url;
+    std::vector<AsyncWebHeader> _headers;
+    std::vector<AsyncWebHeader> _args;
+    std::unique_ptr<AsyncWebServerResponse> _pending;
+    std::unique_ptr<AsyncWebServerResponse> _response;
+    std::vector<std::function<void()>> _onDisconnect;
+};
+
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+
+class AsyncWebHandler {
+public:
+    virtual ~AsyncWebHandler() {}
+};
+
+class AsyncEventSource : public AsyncWebHandler {
+public:
+    // One event as a client got it: formatted once and shared by all clients
+    struct Event {
+        std::shared_ptr<const std::string> Text;
+        uint64_t Time; // us when it was queued for the client
+    };
+
+    explicit AsyncEventSource(const String& url_) : _url(url_) {}
+
+    size_t count() const;
+    void send(const char* message_, const char* event_ = nullptr, uint32_t id_ = 0, uint32_t reconnect_ = 0);
+
+    // Host: clients come and go, the events they got are kept
+    int connect();
+    void disconnect(int client_);
+    const std::vector<Event>& received(int client_) const { return _clients[client_].Received; }
+    void clear();
+    uint32_t formatted() const { return _formatted; }
+
+private:
+    struct Client {
+        bool Connected;
+        std::vector<Event> Received;
+    };
+
+    String _url;
+    std::vector<Client> _clients;
+    uint32_t _formatted = 0;
+};
+
+class AsyncWebServer {
+public:
+    explicit AsyncWebServer(uint16_t port_);
+
+    void on(const char* uri_, WebRequestMethod method_, ArRequestHandlerFunction handler_);
+    void addHandler(AsyncWebHandler* handler_) { (void)handler_; }
+    void onNotFound(ArRequestHandlerFunction handler_) { _notFound = handler_; }
+    void begin() {}
+
+    // Host: runs the handler of the route, false if not even onNotFound() took it
+    bool handle(AsyncWebServerRequest& request_);
+
+    // The last server that was constructed, the one of the firmware
+    static AsyncWebServer* instance() { return _instance; }
+
+private:
+    struct Route {
+        String Uri;
+        WebRequestMethod Method;
+        ArRequestHandlerFunction Handler;
+    };
+
+    std::vector<Route> _routes;
+    ArRequestHandlerFunction _notFound;
+    static AsyncWebServer* _instance;
+};
+
+#endif
@@ -0,0 +1,201 @@
+//
+//
+//
+
+#include "IotWebConfAsync.h"
+
+using namespace iotwebconf;
+
+static std::string FlashConfig;
+static uint32_t FlashErases = 0;
+static uint32_t FlashWrites = 0;
+static size_t FlashBytes = 0;
+
+uint32_t HostFlash::erases() {
+	return FlashErases;
+}
+
+uint32_t HostFlash::writes() {
+	return FlashWrites;
+}
+
+size_t HostFlash::bytesWritten() {
+	return FlashBytes;
+}
+
+void HostFlash::resetCounters() {
+	FlashErases = 0;
+	FlashWrites = 0;
+	FlashBytes = 0;
+}
+
+void HostFlash::clear() {
+	FlashConfig.clear();
+}
+
+Parameter::Parameter(const char* label_, const char* id_, char* valueBuffer_, int length_, const char* defaultValue_) : ConfigItem(id_) {
+	this->label = label_;
+	this->_valueBuffer = valueBuffer_;
+	this->_length = length_;
+	this->_defaultValue = defaultValue_;
+}
+
+void Parameter::applyDefaultValue() {
+	if (this->_defaultValue != nullptr) {
+		strncpy(this->_valueBuffer, this->_defaultValue, this->_length);
+	}
+	else {
+		this->_valueBuffer[0] = '\0';
+	}
+}
+
+void Parameter::loadValue(const char*& blob_) {
+	memcpy(this->_valueBuffer, blob_, this->_length);
+	blob_ += this->_length;
+}
+
+/*
+ * As String::toCharArray(): at most length - 1 characters and the terminator
+ */
+void Parameter::update(const AsyncWebServerRequest& request_) {
+	if (!request_.hasArg(this->getId())) {
+		return;
+	}
+	snprintf(this->_valueBuffer, this->_length, "%s", request_.arg(this->getId()).c_str());
+}
+
+void CheckboxParameter::update(const AsyncWebServerRequest& request_) {
+	if (request_.hasArg(this->getId())) {
+		strncpy(this->_valueBuffer, "selected", this->_length);
+	}
+	else {
+		this->_valueBuffer[0] = '\0';
+	}
+}
+
+void ParameterGroup::applyDefaultValue() {
+	for (ConfigItem* item_ : this->_items) {
+		item_->applyDefaultValue();
+	}
+}
+
+size_t ParameterGroup::getStorageSize() const {
+	size_t size_ = 0;
+	for (const ConfigItem* item_ : this->_items) {
+		size_ += item_->getStorageSize();
+	}
+	return size_;
+}
+
+void ParameterGroup::storeValue(std::string& blob_) const {
+	for (const ConfigItem* item_ : this->_items) {
+		item_->storeValue(blob_);
+	}
+}
+
+void ParameterGroup::loadValue(const char*& blob_) {
+	for (ConfigItem* item_ : this->_items) {
+		item_->loadValue(blob_);
+	}
+}
+
+void ParameterGroup::update(const AsyncWebServerRequest& request_) {
+	for (ConfigItem* item_ : this->_items) {
+		item_->update(request_);
+	}
+}
+
+AsyncIotWebConf::AsyncIotWebConf(const char* thingName_, DNSServer* dnsServer_, AsyncWebServerWrapper* server_, const char* initialApPassword_, const char* configVersion_) :
+	_system("iwcSys", "System configuration"),
+	_thingNameParameter("Thing name", "iwcThingName", _thingName, sizeof(_thingName), thingName_),
+	_apPasswordParameter("AP password", "iwcApPassword", _apPassword, sizeof(_apPassword), initialApPassword_),
+	_wifiSsidParameter("WiFi SSID", "iwcWifiSsid", _wifiSsid, sizeof(_wifiSsid)),
+	_wifiPasswordParameter("WiFi password", "iwcWifiPassword", _wifiPassword, sizeof(_wifiPassword)),
+	_apTimeoutParameter("Startup delay (seconds)", "iwcApTimeout", _apTimeout, sizeof(_apTimeout), "30") {
+	(void)dnsServer_;
+	(void)server_;
+
+	this->_configVersion = configVersion_;
+	this->_formatProvider = nullptr;
+
+	this->_system.addItem(&this->_thingNameParameter);
+	this->_system.addItem(&this->_apPasswordParameter);
+	this->_system.addItem(&this->_wifiSsidParameter);
+	this->_system.addItem(&this->_wifiPasswordParameter);
+	this->_system.addItem(&this->_apTimeoutParameter);
+	this->_apTimeoutParameter.visible = false;
+}
+
+void AsyncIotWebConf::setupUpdateServer(std::function<void(const char*)> setup_, std::function<void(const char*, char*)> credentials_) {
+	setup_("/firmware");
+	credentials_("admin", this->_apPassword);
+}
+
+std::vector<ConfigItem*> AsyncIotWebConf::allItems() {
+	std::vector<ConfigItem*> items_;
+	items_.push_back(&this->_system);
+	for (ParameterGroup* group_ : this->_groups) {
+		items_.push_back(group_);
+	}
+	for (ConfigItem* item_ : this->_hidden) {
+		items_.push_back(item_);
+	}
+	return items_;
+}
+
+bool AsyncIotWebConf::init() {
+	std::vector<ConfigItem*> items_ = this->allItems();
+	size_t size_ = strlen(this->_configVersion);
+
+	for (ConfigItem* item_ : items_) {
+		size_ += item_->getStorageSize();
+	}
+
+	if (FlashConfig.size() != size_ || FlashConfig.compare(0, strlen(this->_configVersion), this->_configVersion) != 0) {
+		for (ConfigItem* item_ : items_) {
+			item_->applyDefaultValue();
+		}
+		return false;
+	}
+
+	const char* blob_ = FlashConfig.data() + strlen(this->_configVersion);
+	for (ConfigItem* item_ : items_) {
+		item_->loadValue(blob_);
+	}
+	return true;
+}
+
+void AsyncIotWebConf::saveConfig() {
+	std::string blob_ = this->_configVersion;
+	for (ConfigItem* item_ : this->allItems()) {
+		item_->storeValue(blob_);
+	}
+
+	FlashConfig = blob_;
+	FlashErases++;
+	FlashWrites++;
+	FlashBytes += blob_.size();
+}
+
+void AsyncIotWebConf::handleConfig(AsyncWebRequestWrapper* request_) {
+	AsyncWebServerRequest* request = request_->request();
+
+	if (request->args() == 0) {
+		String page_ = F("<html><body><form method='post'>");
+		if (this->_formatProvider != nullptr) {
+			page_ += this->_formatProvider->getFormEnd();
+		}
+		page_ += F("</body></html>");
+		request->send(200, "text/html", page_);
+		return;
+	}
+
+	for (ConfigItem* item_ : this->allItems()) {
+		item_->update(*request);
+	}
+	this->saveConfig();
+	if (this->_configSaved) {
+		this->_configSaved();
+	}
+	request->send(200, "text/html", F("<html><body>Configuration saved.</body></html>"));
+}
@@ -0,0 +1,228 @@
+// IotWebConfAsync.h
+
+#pragma once
+
+#ifndef _HOST_IOTWEBCONFASYNC_h
+#define _HOST_IOTWEBCONFASYNC_h
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+#include "ESPAsyncWebServer.h"
+#include "DNSServer.h"
+#include "WiFi.h"
+
+// The parameters of IotWebConf and a configuration store on a simulated
+// flash. Values are kept in their char buffers with the length the firmware
+// gives, as in the library: a form value is cut to length - 1 characters,
+// a default is copied with strncpy.
+
+class AsyncIotWebConf;
+
+namespace iotwebconf {
+
+class ConfigItem {
+public:
+    ConfigItem(const char* id_) : _id(id_) {}
+    virtual ~ConfigItem() {}
+
+    const char* getId() const { return _id; }
+
+    virtual void applyDefaultValue() = 0;
+    // Bytes in the stored configuration
+    virtual size_t getStorageSize() const = 0;
+    virtual void storeValue(std::string& blob_) const = 0;
+    virtual void loadValue(const char*& blob_) = 0;
+    // Takes the value of a submitted form
+    virtual void update(const AsyncWebServerRequest& request_) = 0;
+
+    bool visible = true;
+
+protected:
+    const char* _id;
+};
+
+class Parameter : public ConfigItem {
+public:
+    Parameter(const char* label_, const char* id_, char* valueBuffer_, int length_, const char* defaultValue_);
+
+    void applyDefaultValue() override;
+    size_t getStorageSize() const override { return _length; }
+    void storeValue(std::string& blob_) const override { blob_.append(_valueBuffer, _length); }
+    void loadValue(const char*& blob_) override;
+    void update(const AsyncWebServerRequest& request_) override;
+
+    const char* label;
+    char* valueBuffer() const { return _valueBuffer; }
+    int getLength() const { return _length; }
+
+protected:
+    char* _valueBuffer;
+    int _length;
+    const char* _defaultValue;
+};
+
+class TextParameter : public Parameter {
+public:
+    TextParameter(const char* label_, const char* id_, char* valueBuffer_, int length_, const char* defaultValue_ = nullptr,
+        const char* placeholder_ = nullptr, const char* customHtml_ = nullptr)
+        : Parameter(label_, id_, valueBuffer_, length_, defaultValue_), placeholder(placeholder_), customHtml(customHtml_) {}
+
+    const char* placeholder;
+    const char* customHtml;
+};
+
+class NumberParameter : public TextParameter {
+public:
+    NumberParameter(const char* label_, const char* id_, char* valueBuffer_, int length_, const char* defaultValue_ = nullptr,
+        const char* placeholder_ = nullptr, const char* customHtml_ = nullptr)
+        : TextParameter(label_, id_, valueBuffer_, length_, defaultValue_, placeholder_, customHtml_) {}
+};
+
+class PasswordParameter : public TextParameter {
+public:
+    using TextParameter::TextParameter;
+};
+
+class CheckboxParameter : public TextParameter {
+public:
+    CheckboxParameter(const char* label_, const char* id_, char* valueBuffer_, int length_, bool defaultValue_ = false)
+        : TextParameter(label_, id_, valueBuffer_, length_, defaultValue_ ? "selected" : nullptr) {}
+
+    bool isChecked() const { return strncmp(_valueBuffer, "selected", _length) == 0; }
+    void update(const AsyncWebServerRequest& request_) override;
+};
+
+class SelectParameter : public TextParameter {
+public:
+    SelectParameter(const char* label_, const char* id_, char* valueBuffer_, int length_, const char* optionValues_,
+        const char* optionNames_, size_t optionCount_, size_t nameLength_, const char* defaultValue_ = nullptr)
+        : TextParameter(label_, id_, valueBuffer_, length_, defaultValue_),
+        _optionValues(optionValues_), _optionNames(optionNames_), _optionCount(optionCount_), _nameLength(nameLength_) {}
+
+private:
+    const char* _optionValues;
+    const char* _optionNames;
+    size_t _optionCount;
+    size_t _nameLength;
+};
+
+class ParameterGroup : public ConfigItem {
+public:
+    ParameterGroup(const char* id_, const char* label_ = nullptr) : ConfigItem(id_), label(label_) {}
+
+    void addItem(ConfigItem* item_) { _items.push_back(item_); }
+
+    void applyDefaultValue() override;
+    size_t getStorageSize() const override;
+    void storeValue(std::string& blob_) const override;
+    void loadValue(const char*& blob_) override;
+    void update(const AsyncWebServerRequest& request_) override;
+
+    const char* label;
+
+private:
+    std::vector<ConfigItem*> _items;
+};
+
+class HtmlFormatProvider {
+public:
+    virtual ~HtmlFormatProvider() {}
+
+protected:
+    virtual String getFormEnd() { return String(F("<button type='submit'>Apply</button></form>")); }
+
+    friend class ::AsyncIotWebConf;
+};
+
+} // namespace iotwebconf
+
+class AsyncWebServerWrapper {
+public:
+    AsyncWebServerWrapper(AsyncWebServer* server_) : _server(server_) {}
+
+private:
+    AsyncWebServer* _server;
+};
+
+class AsyncWebRequestWrapper {
+public:
+    AsyncWebRequestWrapper(AsyncWebServerRequest* request_) : _request(request_) {}
+
+    AsyncWebServerRequest* request() const { return _request; }
+
+private:
+    AsyncWebServerRequest* _request;
+};
+
+// The flash sector of the configuration. Every commit erases the sector
+// and writes the whole configuration, as EEPROM.commit() does on the ESP32.
+namespace HostFlash {
+    uint32_t erases();
+    uint32_t writes();
+    size_t bytesWritten();
+    void resetCounters();
+    // Forgets the stored configuration, the next init() applies the defaults
+    void clear();
+}
+
+class AsyncIotWebConf {
+public:
+    AsyncIotWebConf(const char* thingName_, DNSServer* dnsServer_, AsyncWebServerWrapper* server_, const char* initialApPassword_, const char* configVersion_);
+
+    void setStatusPin(int pin_, int onLevel_ = LOW) { (void)pin_; (void)onLevel_; }
+    void setConfigPin(int pin_) { (void)pin_; }
+    void setHtmlFormatProvider(iotwebconf::HtmlFormatProvider* provider_) { _formatProvider = provider_; }
+
+    void addParameterGroup(iotwebconf::ParameterGroup* group_) { _groups.push_back(group_); }
+    void addSystemParameter(iotwebconf::ConfigItem* item_) { _system.addItem(item_); }
+    void addHiddenParameter(iotwebconf::ConfigItem* item_) { _hidden.push_back(item_); }
+
+    void setupUpdateServer(std::function<void(const char*)> setup_, std::function<void(const char*, char*)> credentials_);
+    void setConfigSavedCallback(std::function<void()> callback_) { _configSaved = callback_; }
+    void setWifiConnectionCallback(std::function<void()> callback_) { _wifiConnected = callback_; }
+
+    iotwebconf::NumberParameter* getApTimeoutParameter() { return &_apTimeoutParameter; }
+
+    // Loads the stored configuration, or applies the defaults if there is
+    // none of this configuration version
+    bool init();
+    void doLoop() {}
+    void saveConfig();
+    void goOffLine() {}
+    char* getThingName() { return _thingName; }
+
+    // A request with arguments is a submitted form: all values are updated,
+    // saved and the callback is called
+    void handleConfig(AsyncWebRequestWrapper* request_);
+    void handleNotFound(AsyncWebRequestWrapper* request_) { request_->request()->send(404, "text/plain", "Not found"); }
+    bool handleCaptivePortal(AsyncWebRequestWrapper* request_) { (void)request_; return false; }
+
+private:
+    std::vector<iotwebconf::ConfigItem*> allItems();
+
+    char _thingName[33];
+    char _apPassword[33];
+    char _wifiSsid[33];
+    char _wifiPassword[65];
+    char _apTimeout[5];
+
+    iotwebconf::ParameterGroup _system;
+    iotwebconf::TextParameter _thingNameParameter;
+    iotwebconf::PasswordParameter _apPasswordParameter;
+    iotwebconf::TextParameter _wifiSsidParameter;
+    iotwebconf::PasswordParameter _wifiPasswordParameter;
+    iotwebconf::NumberParameter _apTimeoutParameter;
+
+    const char* _configVersion;
+    std::vector<iotwebconf::ParameterGroup*> _groups;
+    std::vector<iotwebconf::ConfigItem*> _hidden;
+    iotwebconf::HtmlFormatProvider* _formatProvider;
+    std::function<void()> _configSaved;
+    std::function<void()> _wifiConnected;
+};
+
+#endif
@@ -0,0 +1,18 @@
+// IotWebConfAsyncUpdateServer.h
+
+#pragma once
+
+#ifndef _HOST_IOTWEBCONFASYNCUPDATESERVER_h
+#define _HOST_IOTWEBCONFASYNCUPDATESERVER_h
+
+#include "ESPAsyncWebServer.h"
+
+// Firmware updates are not simulated, an update never finishes
+class AsyncUpdateServer {
+public:
+    void setup(AsyncWebServer* server_, const char* path_) { (void)server_; (void)path_; }
+    void updateCredentials(const char* userName_, const char* password_) { (void)userName_; (void)password_; }
+    bool isFinished() const { return false; }
+};
+
+#endif
@@ -0,0 +1,10 @@
+// IotWebConfOptionalGroup.h
+
+#pragma once
+
+#ifndef _HOST_IOTWEBCONFOPTIONALGROUP_h
+#define _HOST_IOTWEBCONFOPTIONALGROUP_h
+
+#include "IotWebConfAsync.h"
+
+#endif
@@ -0,0 +1,142 @@
+//
+//
+//
+
+#include "IotWebRoot.h"
+
+String HtmlRootFormatProvider::getHtmlHead(const String& title_) {
+	String s_ = F("<!DOCTYPE html><html lang=\"en\"><head><meta charset=\"UTF-8\">\n");
+	s_ += F("<meta name=\"viewport\" content=\"width=device-width, initial-scale=1, user-scalable=no\"/>\n");
+	s_ += F("<title>");
+	s_ += title_;
+	s_ += F("</title>\n");
+	return s_;
+}
+
+String HtmlRootFormatProvider::getHtmlStyle() {
+	return String(F("<style>\n")) + this->getStyleInner() + String(F("</style>\n"));
+}
+
+String HtmlRootFormatProvider::getStyleInner() {
+	String s_;
+	s_ += F("body { background-color: #f2f2f2; color: #222; font-family: verdana, arial, helvetica, sans-serif; font-size: 0.95em; margin: 0; }\n");
+	s_ += F("div, fieldset, input, select { padding: 5px; font-size: 1em; }\n");
+	s_ += F("fieldset { background: #ffffff; border: 1px solid #cccccc; border-radius: 0.3rem; margin: 0.5em 0; }\n");
+	s_ += F("legend { font-weight: bold; padding: 0 0.3em; }\n");
+	s_ += F("p { margin: 0.5em 0; }\n");
+	s_ += F("input { width: 100%; box-sizing: border-box; -webkit-box-sizing: border-box; -moz-box-sizing: border-box; background: #ffffff; color: #000000; }\n");
+	s_ += F("input[type=checkbox], input[type=radio] { width: 1em; margin-right: 6px; vertical-align: -1px; }\n");
+	s_ += F("input[type=range] { width: 99%; }\n");
+	s_ += F("select { width: 100%; background: #ffffff; color: #000000; }\n");
+	s_ += F("textarea { resize: vertical; width: 98%; height: 318px; padding: 5px; overflow: auto; background: #ffffff; color: #000000; }\n");
+	s_ += F("button { border: 0; border-radius: 0.3rem; background: #1fa3ec; color: #ffffff; line-height: 2.4rem; font-size: 1.2rem; width: 100%; -webkit-transition-duration: 0.4s; transition-duration: 0.4s; cursor: pointer; }\n");
+	s_ += F("button:hover { background: #0e70a4; }\n");
+	s_ += F(".bred { background: #d43535; }\n");
+	s_ += F(".bred:hover { background: #931f1f; }\n");
+	s_ += F(".bgrn { background: #47c266; }\n");
+	s_ += F(".bgrn:hover { background: #5aaf6f; }\n");
+	s_ += F("a { color: #1fa3ec; text-decoration: none; }\n");
+	s_ += F("a:hover { text-decoration: underline; }\n");
+	s_ += F(".p { float: left; text-align: left; }\n");
+	s_ += F(".q { float: right; text-align: right; }\n");
+	s_ += F("table { width: 100%; border-collapse: collapse; }\n");
+	s_ += F("td { padding: 2px 4px; vertical-align: top; }\n");
+	s_ += F("td:first-child { white-space: nowrap; }\n");
+	s_ += F("td:last-child { text-align: right; }\n");
+	s_ += F(".hdr { text-align: center; font-size: 1.3em; font-weight: bold; padding: 0.4em 0; }\n");
+	s_ += F(".ver { text-align: right; font-size: 0.8em; color: #aaaaaa; }\n");
+	s_ += F(".de { background-color: #ffaaaa; }\n");
+	s_ += F(".em { border: 1px solid #77aaff; background-color: #ffffff; padding: 5px; margin: 5px; }\n");
+	s_ += F(".c { text-align: center; }\n");
+	s_ += F(".wrap { text-align: left; display: inline-block; min-width: 260px; max-width: 500px; }\n");
+	s_ += F("canvas { width: 100%; border: 1px solid #cccccc; background: #fafafa; }\n");
+	s_ += F("@media (prefers-color-scheme: dark) {\n");
+	s_ += F("  body { background-color: #252525; color: #eaeaea; }\n");
+	s_ += F("  fieldset { background: #303030; border-color: #555555; }\n");
+	s_ += F("  input, select, textarea { background: #dddddd; }\n");
+	s_ += F("  canvas { background: #303030; border-color: #555555; }\n");
+	s_ += F("}\n");
+	return s_;
+}
+
+String HtmlRootFormatProvider::getHtmlHeadEnd() {
+	return String(F("</head><body>\n<div class=\"wrap\">\n"));
+}
+
+String HtmlRootFormatProvider::getHtmlScript() {
+	return String(F("<script>\n")) + this->getScriptInner() + String(F("</script>\n"));
+}
+
+String HtmlRootFormatProvider::getScriptInner() {
+	String s_;
+	s_ += F("function requestData() {\n");
+	s_ += F("   var xhttp = new XMLHttpRequest();\n");
+	s_ += F("   xhttp.onreadystatechange = function() {\n");
+	s_ += F("      if (this.readyState == 4 && this.status == 200) {\n");
+	s_ += F("         updateData(JSON.parse(this.responseText));\n");
+	s_ += F("      }\n");
+	s_ += F("   };\n");
+	s_ += F("   xhttp.open('GET', 'data', true);\n");
+	s_ += F("   xhttp.send();\n");
+	s_ += F("}\n");
+	s_ += F("requestData();\n");
+	s_ += F("setInterval(requestData, {millisecond});\n");
+	return s_;
+}
+
+String HtmlRootFormatProvider::getHtmlTable() {
+	return String(F("<table border=\"0\" align=\"center\">\n"));
+}
+
+String HtmlRootFormatProvider::getHtmlTableEnd() {
+	return String(F("</table>\n"));
+}
+
+String HtmlRootFormatProvider::getHtmlTableRow() {
+	return String(F("<tr>\n"));
+}
+
+String HtmlRootFormatProvider::getHtmlTableRowEnd() {
+	return String(F("</tr>\n"));
+}
+
+String HtmlRootFormatProvider::getHtmlTableCol() {
+	return String(F("<td>\n"));
+}
+
+String HtmlRootFormatProvider::getHtmlTableColEnd() {
+	return String(F("</td>\n"));
+}
+
+String HtmlRootFormatProvider::getHtmlFieldset(const String& legend_) {
+	return String(F("<fieldset align=left style=\"border: 1px solid\">\n<legend>")) + legend_ + String(F("</legend>\n"));
+}
+
+String HtmlRootFormatProvider::getHtmlFieldsetEnd() {
+	return String(F("</fieldset>\n"));
+}
+
+String HtmlRootFormatProvider::getHtmlTableRowSpan(const String& label_, const String& value_, const String& id_) {
+	return String(F("<tr><td align=\"left\">")) + label_ + String(F("</td><td align=\"right\"><span id=\"")) + id_ +
+		String(F("\">")) + value_ + String(F("</span></td></tr>\n"));
+}
+
+String HtmlRootFormatProvider::getHtmlTableRowText(const String& text_) {
+	return String(F("<tr><td align=\"left\">")) + text_ + String(F("</td></tr>\n"));
+}
+
+String HtmlRootFormatProvider::getHtmlVersion(const String& version_) {
+	return String(F("<div class=\"ver\">Version: ")) + version_ + String(F("</div>"));
+}
+
+String HtmlRootFormatProvider::addNewLine(uint8_t count_) {
+	String s_;
+	for (uint8_t i = 0; i < count_; i++) {
+		s_ += F("<br>\n");
+	}
+	return s_;
+}
+
+String HtmlRootFormatProvider::getHtmlEnd() {
+	return String(F("</div>\n</body>\n</html>\n"));
+}
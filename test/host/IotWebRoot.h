@@ -0,0 +1,39 @@
+// IotWebRoot.h
+
+#pragma once
+
+#ifndef _HOST_IOTWEBROOT_h
+#define _HOST_IOTWEBROOT_h
+
+#include "Arduino.h"
+
+// HTML pieces of the root page. The texts follow the library, so the page
+// has about the size it has on the device.
+class HtmlRootFormatProvider {
+public:
+    virtual ~HtmlRootFormatProvider() {}
+
+    String getHtmlHead(const String& title_);
+    String getHtmlStyle();
+    String getHtmlHeadEnd();
+    String getHtmlScript();
+    String getHtmlTable();
+    String getHtmlTableEnd();
+    String getHtmlTableRow();
+    String getHtmlTableRowEnd();
+    String getHtmlTableCol();
+    String getHtmlTableColEnd();
+    String getHtmlFieldset(const String& legend_);
+    String getHtmlFieldsetEnd();
+    String getHtmlTableRowSpan(const String& label_, const String& value_, const String& id_);
+    String getHtmlTableRowText(const String& text_);
+    String getHtmlVersion(const String& version_);
+    String addNewLine(uint8_t count_);
+    String getHtmlEnd();
+
+protected:
+    virtual String getScriptInner();
+    virtual String getStyleInner();
+};
+
+#endif
@@ -0,0 +1,51 @@
+//
+//
+//
+
+#include "N2kMessages.h"
+
+void SetN2kPGN130312(tN2kMsg& N2kMsg, unsigned char SID, unsigned char TempInstance, tN2kTempSource TempSource,
+	double ActualTemperature, double SetTemperature) {
+	N2kMsg.SetPGN(130312L);
+	N2kMsg.Priority = 5;
+	N2kMsg.AddByte(SID);
+	N2kMsg.AddByte((unsigned char)TempInstance);
+	N2kMsg.AddByte((unsigned char)TempSource);
+	N2kMsg.Add2ByteUDouble(ActualTemperature, 0.01);
+	N2kMsg.Add2ByteUDouble(SetTemperature, 0.01);
+	N2kMsg.AddByte(0xff); // Reserved
+}
+
+void SetN2kPGN130313(tN2kMsg& N2kMsg, unsigned char SID, unsigned char HumidityInstance, tN2kHumiditySource HumiditySource,
+	double ActualHumidity, double SetHumidity) {
+	N2kMsg.SetPGN(130313L);
+	N2kMsg.Priority = 5;
+	N2kMsg.AddByte(SID);
+	N2kMsg.AddByte((unsigned char)HumidityInstance);
+	N2kMsg.AddByte((unsigned char)HumiditySource);
+	N2kMsg.Add2ByteDouble(ActualHumidity, 0.004);
+	N2kMsg.Add2ByteDouble(SetHumidity, 0.004);
+	N2kMsg.AddByte(0xff); // Reserved
+}
+
+void SetN2kPGN130314(tN2kMsg& N2kMsg, unsigned char SID, unsigned char PressureInstance, tN2kPressureSource PressureSource,
+	double Pressure) {
+	N2kMsg.SetPGN(130314L);
+	N2kMsg.Priority = 5;
+	N2kMsg.AddByte(SID);
+	N2kMsg.AddByte((unsigned char)PressureInstance);
+	N2kMsg.AddByte((unsigned char)PressureSource);
+	N2kMsg.Add4ByteDouble(Pressure, 0.1);
+	N2kMsg.AddByte(0xff); // Reserved
+}
+
+void SetN2kPGN130316(tN2kMsg& N2kMsg, unsigned char SID, unsigned char TempInstance, tN2kTempSource TempSource,
+	double ActualTemperature, double SetTemperature) {
+	N2kMsg.SetPGN(130316L);
+	N2kMsg.Priority = 5;
+	N2kMsg.AddByte(SID);
+	N2kMsg.AddByte((unsigned char)TempInstance);
+	N2kMsg.AddByte((unsigned char)TempSource);
+	N2kMsg.Add3ByteUDouble(ActualTemperature, 0.001);
+	N2kMsg.Add2ByteUDouble(SetTemperature, 0.1);
+}
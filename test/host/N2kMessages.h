@@ -0,0 +1,34 @@
+// N2kMessages.h
+
+#pragma once
+
+#ifndef _HOST_N2KMESSAGES_h
+#define _HOST_N2KMESSAGES_h
+
+#include "N2kMsg.h"
+#include "N2kTypes.h"
+
+// Message encoders of the NMEA2000 library that the firmware uses
+
+inline double CToKelvin(double v_) { return v_ + 273.15; }
+inline double KelvinToC(double v_) { return v_ - 273.15; }
+inline double mBarToPascal(double v_) { return v_ * 100; }
+inline double PascalTomBar(double v_) { return v_ / 100; }
+
+// Temperature, 0.01 K
+void SetN2kPGN130312(tN2kMsg& N2kMsg, unsigned char SID, unsigned char TempInstance, tN2kTempSource TempSource,
+    double ActualTemperature, double SetTemperature = N2kDoubleNA);
+
+// Humidity, 0.004 %
+void SetN2kPGN130313(tN2kMsg& N2kMsg, unsigned char SID, unsigned char HumidityInstance, tN2kHumiditySource HumiditySource,
+    double ActualHumidity, double SetHumidity = N2kDoubleNA);
+
+// Pressure, 0.1 Pa
+void SetN2kPGN130314(tN2kMsg& N2kMsg, unsigned char SID, unsigned char PressureInstance, tN2kPressureSource PressureSource,
+    double Pressure);
+
+// Temperature extended range, 0.001 K
+void SetN2kPGN130316(tN2kMsg& N2kMsg, unsigned char SID, unsigned char TempInstance, tN2kTempSource TempSource,
+    double ActualTemperature, double SetTemperature = N2kDoubleNA);
+
+#endif
@@ -0,0 +1,148 @@
+//
+//
+//
+
+#include "N2kMsg.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "Arduino.h"
+
+tN2kMsg::tN2kMsg(unsigned char source_, unsigned char priority_, unsigned long pgn_, int dataLen_) {
+	this->Clear();
+	this->Source = source_;
+	this->Priority = priority_;
+	this->PGN = pgn_;
+	this->DataLen = dataLen_;
+	this->MsgTime = 0;
+}
+
+void tN2kMsg::SetPGN(unsigned long pgn_) {
+	this->Clear();
+	this->PGN = pgn_;
+	this->MsgTime = millis();
+}
+
+void tN2kMsg::Clear() {
+	this->PGN = 0;
+	this->DataLen = 0;
+	this->MsgTime = 0;
+	this->Destination = 0xff;
+}
+
+void tN2kMsg::AddByte(unsigned char v_) {
+	if (this->DataLen < MaxDataLen) {
+		this->Data[this->DataLen++] = v_;
+	}
+}
+
+void tN2kMsg::Add2ByteUInt(uint16_t v_) {
+	this->AddByte(v_ & 0xff);
+	this->AddByte(v_ >> 8);
+}
+
+void tN2kMsg::Add4ByteUInt(uint32_t v_) {
+	this->Add2ByteUInt(v_ & 0xffff);
+	this->Add2ByteUInt(v_ >> 16);
+}
+
+void tN2kMsg::AddUInt64(uint64_t v_) {
+	this->Add4ByteUInt(v_ & 0xffffffff);
+	this->Add4ByteUInt(v_ >> 32);
+}
+
+void tN2kMsg::Add2ByteUDouble(double v_, double precision_, double undefVal_) {
+	if (v_ == undefVal_) {
+		this->Add2ByteUInt(N2kUInt16NA);
+		return;
+	}
+	double vd_ = round(v_ / precision_);
+	uint16_t vi_ = (vd_ >= 0 && vd_ < 0xfffe) ? (uint16_t)vd_ : 0xfffe;
+	this->Add2ByteUInt(vi_);
+}
+
+void tN2kMsg::Add2ByteDouble(double v_, double precision_, double undefVal_) {
+	if (v_ == undefVal_) {
+		this->Add2ByteUInt((uint16_t)N2kInt16NA);
+		return;
+	}
+	double vd_ = round(v_ / precision_);
+	int16_t vi_ = (vd_ >= INT16_MIN && vd_ < 0x7ffe) ? (int16_t)vd_ : 0x7ffe;
+	this->Add2ByteUInt((uint16_t)vi_);
+}
+
+void tN2kMsg::Add3ByteUDouble(double v_, double precision_, double undefVal_) {
+	uint32_t vi_ = N2kUInt24NA;
+	if (v_ != undefVal_) {
+		double vd_ = round(v_ / precision_);
+		vi_ = (vd_ >= 0 && vd_ < 0xfffffe) ? (uint32_t)vd_ : 0xfffffe;
+	}
+	this->AddByte(vi_ & 0xff);
+	this->AddByte((vi_ >> 8) & 0xff);
+	this->AddByte((vi_ >> 16) & 0xff);
+}
+
+void tN2kMsg::Add4ByteDouble(double v_, double precision_, double undefVal_) {
+	if (v_ == undefVal_) {
+		this->Add4ByteUInt((uint32_t)N2kInt32NA);
+		return;
+	}
+	double vd_ = round(v_ / precision_);
+	int32_t vi_ = (vd_ >= INT32_MIN && vd_ < 0x7ffffffe) ? (int32_t)vd_ : 0x7ffffffe;
+	this->Add4ByteUInt((uint32_t)vi_);
+}
+
+unsigned char tN2kMsg::GetByte(int& index_) const {
+	return index_ < this->DataLen ? this->Data[index_++] : 0xff;
+}
+
+uint16_t tN2kMsg::Get2ByteUInt(int& index_, uint16_t def_) const {
+	if (index_ + 2 > this->DataLen) {
+		return def_;
+	}
+	uint16_t v_ = this->Data[index_] | (this->Data[index_ + 1] << 8);
+	index_ += 2;
+	return v_;
+}
+
+uint64_t tN2kMsg::GetUInt64(int& index_, uint64_t def_) const {
+	if (index_ + 8 > this->DataLen) {
+		return def_;
+	}
+	uint64_t v_ = 0;
+	for (int i = 7; i >= 0; i--) {
+		v_ = (v_ << 8) | this->Data[index_ + i];
+	}
+	index_ += 8;
+	return v_;
+}
+
+double tN2kMsg::Get2ByteUDouble(double precision_, int& index_, double def_) const {
+	uint16_t v_ = this->Get2ByteUInt(index_);
+	return v_ == N2kUInt16NA ? def_ : v_ * precision_;
+}
+
+double tN2kMsg::Get2ByteDouble(double precision_, int& index_, double def_) const {
+	int16_t v_ = (int16_t)this->Get2ByteUInt(index_);
+	return v_ == N2kInt16NA ? def_ : v_ * precision_;
+}
+
+double tN2kMsg::Get3ByteUDouble(double precision_, int& index_, double def_) const {
+	if (index_ + 3 > this->DataLen) {
+		return def_;
+	}
+	uint32_t v_ = this->Data[index_] | (this->Data[index_ + 1] << 8) | ((uint32_t)this->Data[index_ + 2] << 16);
+	index_ += 3;
+	return v_ == N2kUInt24NA ? def_ : v_ * precision_;
+}
+
+double tN2kMsg::Get4ByteDouble(double precision_, int& index_, double def_) const {
+	if (index_ + 4 > this->DataLen) {
+		return def_;
+	}
+	int32_t v_ = (int32_t)((uint32_t)this->Data[index_] | ((uint32_t)this->Data[index_ + 1] << 8) |
+		((uint32_t)this->Data[index_ + 2] << 16) | ((uint32_t)this->Data[index_ + 3] << 24));
+	index_ += 4;
+	return v_ == N2kInt32NA ? def_ : v_ * precision_;
+}
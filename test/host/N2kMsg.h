@@ -0,0 +1,57 @@
+// N2kMsg.h
+
+#pragma once
+
+#ifndef _HOST_N2KMSG_h
+#define _HOST_N2KMSG_h
+
+#include <stdint.h>
+
+// tN2kMsg of the NMEA2000 library with the encoders and decoders that the
+// firmware and the tests use. Rounding, range limits and the "not
+// available" values are the ones of N2kMsg.cpp, so the bytes are the same.
+
+const double N2kDoubleNA = -1e9;
+const uint8_t N2kUInt8NA = 0xff;
+const uint16_t N2kUInt16NA = 0xffff;
+const uint32_t N2kUInt24NA = 0xffffff;
+const int16_t N2kInt16NA = 0x7fff;
+const int32_t N2kInt32NA = 0x7fffffff;
+
+class tN2kMsg {
+public:
+    static const int MaxDataLen = 223;
+
+    unsigned char Priority;
+    unsigned long PGN;
+    mutable unsigned char Source;
+    mutable unsigned char Destination;
+    int DataLen;
+    unsigned char Data[MaxDataLen];
+    unsigned long MsgTime;
+
+    tN2kMsg(unsigned char source_ = 15, unsigned char priority_ = 6, unsigned long pgn_ = 0, int dataLen_ = 0);
+
+    void SetPGN(unsigned long pgn_);
+    void Clear();
+    bool IsValid() const { return PGN != 0 && DataLen > 0; }
+
+    void AddByte(unsigned char v_);
+    void Add2ByteUInt(uint16_t v_);
+    void Add4ByteUInt(uint32_t v_);
+    void AddUInt64(uint64_t v_);
+    void Add2ByteUDouble(double v_, double precision_, double undefVal_ = N2kDoubleNA);
+    void Add2ByteDouble(double v_, double precision_, double undefVal_ = N2kDoubleNA);
+    void Add3ByteUDouble(double v_, double precision_, double undefVal_ = N2kDoubleNA);
+    void Add4ByteDouble(double v_, double precision_, double undefVal_ = N2kDoubleNA);
+
+    unsigned char GetByte(int& index_) const;
+    uint16_t Get2ByteUInt(int& index_, uint16_t def_ = 0xffff) const;
+    uint64_t GetUInt64(int& index_, uint64_t def_ = 0xffffffffffffffffULL) const;
+    double Get2ByteUDouble(double precision_, int& index_, double def_ = N2kDoubleNA) const;
+    double Get2ByteDouble(double precision_, int& index_, double def_ = N2kDoubleNA) const;
+    double Get3ByteUDouble(double precision_, int& index_, double def_ = N2kDoubleNA) const;
+    double Get4ByteDouble(double precision_, int& index_, double def_ = N2kDoubleNA) const;
+};
+
+#endif
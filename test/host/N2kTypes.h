@@ -0,0 +1,43 @@
+// N2kTypes.h
+
+#pragma once
+
+#ifndef _HOST_N2KTYPES_h
+#define _HOST_N2KTYPES_h
+
+// The enums of the NMEA2000 library that the firmware uses, same values
+
+enum tN2kTempSource {
+    N2kts_SeaTemperature = 0,
+    N2kts_OutsideTemperature = 1,
+    N2kts_InsideTemperature = 2,
+    N2kts_EngineRoomTemperature = 3,
+    N2kts_MainCabinTemperature = 4,
+    N2kts_LiveWellTemperature = 5,
+    N2kts_BaitWellTemperature = 6,
+    N2kts_RefridgerationTemperature = 7,
+    N2kts_HeatingSystemTemperature = 8,
+    N2kts_DewPointTemperature = 9,
+    N2kts_ApparentWindChillTemperature = 10,
+    N2kts_TheoreticalWindChillTemperature = 11,
+    N2kts_HeatIndexTemperature = 12,
+    N2kts_FreezerTemperature = 13,
+    N2kts_ExhaustGasTemperature = 14,
+    N2kts_ShaftSealTemperature = 15
+};
+
+enum tN2kHumiditySource {
+    N2khs_InsideHumidity = 0,
+    N2khs_OutsideHumidity = 1,
+    N2khs_Undef = 0xff
+};
+
+enum tN2kPressureSource {
+    N2kps_Atmospheric = 0,
+    N2kps_Water = 1,
+    N2kps_Steam = 2,
+    N2kps_CompressedAir = 3,
+    N2kps_Hydraulic = 4
+};
+
+#endif
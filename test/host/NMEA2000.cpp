@@ -0,0 +1,88 @@
+//
+//
+//
+
+#include "NMEA2000.h"
+#include "NMEA2000_CAN.h"
+
+tNMEA2000 NMEA2000;
+
+void tNMEA2000::tDeviceInformation::Set(uint32_t uniqueNumber_, uint8_t deviceFunction_, uint8_t deviceClass_, uint16_t manufacturerCode_, uint8_t industryGroup_) {
+	this->_name = (uint64_t)(uniqueNumber_ & 0x1fffff) |
+		((uint64_t)(manufacturerCode_ & 0x7ff) << 21) |
+		((uint64_t)deviceFunction_ << 40) |
+		((uint64_t)(deviceClass_ & 0x7f) << 49) |
+		((uint64_t)(industryGroup_ & 0x07) << 60) |
+		((uint64_t)1 << 63); // arbitrary address capable
+}
+
+tNMEA2000::tNMEA2000() {
+	this->reset();
+}
+
+void tNMEA2000::reset() {
+	for (uint8_t i = 0; i < MaxDevices; i++) {
+		this->_devices[i] = Device();
+	}
+	this->_deviceCount = 1;
+	this->_mode = N2km_ListenOnly;
+	this->_onOpen = nullptr;
+	this->_openRequested = false;
+	this->_open = false;
+	this->_parseCalls = 0;
+}
+
+void tNMEA2000::SetProductInformation(const char* modelSerialCode_, unsigned short productCode_, const char* modelID_,
+	const char* swCode_, const char* modelVersion_, unsigned char loadEquivalency_, unsigned short n2kVersion_,
+	unsigned char certificationLevel_, int device_) {
+	(void)modelSerialCode_;
+	(void)productCode_;
+	(void)modelID_;
+	(void)swCode_;
+	(void)modelVersion_;
+	(void)loadEquivalency_;
+	(void)n2kVersion_;
+	(void)certificationLevel_;
+	(void)device_;
+}
+
+void tNMEA2000::SetDeviceInformation(unsigned long uniqueNumber_, unsigned char deviceFunction_, unsigned char deviceClass_,
+	uint16_t manufacturersCode_, unsigned char industryGroup_, int device_) {
+	this->_devices[device_].Information.Set(uniqueNumber_, deviceFunction_, deviceClass_, manufacturersCode_, industryGroup_);
+}
+
+void tNMEA2000::SetN2kCANReceiveFrameBufSize(uint16_t size_) {
+	gHostCan.setReceiveBufferSize(size_);
+}
+
+void tNMEA2000::SetN2kCANSendFrameBufSize(uint16_t size_) {
+	gHostCan.setSendBufferSize(size_);
+}
+
+/*
+ * As in the library the open completes in the next ParseMessages(),
+ * which calls the OnOpen callback.
+ */
+bool tNMEA2000::Open() {
+	this->_openRequested = true;
+	return true;
+}
+
+void tNMEA2000::ParseMessages() {
+	this->_parseCalls++;
+	if (this->_openRequested && !this->_open) {
+		this->_open = true;
+		if (this->_onOpen != nullptr) {
+			this->_onOpen();
+		}
+	}
+	gHostCan.receive();
+}
+
+bool tNMEA2000::SendMsg(const tN2kMsg& msg_, int device_) {
+	if (!this->_open || device_ < 0 || device_ >= this->_deviceCount) {
+		return false;
+	}
+	msg_.Source = this->_devices[device_].Source;
+	return gHostCan.send(msg_, (uint8_t)device_, msg_.Source);
+}
@@ -0,0 +1,84 @@
+// NMEA2000.h
+
+#pragma once
+
+#ifndef _HOST_NMEA2000_h
+#define _HOST_NMEA2000_h
+
+#include <stdint.h>
+
+#include "N2kMsg.h"
+#include "hostcan.h"
+
+// tNMEA2000 of the library on top of HostCanBus. It keeps the device list,
+// the source addresses and the open state; address claiming and the
+// protocol messages are not simulated. A test changes an address with
+// claimAddress() as a lost claim would.
+class tNMEA2000 {
+public:
+    static const uint8_t MaxDevices = 16;
+
+    enum tN2kMode {
+        N2km_ListenOnly,
+        N2km_NodeOnly,
+        N2km_ListenAndNode,
+        N2km_SendOnly,
+        N2km_ListenAndSend
+    };
+
+    class tDeviceInformation {
+    public:
+        void Set(uint32_t uniqueNumber_, uint8_t deviceFunction_, uint8_t deviceClass_, uint16_t manufacturerCode_, uint8_t industryGroup_);
+        uint64_t GetName() const { return _name; };
+
+    private:
+        uint64_t _name = 0;
+    };
+
+    tNMEA2000();
+
+    void SetProductInformation(const char* modelSerialCode_, unsigned short productCode_, const char* modelID_,
+        const char* swCode_, const char* modelVersion_, unsigned char loadEquivalency_, unsigned short n2kVersion_,
+        unsigned char certificationLevel_, int device_);
+    void SetDeviceInformation(unsigned long uniqueNumber_, unsigned char deviceFunction_, unsigned char deviceClass_,
+        uint16_t manufacturersCode_, unsigned char industryGroup_, int device_);
+    const tDeviceInformation& GetDeviceInformation(int device_) const { return _devices[device_].Information; };
+
+    void SetDeviceCount(uint8_t count_) { _deviceCount = count_; };
+    void SetOnOpen(void (*onOpen_)()) { _onOpen = onOpen_; };
+    void SetN2kCANMsgBufSize(uint8_t size_) { (void)size_; };
+    void SetN2kCANReceiveFrameBufSize(uint16_t size_);
+    void SetN2kCANSendFrameBufSize(uint16_t size_);
+    void EnableForward(bool enable_) { (void)enable_; };
+    void SetMode(tN2kMode mode_, uint8_t source_ = 15) { _mode = mode_; (void)source_; };
+    void SetN2kSource(uint8_t source_, int device_) { _devices[device_].Source = source_; };
+    void ExtendTransmitMessages(const unsigned long* messages_, int device_) { _devices[device_].TransmitMessages = messages_; };
+
+    bool Open();
+    void ParseMessages();
+    bool SendMsg(const tN2kMsg& msg_, int device_ = -1);
+
+    uint8_t GetN2kSource(int device_ = 0) const { return _devices[device_].Source; };
+
+    // Host only: the device lost its address and claimed source_
+    void claimAddress(int device_, uint8_t source_) { _devices[device_].Source = source_; };
+    uint32_t parseCalls() const { return _parseCalls; };
+    void reset();
+
+private:
+    struct Device {
+        uint8_t Source;
+        const unsigned long* TransmitMessages;
+        tDeviceInformation Information;
+    };
+
+    Device _devices[MaxDevices];
+    uint8_t _deviceCount;
+    tN2kMode _mode;
+    void (*_onOpen)();
+    bool _openRequested;
+    bool _open;
+    uint32_t _parseCalls;
+};
+
+#endif
@@ -0,0 +1,8 @@
+// NMEA2000_CAN.h
+
+#pragma once
+
+#include "NMEA2000.h"
+
+// The library creates the driver object for the board here
+extern tNMEA2000 NMEA2000;
@@ -0,0 +1,18 @@
+// RebootManager.h
+
+#pragma once
+
+#ifndef _HOST_REBOOTMANAGER_h
+#define _HOST_REBOOTMANAGER_h
+
+#include "Arduino.h"
+
+// Every host run is the first boot after power-on
+class RebootManager {
+public:
+    static void begin() {}
+    static int getRebootCount() { return 1; }
+    static String getLastRebootReasonText() { return String("Power on"); }
+};
+
+#endif
@@ -0,0 +1,22 @@
+// WebSerial.h
+
+#pragma once
+
+#ifndef _HOST_WEBSERIAL_h
+#define _HOST_WEBSERIAL_h
+
+#include "Arduino.h"
+#include "ESPAsyncWebServer.h"
+
+// Writes to HostLog like Serial
+class WebSerialClass : public Print {
+public:
+    void begin(AsyncWebServer* server_, const char* url_ = "/webserial") { (void)server_; (void)url_; }
+
+protected:
+    void write(const char* text_, size_t length_) override { HostLog::write(text_, length_); }
+};
+
+extern WebSerialClass WebSerial;
+
+#endif
@@ -0,0 +1,26 @@
+// WiFi.h
+
+#pragma once
+
+#ifndef _HOST_WIFI_h
+#define _HOST_WIFI_h
+
+#include <stdint.h>
+#include <string.h>
+
+#include "Arduino.h"
+
+// A station that is connected with a fixed signal and address
+class WiFiClass {
+public:
+    int8_t RSSI() const { return -61; }
+    IPAddress localIP() const { return IPAddress(192, 168, 1, 42); }
+    uint8_t* macAddress(uint8_t* mac_) const;
+};
+
+extern WiFiClass WiFi;
+
+class WiFiClient {
+};
+
+#endif
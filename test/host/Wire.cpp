@@ -0,0 +1,26 @@
+//
+//
+//
+
+#include "Wire.h"
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
+
+/*
+ * Address + write bytes, then address + read bytes after a repeated start.
+ * Each byte takes 9 clocks, start and stop one each.
+ */
+bool TwoWire::transfer(uint8_t address_, const uint8_t* write_, size_t writeLen_, uint8_t* read_, size_t readLen_) {
+	HostI2CDevice* device_ = this->_devices[address_ & 0x7f];
+	size_t bytes_ = 1 + writeLen_ + (readLen_ > 0 ? 1 + readLen_ : 0);
+
+	this->_transactions++;
+	this->_bytes += bytes_;
+	this->_bits += bytes_ * 9 + 2 + (readLen_ > 0 && writeLen_ > 0 ? 1 : 0);
+
+	if (device_ == nullptr) {
+		return false; // no acknowledge
+	}
+	return device_->transfer(write_, writeLen_, read_, readLen_);
+}
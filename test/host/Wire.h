@@ -0,0 +1,51 @@
+// Wire.h
+
+#pragma once
+
+#ifndef _HOST_WIRE_h
+#define _HOST_WIRE_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+// A device on a simulated I2C bus
+class HostI2CDevice {
+public:
+    virtual ~HostI2CDevice() {}
+
+    // One transaction. write_ is sent first (register pointer and data),
+    // then read_ bytes are read with a repeated start.
+    virtual bool transfer(const uint8_t* write_, size_t writeLen_, uint8_t* read_, size_t readLen_) = 0;
+};
+
+// I2C controller with simulated devices. Counts the transactions and the
+// bytes on the bus, including address bytes.
+class TwoWire {
+public:
+    static const uint32_t Frequency = 100000;
+
+    explicit TwoWire(uint8_t busNum_) : _busNum(busNum_) {}
+
+    void attach(uint8_t address_, HostI2CDevice* device_) { _devices[address_ & 0x7f] = device_; };
+    void detach(uint8_t address_) { _devices[address_ & 0x7f] = nullptr; };
+
+    bool transfer(uint8_t address_, const uint8_t* write_, size_t writeLen_, uint8_t* read_, size_t readLen_);
+
+    uint32_t transactions() const { return _transactions; };
+    uint32_t bytes() const { return _bytes; };
+    // Time on the bus at Frequency, 9 clocks per byte plus start and stop
+    uint32_t busTime() const { return (uint32_t)((uint64_t)_bits * 1000000 / Frequency); }; // us
+    void resetCounters() { _transactions = 0; _bytes = 0; _bits = 0; };
+
+private:
+    uint8_t _busNum;
+    HostI2CDevice* _devices[128] = {};
+    uint32_t _transactions = 0;
+    uint32_t _bytes = 0;
+    uint64_t _bits = 0;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
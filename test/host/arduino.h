@@ -0,0 +1,6 @@
+// arduino.h
+
+#pragma once
+
+// The sources include the core as "arduino.h" and as <Arduino.h>
+#include "Arduino.h"
@@ -0,0 +1,43 @@
+// gpio.h
+
+#pragma once
+
+#ifndef _HOST_GPIO_h
+#define _HOST_GPIO_h
+
+#include <stdint.h>
+#include "../esp_err.h"
+
+// Edge interrupts of the host build. HostCanBus raises an edge on the RX
+// pin for every frame that arrives.
+
+typedef enum {
+    GPIO_NUM_0 = 0, GPIO_NUM_1, GPIO_NUM_2, GPIO_NUM_3, GPIO_NUM_4, GPIO_NUM_5,
+    GPIO_NUM_12 = 12, GPIO_NUM_13, GPIO_NUM_14, GPIO_NUM_15,
+    GPIO_NUM_MAX = 40
+} gpio_num_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE
+} gpio_int_type_t;
+
+typedef void (*gpio_isr_t)(void* arg_);
+
+esp_err_t gpio_install_isr_service(int flags_);
+esp_err_t gpio_set_intr_type(gpio_num_t pin_, gpio_int_type_t type_);
+esp_err_t gpio_isr_handler_add(gpio_num_t pin_, gpio_isr_t handler_, void* arg_);
+esp_err_t gpio_intr_enable(gpio_num_t pin_);
+esp_err_t gpio_intr_disable(gpio_num_t pin_);
+
+namespace HostGpio {
+    // Calls the handler of the pin if its interrupt is enabled.
+    // Returns true if the handler ran.
+    bool edge(gpio_num_t pin_);
+    uint32_t interrupts();
+    void reset();
+}
+
+#endif
@@ -0,0 +1,182 @@
+//
+//
+//
+
+#include "Arduino.h"
+
+#include <random>
+
+#include "esp_mac.h"
+#include "driver/gpio.h"
+#include "hostcan.h"
+
+// Handle of the task that runs setup() and loop()
+static int MainTask;
+static int OtherTasks[4];
+static uint8_t TaskCount = 0;
+
+static uint32_t Notifications = 0;
+static uint32_t SleptMs = 0;
+static uint32_t NotifiedWakes = 0;
+static uint32_t TimeoutWakes = 0;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function_, const char* name_, uint32_t stackDepth_, void* parameter_, UBaseType_t priority_, TaskHandle_t* handle_, BaseType_t core_) {
+	(void)function_;
+	(void)name_;
+	(void)stackDepth_;
+	(void)parameter_;
+	(void)priority_;
+	(void)core_;
+
+	if (handle_ != nullptr) {
+		*handle_ = &OtherTasks[TaskCount++ % 4];
+	}
+	return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+	return &MainTask;
+}
+
+// A plausible figure, the host knows nothing about the stacks of the device
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task_) {
+	return task_ == &MainTask ? 4200 : 6100;
+}
+
+void vTaskDelay(TickType_t ticks_) {
+	HostClock::advance(ticks_);
+}
+
+/*
+ * Sleeps until the timeout or until an arriving frame raises the RX edge
+ * with the interrupt armed. The clock stands at the wake-up time afterwards.
+ */
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit_, TickType_t ticksToWait_) {
+	uint64_t start_ = HostClock::now();
+	uint64_t deadline_ = start_ + (uint64_t)ticksToWait_ * 1000;
+	uint64_t arrival_;
+
+	gHostCan.arrive(start_);
+	while (Notifications == 0 && gHostCan.nextArrival(arrival_) && arrival_ < deadline_) {
+		HostClock::advanceMicros((uint32_t)(arrival_ - HostClock::now()));
+		gHostCan.arrive(arrival_);
+	}
+
+	if (Notifications == 0) {
+		HostClock::advanceMicros((uint32_t)(deadline_ - HostClock::now()));
+	}
+	SleptMs += (uint32_t)((HostClock::now() - start_) / 1000);
+
+	uint32_t value_ = Notifications;
+	if (value_ == 0) {
+		TimeoutWakes++;
+		return 0;
+	}
+	NotifiedWakes++;
+	Notifications = clearCountOnExit_ ? 0 : value_ - 1;
+	return value_;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task_, BaseType_t* higherPriorityTaskWoken_) {
+	(void)task_;
+	Notifications++;
+	if (higherPriorityTaskWoken_ != nullptr) {
+		*higherPriorityTaskWoken_ = pdTRUE;
+	}
+}
+
+uint32_t HostTask::sleptMs() {
+	return SleptMs;
+}
+
+uint32_t HostTask::notifiedWakes() {
+	return NotifiedWakes;
+}
+
+uint32_t HostTask::timeoutWakes() {
+	return TimeoutWakes;
+}
+
+void HostTask::reset() {
+	Notifications = 0;
+	SleptMs = 0;
+	NotifiedWakes = 0;
+	TimeoutWakes = 0;
+}
+
+uint32_t esp_random() {
+	static std::mt19937 random_{ std::random_device()() };
+	return random_();
+}
+
+esp_err_t esp_efuse_mac_get_default(uint8_t* mac_) {
+	static const uint8_t mac[6] = { 0x24, 0x6f, 0x28, 0x1a, 0x2b, 0x3c };
+	memcpy(mac_, mac, sizeof(mac));
+	return ESP_OK;
+}
+
+struct GpioPin {
+	gpio_isr_t Handler;
+	void* Arg;
+	gpio_int_type_t Type;
+	bool Enabled;
+};
+
+static GpioPin Pins[GPIO_NUM_MAX];
+static bool IsrService = false;
+static uint32_t Interrupts = 0;
+
+esp_err_t gpio_install_isr_service(int flags_) {
+	(void)flags_;
+	if (IsrService) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	IsrService = true;
+	return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t pin_, gpio_int_type_t type_) {
+	Pins[pin_].Type = type_;
+	return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t pin_, gpio_isr_t handler_, void* arg_) {
+	if (!IsrService) {
+		return ESP_ERR_INVALID_STATE;
+	}
+	Pins[pin_].Handler = handler_;
+	Pins[pin_].Arg = arg_;
+	return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t pin_) {
+	Pins[pin_].Enabled = true;
+	return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t pin_) {
+	Pins[pin_].Enabled = false;
+	return ESP_OK;
+}
+
+bool HostGpio::edge(gpio_num_t pin_) {
+	GpioPin& gpio_ = Pins[pin_];
+	if (gpio_.Handler == nullptr || !gpio_.Enabled || gpio_.Type == GPIO_INTR_DISABLE) {
+		return false;
+	}
+	Interrupts++;
+	gpio_.Handler(gpio_.Arg);
+	return true;
+}
+
+uint32_t HostGpio::interrupts() {
+	return Interrupts;
+}
+
+void HostGpio::reset() {
+	for (uint8_t i = 0; i < GPIO_NUM_MAX; i++) {
+		Pins[i] = GpioPin();
+	}
+	IsrService = false;
+	Interrupts = 0;
+}
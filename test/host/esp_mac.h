@@ -0,0 +1,9 @@
+// esp_mac.h
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// The same MAC on every host run, so the NAMEs of the devices are stable
+esp_err_t esp_efuse_mac_get_default(uint8_t* mac_);
@@ -0,0 +1,67 @@
+// FreeRTOS.h
+
+#pragma once
+
+#ifndef _HOST_FREERTOS_h
+#define _HOST_FREERTOS_h
+
+// Host stand-in for the FreeRTOS API of the ESP32 core. Only the task that
+// runs loop() is simulated: its sleep moves HostClock forward and ends early
+// when HostCanBus delivers a frame to an armed RX interrupt. Other tasks are
+// created but not started, a test calls their work directly.
+
+#include <stdint.h>
+#include <atomic>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFF
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms_) ((TickType_t)(ms_))
+#define portYIELD_FROM_ISR()
+
+// Spinlock of the critical sections, so the lock free code can be run with threads
+struct portMUX_TYPE {
+    std::atomic_flag Locked = ATOMIC_FLAG_INIT;
+};
+
+#define portMUX_INITIALIZER_UNLOCKED portMUX_TYPE()
+
+inline void vPortEnterCritical(portMUX_TYPE* mux_) {
+    while (mux_->Locked.test_and_set(std::memory_order_acquire)) {
+    }
+}
+
+inline void vPortExitCritical(portMUX_TYPE* mux_) {
+    mux_->Locked.clear(std::memory_order_release);
+}
+
+#define portENTER_CRITICAL(mux_) vPortEnterCritical(mux_)
+#define portEXIT_CRITICAL(mux_) vPortExitCritical(mux_)
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function_, const char* name_, uint32_t stackDepth_, void* parameter_, UBaseType_t priority_, TaskHandle_t* handle_, BaseType_t core_);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task_);
+void vTaskDelay(TickType_t ticks_);
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit_, TickType_t ticksToWait_);
+void vTaskNotifyGiveFromISR(TaskHandle_t task_, BaseType_t* higherPriorityTaskWoken_);
+
+// Bookkeeping of the simulated loop() task
+namespace HostTask {
+    // Time the task spent in ulTaskNotifyTake(), in ms
+    uint32_t sleptMs();
+    // Wakes by a notification and by the timeout
+    uint32_t notifiedWakes();
+    uint32_t timeoutWakes();
+    void reset();
+}
+
+#endif
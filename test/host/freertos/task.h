@@ -0,0 +1,5 @@
+// task.h
+
+#pragma once
+
+#include "FreeRTOS.h"
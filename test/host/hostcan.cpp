@@ -0,0 +1,212 @@
+//
+//
+//
+
+#include "hostcan.h"
+
+#include <string.h>
+
+#include "Arduino.h"
+
+HostCanBus gHostCan;
+
+HostCanBus::HostCanBus() {
+	this->reset();
+}
+
+void HostCanBus::reset() {
+	this->_sendBufferSize = 150;
+	this->_frameRate = 0;
+	this->_busFree = 0;
+	this->_sequence = 0;
+	this->_sendBuffer.clear();
+	this->_inFlight.clear();
+	this->_messages.clear();
+	this->_frames.clear();
+	this->_rejected = 0;
+
+	this->_receiveBufferSize = 150;
+	this->_arrivals.clear();
+	this->_received = 0;
+	this->_overruns = 0;
+	this->_latencies.clear();
+}
+
+uint16_t HostCanBus::frameCount(int dataLen_) {
+	// 6 bytes in the first frame of a fast packet, 7 in the others
+	return dataLen_ <= 8 ? 1 : 1 + (dataLen_ - 6 + 7 - 1) / 7;
+}
+
+/*
+ * Splits the message into frames. A message that does not fit into the
+ * free part of the send buffer is refused as a whole.
+ */
+bool HostCanBus::send(const tN2kMsg& msg_, uint8_t device_, uint8_t source_) {
+	uint64_t now_ = HostClock::now();
+	uint16_t frames_ = frameCount(msg_.DataLen);
+
+	this->update();
+	if (this->_sendBuffer.size() + frames_ > this->_sendBufferSize) {
+		this->_rejected++;
+		return false;
+	}
+
+	Pending pending_ = {};
+	pending_.Queued = now_;
+	pending_.Frame.PGN = msg_.PGN;
+	pending_.Frame.Priority = msg_.Priority;
+	pending_.Frame.Source = source_;
+
+	if (frames_ == 1) {
+		pending_.Frame.Length = msg_.DataLen;
+		memcpy(pending_.Frame.Data, msg_.Data, msg_.DataLen);
+		pending_.Last = true;
+		this->_sendBuffer.push_back(pending_);
+	}
+	else {
+		uint8_t sequence_ = (this->_sequence++ & 0x07) << 5;
+		int index_ = 0;
+		for (uint16_t i = 0; i < frames_; i++) {
+			memset(pending_.Frame.Data, 0xff, 8);
+			pending_.Frame.Length = 8;
+			pending_.Frame.Data[0] = sequence_ | i;
+			uint8_t start_ = 1;
+			if (i == 0) {
+				pending_.Frame.Data[1] = msg_.DataLen;
+				start_ = 2;
+			}
+			for (uint8_t j = start_; j < 8 && index_ < msg_.DataLen; j++) {
+				pending_.Frame.Data[j] = msg_.Data[index_++];
+			}
+			pending_.Last = i + 1 == frames_;
+			this->_sendBuffer.push_back(pending_);
+		}
+	}
+
+	HostCanMessage message_;
+	message_.Queued = now_;
+	message_.Sent = 0;
+	message_.Device = device_;
+	message_.Source = source_;
+	message_.Frames = frames_;
+	message_.Msg = msg_;
+	message_.Msg.Source = source_;
+	this->_inFlight.push_back(message_);
+
+	this->deliver(now_);
+	return true;
+}
+
+void HostCanBus::update() {
+	this->deliver(HostClock::now());
+}
+
+/*
+ * Without a frame rate every frame leaves when it is queued. Otherwise a
+ * frame takes 1 / rate s and starts when the bus is free again.
+ */
+void HostCanBus::deliver(uint64_t now_) {
+	while (!this->_sendBuffer.empty()) {
+		Pending pending_ = this->_sendBuffer.front();
+		uint64_t time_ = pending_.Queued;
+
+		if (this->_frameRate > 0) {
+			uint64_t start_ = this->_busFree > pending_.Queued ? this->_busFree : pending_.Queued;
+			time_ = start_ + 1000000 / this->_frameRate;
+			if (time_ > now_) {
+				break;
+			}
+			this->_busFree = time_;
+		}
+
+		this->_sendBuffer.pop_front();
+		pending_.Frame.Time = time_;
+		this->_frames.push_back(pending_.Frame);
+
+		if (pending_.Last) {
+			HostCanMessage& message_ = this->_inFlight.front();
+			message_.Sent = time_;
+			this->_messages.push_back(message_);
+			this->_inFlight.pop_front();
+		}
+	}
+}
+
+const std::vector<HostCanMessage>& HostCanBus::messages() {
+	this->update();
+	return this->_messages;
+}
+
+const std::vector<HostCanFrame>& HostCanBus::frames() {
+	this->update();
+	return this->_frames;
+}
+
+void HostCanBus::clearSent() {
+	this->update();
+	this->_messages.clear();
+	this->_frames.clear();
+}
+
+void HostCanBus::inject(uint64_t time_, uint32_t pgn_, uint8_t source_, uint8_t length_) {
+	Arrival arrival_ = {};
+	arrival_.Frame.Time = time_;
+	arrival_.Frame.PGN = pgn_;
+	arrival_.Frame.Priority = 6;
+	arrival_.Frame.Source = source_;
+	arrival_.Frame.Length = length_;
+
+	auto position_ = this->_arrivals.end();
+	while (position_ != this->_arrivals.begin() && (position_ - 1)->Frame.Time > time_) {
+		position_--;
+	}
+	this->_arrivals.insert(position_, arrival_);
+}
+
+bool HostCanBus::nextArrival(uint64_t& time_) const {
+	for (const Arrival& arrival_ : this->_arrivals) {
+		if (!arrival_.Edge) {
+			time_ = arrival_.Frame.Time;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool HostCanBus::arrive(uint64_t now_) {
+	bool woken_ = false;
+
+	for (Arrival& arrival_ : this->_arrivals) {
+		if (arrival_.Frame.Time > now_) {
+			break;
+		}
+		if (!arrival_.Edge) {
+			arrival_.Edge = true;
+			woken_ |= HostGpio::edge(RxPin);
+		}
+	}
+	return woken_;
+}
+
+/*
+ * Frames that did not fit into the receive buffer before the parse are lost
+ */
+uint32_t HostCanBus::receive() {
+	uint64_t now_ = HostClock::now();
+	uint32_t count_ = 0;
+
+	this->arrive(now_);
+	while (!this->_arrivals.empty() && this->_arrivals.front().Frame.Time <= now_) {
+		if (count_ < this->_receiveBufferSize) {
+			this->_latencies.push_back((uint32_t)(now_ - this->_arrivals.front().Frame.Time));
+			count_++;
+		}
+		else {
+			this->_overruns++;
+		}
+		this->_arrivals.pop_front();
+	}
+
+	this->_received += count_;
+	return count_;
+}
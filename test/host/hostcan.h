@@ -0,0 +1,114 @@
+// hostcan.h
+
+#pragma once
+
+#ifndef _HOSTCAN_h
+#define _HOSTCAN_h
+
+#include <stdint.h>
+#include <vector>
+#include <deque>
+
+#include "N2kMsg.h"
+#include "driver/gpio.h"
+
+// One CAN frame on the simulated bus
+struct HostCanFrame {
+    uint64_t Time;    // us when the frame left the send buffer or arrived
+    uint32_t PGN;
+    uint8_t Priority;
+    uint8_t Source;
+    uint8_t Length;
+    uint8_t Data[8];
+};
+
+// A message of this node as it went on the bus
+struct HostCanMessage {
+    uint64_t Queued;  // us when SendMsg() took it
+    uint64_t Sent;    // us when its last frame left
+    uint8_t Device;
+    uint8_t Source;
+    uint16_t Frames;
+    tN2kMsg Msg;
+};
+
+// In-process CAN bus behind tNMEA2000. Sent messages are split into frames
+// (fast packet above 8 bytes) and go into a send buffer of the size the
+// firmware sets; the bus takes them at a configurable frame rate, so a
+// congested bus fills the buffer and SendMsg() fails as on the device.
+// Frames of other nodes are injected with their arrival time. They reach
+// the receive buffer when the clock passes that time and raise an edge on
+// the RX pin, which wakes loop() if the notification is armed.
+class HostCanBus {
+public:
+    static const gpio_num_t RxPin = GPIO_NUM_4;
+
+    HostCanBus();
+
+    void reset();
+
+    // Send side
+    void setSendBufferSize(uint16_t frames_) { _sendBufferSize = frames_; };
+    // Frames per second the bus takes from this node, 0 takes them at once
+    void setFrameRate(uint32_t framesPerSecond_) { _frameRate = framesPerSecond_; };
+    bool send(const tN2kMsg& msg_, uint8_t device_, uint8_t source_);
+    // Moves the frames that left the send buffer by now to the bus
+    void update();
+
+    const std::vector<HostCanMessage>& messages();
+    const std::vector<HostCanFrame>& frames();
+    void clearSent();
+    uint32_t rejected() const { return _rejected; };
+    uint16_t bufferedFrames() const { return (uint16_t)_sendBuffer.size(); };
+
+    // Receive side
+    void setReceiveBufferSize(uint16_t frames_) { _receiveBufferSize = frames_; };
+    // A single frame of another node arriving at time_ us
+    void inject(uint64_t time_, uint32_t pgn_, uint8_t source_, uint8_t length_ = 8);
+    // Time of the next arrival that did not raise its edge yet
+    bool nextArrival(uint64_t& time_) const;
+    // Raises the edges of the arrivals up to now_, true if the RX interrupt woke the task
+    bool arrive(uint64_t now_);
+    // Called by ParseMessages(): takes the received frames and records their latency
+    uint32_t receive();
+
+    uint32_t received() const { return _received; };
+    uint32_t overruns() const { return _overruns; };
+    const std::vector<uint32_t>& latencies() const { return _latencies; }; // us from arrival to parse
+
+    static uint16_t frameCount(int dataLen_);
+
+private:
+    struct Pending {
+        uint64_t Queued;
+        HostCanFrame Frame;
+        bool Last; // last frame of its message
+    };
+
+    struct Arrival {
+        HostCanFrame Frame;
+        bool Edge; // raised its edge on the RX pin
+    };
+
+    void deliver(uint64_t now_);
+
+    uint16_t _sendBufferSize;
+    uint32_t _frameRate;
+    uint64_t _busFree;
+    uint8_t _sequence;
+    std::deque<Pending> _sendBuffer;
+    std::deque<HostCanMessage> _inFlight;
+    std::vector<HostCanMessage> _messages;
+    std::vector<HostCanFrame> _frames;
+    uint32_t _rejected;
+
+    uint16_t _receiveBufferSize;
+    std::deque<Arrival> _arrivals; // sorted by time
+    uint32_t _received;
+    uint32_t _overruns;
+    std::vector<uint32_t> _latencies;
+};
+
+extern HostCanBus gHostCan;
+
+#endif
@@ -0,0 +1,25 @@
+// hostclock.h
+
+#pragma once
+
+#ifndef _HOSTCLOCK_h
+#define _HOSTCLOCK_h
+
+#include <stdint.h>
+
+// Simulated time of the host build. It only moves when a test, delay() or
+// the sleep of a task moves it, so runs are repeatable and an hour of
+// firmware time takes milliseconds.
+namespace HostClock {
+    uint32_t millis();
+    uint32_t micros();
+    // us since the start, does not wrap
+    uint64_t now();
+
+    // Starts again at ms_, e.g. for a new boot
+    void set(uint32_t ms_);
+    void advance(uint32_t ms_);
+    void advanceMicros(uint32_t us_);
+}
+
+#endif
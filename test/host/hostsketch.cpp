@@ -0,0 +1,54 @@
+//
+//
+//
+
+#include "hostsketch.h"
+
+#include "Arduino.h"
+#include "Adafruit_BME280.h"
+
+void setup();
+void loop();
+void wifiLoop();
+
+static SimBME280 Sensors[HostSketch::SensorSlots];
+static bool Booted = false;
+static uint64_t NextWifiLoop = 0;
+
+// The same places as Sensors[] of the sketch
+static TwoWire* const SensorBus[HostSketch::SensorSlots] = { &Wire, &Wire, &Wire1, &Wire1 };
+static const uint8_t SensorAddress[HostSketch::SensorSlots] = { BME280_ADDRESS_ALTERNATE, BME280_ADDRESS, BME280_ADDRESS_ALTERNATE, BME280_ADDRESS };
+
+SimBME280& HostSketch::sensor(uint8_t sensor_) {
+	return Sensors[sensor_];
+}
+
+void HostSketch::boot() {
+	if (Booted) {
+		return;
+	}
+	Booted = true;
+
+	for (uint8_t i = 0; i < SensorSlots; i++) {
+		Sensors[i].attach(*SensorBus[i], SensorAddress[i]);
+	}
+	setup();
+	NextWifiLoop = HostClock::now();
+}
+
+void HostSketch::step() {
+	loop();
+	while (HostClock::now() >= NextWifiLoop) {
+		wifiLoop();
+		NextWifiLoop += 100000;
+	}
+}
+
+void HostSketch::run(uint32_t ms_) {
+	uint64_t end_ = HostClock::now() + (uint64_t)ms_ * 1000;
+
+	boot();
+	while (HostClock::now() < end_) {
+		step();
+	}
+}
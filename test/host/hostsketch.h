@@ -0,0 +1,28 @@
+// hostsketch.h
+
+#pragma once
+
+#ifndef _HOSTSKETCH_h
+#define _HOSTSKETCH_h
+
+#include <stdint.h>
+
+#include "simbme280.h"
+
+// The sketch on the host: setup() once, then loop() with its sleeps on the
+// simulated clock and wifiLoop() every 100 ms in place of the loop2 task.
+namespace HostSketch {
+    static const uint8_t SensorSlots = 4;
+
+    // The sensor that answers at the address of Sensors[sensor_]
+    SimBME280& sensor(uint8_t sensor_);
+
+    // Attaches the sensors and runs setup(), only the first call boots
+    void boot();
+    // Runs the firmware for ms_ of simulated time
+    void run(uint32_t ms_);
+    // One iteration of loop(), including its sleep
+    void step();
+}
+
+#endif
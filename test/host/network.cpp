@@ -0,0 +1,17 @@
+//
+//
+//
+
+#include "WiFi.h"
+#include "ArduinoOTA.h"
+#include "WebSerial.h"
+
+WiFiClass WiFi;
+ArduinoOTAClass ArduinoOTA;
+WebSerialClass WebSerial;
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac_) const {
+	static const uint8_t station_[6] = { 0x24, 0x6f, 0x28, 0x1a, 0x2b, 0x3c };
+	memcpy(mac_, station_, sizeof(station_));
+	return mac_;
+}
@@ -0,0 +1,337 @@
+//
+//
+//
+
+#include "simbme280.h"
+
+#include <string.h>
+
+#include "Arduino.h"
+
+const SimBME280::Calibration SimBME280::DatasheetCalibration = {
+	27504, 26435, -1000,
+	36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+	75, 362, 0, 313, 50, 30
+};
+
+// Register values after a reset or with the channel skipped
+#define SIM_SKIPPED_20BIT 0x80000
+#define SIM_SKIPPED_16BIT 0x8000
+
+SimBME280::SimBME280() {
+	this->_calibration = DatasheetCalibration;
+	this->_useRaw = false;
+	this->_raw[0] = this->_raw[1] = this->_raw[2] = 0;
+	this->setConditions(20.0, 1013.25, 50.0);
+	this->reset();
+	this->_conversions = 0;
+	this->_staleReads = 0;
+	this->_dataReads = 0;
+	this->_lastTriggerToRead = 0;
+	this->_lastReadAge = 0;
+}
+
+void SimBME280::attach(TwoWire& wire_, uint8_t address_) {
+	wire_.attach(address_, this);
+}
+
+void SimBME280::setCalibration(const Calibration& calibration_) {
+	this->_calibration = calibration_;
+	this->reset();
+}
+
+void SimBME280::setConditions(double temperature_, double pressure_, double humidity_) {
+	Conditions conditions_ = { temperature_, pressure_, humidity_ };
+	this->setScript([conditions_](uint32_t) { return conditions_; });
+}
+
+void SimBME280::setRaw(int32_t adcT_, int32_t adcP_, int32_t adcH_) {
+	this->_raw[0] = adcT_;
+	this->_raw[1] = adcP_;
+	this->_raw[2] = adcH_;
+	this->_useRaw = true;
+}
+
+/*
+ * Power-on state: sleep mode, no conversion, data registers "skipped"
+ */
+void SimBME280::reset() {
+	const Calibration& c_ = this->_calibration;
+
+	memset(this->_registers, 0, sizeof(this->_registers));
+	this->_registers[0xD0] = 0x60;
+	this->_registers[0xD1] = 0x00;
+
+	const uint16_t words_[12] = {
+		c_.T1, (uint16_t)c_.T2, (uint16_t)c_.T3,
+		c_.P1, (uint16_t)c_.P2, (uint16_t)c_.P3, (uint16_t)c_.P4, (uint16_t)c_.P5,
+		(uint16_t)c_.P6, (uint16_t)c_.P7, (uint16_t)c_.P8, (uint16_t)c_.P9
+	};
+	for (uint8_t i = 0; i < 12; i++) {
+		this->_registers[0x88 + 2 * i] = words_[i] & 0xff;
+		this->_registers[0x89 + 2 * i] = words_[i] >> 8;
+	}
+	this->_registers[0xA1] = c_.H1;
+	this->_registers[0xE1] = (uint16_t)c_.H2 & 0xff;
+	this->_registers[0xE2] = (uint16_t)c_.H2 >> 8;
+	this->_registers[0xE3] = c_.H3;
+	this->_registers[0xE4] = (uint8_t)(c_.H4 >> 4);
+	this->_registers[0xE5] = (uint8_t)((c_.H4 & 0x0F) | ((c_.H5 & 0x0F) << 4));
+	this->_registers[0xE6] = (uint8_t)(c_.H5 >> 4);
+	this->_registers[0xE7] = (uint8_t)c_.H6;
+
+	this->_registers[0xF7] = 0x80;
+	this->_registers[0xFA] = 0x80;
+	this->_registers[0xFD] = 0x80;
+
+	this->_pointer = 0;
+	this->_converting = false;
+	this->_fresh = false;
+	this->_triggerTime = 0;
+	this->_conversionEnd = 0;
+	this->_lastEnd = 0;
+}
+
+bool SimBME280::transfer(const uint8_t* write_, size_t writeLen_, uint8_t* read_, size_t readLen_) {
+	uint64_t now_ = HostClock::now();
+	this->update(now_);
+
+	if (writeLen_ > 0) {
+		this->_pointer = write_[0];
+		// register address and value pairs
+		for (size_t i = 0; i + 1 < writeLen_; i += 2) {
+			this->write(write_[i], write_[i + 1]);
+		}
+	}
+
+	if (readLen_ > 0) {
+		uint16_t last_ = this->_pointer + readLen_ - 1;
+		if (this->_pointer <= 0xFE && last_ >= 0xF7) {
+			this->_dataReads++;
+			if (!this->_fresh) {
+				this->_staleReads++;
+			}
+			this->_fresh = false;
+			this->_lastTriggerToRead = (uint32_t)(now_ - this->_triggerTime);
+			this->_lastReadAge = (uint32_t)(now_ - this->_lastEnd);
+		}
+
+		for (size_t i = 0; i < readLen_; i++) {
+			read_[i] = this->_registers[(uint8_t)(this->_pointer + i)];
+		}
+	}
+	return true;
+}
+
+void SimBME280::write(uint8_t address_, uint8_t value_) {
+	uint64_t now_ = HostClock::now();
+
+	switch (address_) {
+	case 0xE0:
+		if (value_ == 0xB6) {
+			this->reset();
+		}
+		break;
+	case 0xF2:
+		this->_registers[0xF2] = value_ & 0x07;
+		break;
+	case 0xF5:
+		this->_registers[0xF5] = value_ & 0xFD;
+		break;
+	case 0xF4:
+		this->_registers[0xF4] = value_;
+		if ((value_ & 0x03) == 0) {
+			this->_converting = false;
+		}
+		else if ((value_ & 0x03) != 0x03 || !this->_converting) {
+			// forced mode starts one conversion, normal mode the first of its cycle
+			this->startConversion(now_);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void SimBME280::startConversion(uint64_t now_) {
+	this->_converting = true;
+	this->_triggerTime = now_;
+	this->_conversionEnd = now_ + measurementTime(this->_registers[0xF4] >> 5, (this->_registers[0xF4] >> 2) & 0x07, this->_registers[0xF2] & 0x07);
+}
+
+uint32_t SimBME280::cycleTime() const {
+	return measurementTime(this->_registers[0xF4] >> 5, (this->_registers[0xF4] >> 2) & 0x07, this->_registers[0xF2] & 0x07) +
+		standbyTime(this->_registers[0xF5] >> 5);
+}
+
+/*
+ * Ends the conversions that are done by now_. In forced mode the sensor
+ * goes back to sleep, in normal mode only the newest conversion counts.
+ */
+void SimBME280::update(uint64_t now_) {
+	if (!this->_converting || now_ < this->_conversionEnd) {
+		this->_registers[0xF3] = this->_converting && now_ + measurementTime(this->_registers[0xF4] >> 5, (this->_registers[0xF4] >> 2) & 0x07, this->_registers[0xF2] & 0x07) >= this->_conversionEnd ? 0x08 : 0x00;
+		return;
+	}
+
+	if ((this->_registers[0xF4] & 0x03) == 0x03) {
+		uint32_t cycle_ = this->cycleTime();
+		uint64_t cycles_ = (now_ - this->_conversionEnd) / cycle_;
+		this->_conversionEnd += cycles_ * cycle_;
+		this->latch(this->_conversionEnd);
+		this->_triggerTime = this->_conversionEnd + cycle_ - (cycle_ - standbyTime(this->_registers[0xF5] >> 5));
+		this->_conversionEnd += cycle_;
+	}
+	else {
+		this->latch(this->_conversionEnd);
+		this->_converting = false;
+		this->_registers[0xF4] &= 0xFC; // back to sleep
+	}
+	this->_registers[0xF3] = 0x00;
+}
+
+void SimBME280::latch(uint64_t end_) {
+	int32_t adcT_;
+	int32_t adcP_;
+	int32_t adcH_;
+
+	if (this->_useRaw) {
+		adcT_ = this->_raw[0];
+		adcP_ = this->_raw[1];
+		adcH_ = this->_raw[2];
+	}
+	else {
+		Conditions conditions_ = this->_script((uint32_t)(end_ / 1000));
+		adcT_ = this->rawTemperature(conditions_.Temperature);
+		adcP_ = this->rawPressure(conditions_.Pressure, adcT_);
+		adcH_ = this->rawHumidity(conditions_.Humidity, adcT_);
+	}
+
+	if ((this->_registers[0xF4] >> 5) == 0) {
+		adcT_ = SIM_SKIPPED_20BIT;
+	}
+	if (((this->_registers[0xF4] >> 2) & 0x07) == 0) {
+		adcP_ = SIM_SKIPPED_20BIT;
+	}
+	if ((this->_registers[0xF2] & 0x07) == 0) {
+		adcH_ = SIM_SKIPPED_16BIT;
+	}
+
+	this->_registers[0xF7] = (uint8_t)(adcP_ >> 12);
+	this->_registers[0xF8] = (uint8_t)(adcP_ >> 4);
+	this->_registers[0xF9] = (uint8_t)((adcP_ & 0x0F) << 4);
+	this->_registers[0xFA] = (uint8_t)(adcT_ >> 12);
+	this->_registers[0xFB] = (uint8_t)(adcT_ >> 4);
+	this->_registers[0xFC] = (uint8_t)((adcT_ & 0x0F) << 4);
+	this->_registers[0xFD] = (uint8_t)(adcH_ >> 8);
+	this->_registers[0xFE] = (uint8_t)adcH_;
+
+	this->_fresh = true;
+	this->_lastEnd = end_;
+	this->_conversions++;
+}
+
+static uint32_t oversampling(uint8_t code_) {
+	return code_ == 0 ? 0 : code_ >= 5 ? 16 : 1u << (code_ - 1);
+}
+
+uint32_t SimBME280::measurementTime(uint8_t osrsT_, uint8_t osrsP_, uint8_t osrsH_) {
+	uint32_t time_ = 1250 + 2300 * oversampling(osrsT_);
+	if (osrsP_ != 0) {
+		time_ += 2300 * oversampling(osrsP_) + 575;
+	}
+	if (osrsH_ != 0) {
+		time_ += 2300 * oversampling(osrsH_) + 575;
+	}
+	return time_;
+}
+
+uint32_t SimBME280::standbyTime(uint8_t tsb_) {
+	static const uint32_t times_[8] = { 500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000 };
+	return times_[tsb_ & 0x07];
+}
+
+double SimBME280::tFine(int32_t adcT_) const {
+	const Calibration& c_ = this->_calibration;
+	double var1_ = (adcT_ / 16384.0 - c_.T1 / 1024.0) * c_.T2;
+	double var2_ = (adcT_ / 131072.0 - c_.T1 / 8192.0) * (adcT_ / 131072.0 - c_.T1 / 8192.0) * c_.T3;
+	return var1_ + var2_;
+}
+
+double SimBME280::compensateTemperature(int32_t adcT_) const {
+	return this->tFine(adcT_) / 5120.0;
+}
+
+double SimBME280::compensatePressure(int32_t adcP_, int32_t adcT_) const {
+	const Calibration& c_ = this->_calibration;
+	double var1_ = this->tFine(adcT_) / 2.0 - 64000.0;
+	double var2_ = var1_ * var1_ * c_.P6 / 32768.0;
+	var2_ = var2_ + var1_ * c_.P5 * 2.0;
+	var2_ = var2_ / 4.0 + c_.P4 * 65536.0;
+	var1_ = (c_.P3 * var1_ * var1_ / 524288.0 + c_.P2 * var1_) / 524288.0;
+	var1_ = (1.0 + var1_ / 32768.0) * c_.P1;
+	if (var1_ == 0.0) {
+		return 0;
+	}
+	double p_ = 1048576.0 - adcP_;
+	p_ = (p_ - var2_ / 4096.0) * 6250.0 / var1_;
+	var1_ = c_.P9 * p_ * p_ / 2147483648.0;
+	var2_ = p_ * c_.P8 / 32768.0;
+	p_ = p_ + (var1_ + var2_ + c_.P7) / 16.0;
+	return p_ / 100.0;
+}
+
+double SimBME280::compensateHumidity(int32_t adcH_, int32_t adcT_) const {
+	const Calibration& c_ = this->_calibration;
+	double h_ = this->tFine(adcT_) - 76800.0;
+	h_ = (adcH_ - (c_.H4 * 64.0 + c_.H5 / 16384.0 * h_)) *
+		(c_.H2 / 65536.0 * (1.0 + c_.H6 / 67108864.0 * h_ * (1.0 + c_.H3 / 67108864.0 * h_)));
+	h_ = h_ * (1.0 - c_.H1 * h_ / 524288.0);
+	return h_ > 100.0 ? 100.0 : h_ < 0.0 ? 0.0 : h_;
+}
+
+int32_t SimBME280::rawTemperature(double temperature_) const {
+	int32_t low_ = 0;
+	int32_t high_ = 0xFFFFF;
+	while (low_ < high_) {
+		int32_t middle_ = (low_ + high_) / 2;
+		if (this->compensateTemperature(middle_) < temperature_) {
+			low_ = middle_ + 1;
+		}
+		else {
+			high_ = middle_;
+		}
+	}
+	return low_;
+}
+
+// The pressure falls with a rising ADC value
+int32_t SimBME280::rawPressure(double pressure_, int32_t adcT_) const {
+	int32_t low_ = 0;
+	int32_t high_ = 0xFFFFF;
+	while (low_ < high_) {
+		int32_t middle_ = (low_ + high_) / 2;
+		if (this->compensatePressure(middle_, adcT_) > pressure_) {
+			low_ = middle_ + 1;
+		}
+		else {
+			high_ = middle_;
+		}
+	}
+	return low_;
+}
+
+int32_t SimBME280::rawHumidity(double humidity_, int32_t adcT_) const {
+	int32_t low_ = 0;
+	int32_t high_ = 0xFFFF;
+	while (low_ < high_) {
+		int32_t middle_ = (low_ + high_) / 2;
+		if (this->compensateHumidity(middle_, adcT_) < humidity_) {
+			low_ = middle_ + 1;
+		}
+		else {
+			high_ = middle_;
+		}
+	}
+	return low_;
+}
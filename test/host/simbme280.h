@@ -0,0 +1,106 @@
+// simbme280.h
+
+#pragma once
+
+#ifndef _SIMBME280_h
+#define _SIMBME280_h
+
+#include <stdint.h>
+#include <functional>
+
+#include "Wire.h"
+
+// Register map of a BME280 on the simulated I2C bus. Forced and normal mode
+// convert with the maximum measurement time of the datasheet (9.1), the data
+// registers change when a conversion ends. The values come from a script of
+// physical conditions over time, or fixed raw ADC values. The IIR filter is
+// not simulated.
+class SimBME280 : public HostI2CDevice {
+public:
+    // Trimming parameters as stored in the sensor
+    struct Calibration {
+        uint16_t T1; int16_t T2; int16_t T3;
+        uint16_t P1; int16_t P2; int16_t P3; int16_t P4; int16_t P5; int16_t P6; int16_t P7; int16_t P8; int16_t P9;
+        uint8_t H1; int16_t H2; uint8_t H3; int16_t H4; int16_t H5; int8_t H6;
+    };
+
+    // Temperature and pressure of the example in the BMP280 datasheet (3.12),
+    // humidity of a typical part
+    static const Calibration DatasheetCalibration;
+
+    struct Conditions {
+        double Temperature; // degree celsius
+        double Pressure;    // mBar
+        double Humidity;    // %RH
+    };
+
+    typedef std::function<Conditions(uint32_t now_)> tScript;
+
+    SimBME280();
+
+    void attach(TwoWire& wire_, uint8_t address_);
+
+    void setCalibration(const Calibration& calibration_);
+    void setConditions(double temperature_, double pressure_, double humidity_);
+    void setScript(tScript script_) { _script = script_; _useRaw = false; };
+    // The next conversions give these ADC values
+    void setRaw(int32_t adcT_, int32_t adcP_, int32_t adcH_);
+
+    bool transfer(const uint8_t* write_, size_t writeLen_, uint8_t* read_, size_t readLen_) override;
+
+    uint8_t reg(uint8_t address_) const { return _registers[address_]; };
+
+    uint32_t conversions() const { return _conversions; };
+    // Data reads that got no new conversion: in forced mode while converting
+    // or without a trigger since the last read
+    uint32_t staleReads() const { return _staleReads; };
+    uint32_t dataReads() const { return _dataReads; };
+    // Of the last data read: us from the trigger to the read, and how old
+    // the conversion was (us from its end)
+    uint32_t lastTriggerToRead() const { return _lastTriggerToRead; };
+    uint32_t lastReadAge() const { return _lastReadAge; };
+
+    // t_measure,max in us for the oversampling codes (0 skips the channel)
+    static uint32_t measurementTime(uint8_t osrsT_, uint8_t osrsP_, uint8_t osrsH_);
+    static uint32_t standbyTime(uint8_t tsb_);
+
+    // Raw values that give the conditions, found by bisection on the
+    // floating point compensation of the datasheet (8.1)
+    int32_t rawTemperature(double temperature_) const;
+    int32_t rawPressure(double pressure_, int32_t adcT_) const;
+    int32_t rawHumidity(double humidity_, int32_t adcT_) const;
+
+    double compensateTemperature(int32_t adcT_) const;
+    double compensatePressure(int32_t adcP_, int32_t adcT_) const;  // mBar
+    double compensateHumidity(int32_t adcH_, int32_t adcT_) const;
+
+private:
+    void reset();
+    void write(uint8_t address_, uint8_t value_);
+    void update(uint64_t now_);
+    void startConversion(uint64_t now_);
+    void latch(uint64_t end_);
+    double tFine(int32_t adcT_) const;
+    uint32_t cycleTime() const;
+
+    uint8_t _registers[256];
+    uint8_t _pointer;
+
+    Calibration _calibration;
+    tScript _script;
+    bool _useRaw;
+    int32_t _raw[3];
+
+    bool _converting;
+    bool _fresh;
+    uint64_t _triggerTime;
+    uint64_t _conversionEnd;
+    uint64_t _lastEnd;
+    uint32_t _conversions;
+    uint32_t _staleReads;
+    uint32_t _dataReads;
+    uint32_t _lastTriggerToRead;
+    uint32_t _lastReadAge;
+};
+
+#endif
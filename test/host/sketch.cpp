@@ -0,0 +1,16 @@
+//
+//
+//
+
+// The sketch as the Arduino builder compiles it: the functions that are used
+// before their definition get a prototype, then the .ino is included.
+
+#include "Arduino.h"
+
+void loop2(void* parameter);
+void TriggerJob();
+void SlotJob();
+void StatisticsJob();
+void AlertJob();
+
+#include "../../src/NMEA2000-BME280.ino"
@@ -0,0 +1,91 @@
+// test_bme280burst.cpp
+
+// The burst read against the per-channel reads of the driver on a simulated sensor
+
+#include <gtest/gtest.h>
+
+#include "bme280burst.h"
+#include "simbme280.h"
+
+class BME280BurstTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sensor_.attach(bus_, BME280_ADDRESS_ALTERNATE);
+        ASSERT_TRUE(bme_.begin(BME280_ADDRESS_ALTERNATE, &bus_));
+        bme_.setProfile(BME280GetProfile(ProfileWeatherStation));
+    }
+
+    // One forced conversion of the conditions, done when this returns
+    void convert(double temperature_, double pressure_, double humidity_) {
+        sensor_.setConditions(temperature_, pressure_, humidity_);
+        bme_.trigger();
+        HostClock::advance(10);
+        bus_.resetCounters();
+    }
+
+    TwoWire bus_{ 0 };
+    SimBME280 sensor_;
+    BME280Burst bme_;
+};
+
+TEST_F(BME280BurstTest, ReadsASampleInOneTransaction) {
+    convert(18.25, 1002.4, 63.0);
+
+    BME280Sample sample_;
+    ASSERT_TRUE(bme_.readSample(sample_));
+    uint32_t burstTransactions_ = bus_.transactions();
+    uint32_t burstTime_ = bus_.busTime();
+
+    bus_.resetCounters();
+    bme_.readTemperature();
+    bme_.readPressure();
+    bme_.readHumidity();
+
+    EXPECT_EQ(burstTransactions_, 1u);
+    // temperature once per channel, pressure and humidity
+    EXPECT_EQ(bus_.transactions(), 5u);
+    EXPECT_LT(burstTime_ * 2, bus_.busTime());
+    printf("I2C per sample: burst %lu us, per channel %lu us\n", (unsigned long)burstTime_, (unsigned long)bus_.busTime());
+}
+
+TEST_F(BME280BurstTest, MatchesThePerChannelReads) {
+    const double conditions_[][3] = {
+        { -20.0, 950.0, 10.0 },
+        { 0.0, 980.5, 35.0 },
+        { 18.25, 1002.4, 63.0 },
+        { 25.0, 1013.25, 50.0 },
+        { 42.5, 1040.0, 95.0 },
+    };
+
+    for (const double* c_ : conditions_) {
+        convert(c_[0], c_[1], c_[2]);
+
+        BME280Sample sample_;
+        ASSERT_TRUE(bme_.readSample(sample_));
+
+        // The same conversion, the sensor converts again only after a trigger
+        EXPECT_FLOAT_EQ((float)sample_.temperature, bme_.readTemperature());
+        EXPECT_NEAR(sample_.pressure, bme_.readPressure() / 100.0, 1e-4);
+        EXPECT_FLOAT_EQ((float)sample_.humidity, bme_.readHumidity());
+
+        EXPECT_NEAR(sample_.temperature, c_[0], 0.02);
+        EXPECT_NEAR(sample_.pressure, c_[1], 0.02);
+        EXPECT_NEAR(sample_.humidity, c_[2], 0.05);
+    }
+}
+
+TEST_F(BME280BurstTest, ReadsEachConversionOnce) {
+    BME280Sample sample_;
+
+    for (int i = 0; i < 10; i++) {
+        convert(20.0 + i, 1000.0, 50.0);
+        ASSERT_TRUE(bme_.readSample(sample_));
+    }
+    EXPECT_EQ(sensor_.staleReads(), 0u);
+
+    // the driver reads the temperature of the conversion three times
+    bme_.readTemperature();
+    bme_.readPressure();
+    bme_.readHumidity();
+    EXPECT_EQ(sensor_.staleReads(), 5u);
+}
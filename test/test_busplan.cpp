@@ -0,0 +1,201 @@
+// test_busplan.cpp
+
+// The frames the sketch puts on the bus per slot, against sending all
+// messages of an epoch at once as before the bus plan, and the slots after
+// the loop was late
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <tuple>
+
+#include "hostsketch.h"
+#include "hostcan.h"
+#include "ESPAsyncWebServer.h"
+#include "busplanner.h"
+#include "n2kalert.h"
+#include "n2kstats.h"
+#include "n2ktemplates.h"
+#include "scheduler.h"
+#include "common.h"
+
+static const uint32_t EpochPeriod = 500;
+static const uint32_t SlotLength = 20;
+static const uint8_t BusBudget = 4;
+
+// Deadband 0, so every epoch sends all its messages
+static void sendEveryEpoch() {
+    AsyncWebServerRequest request_(HTTP_POST, "/config");
+    request_.addArg("transmitconfig-dbtemperature", "0");
+    request_.addArg("transmitconfig-dbhumidity", "0");
+    request_.addArg("transmitconfig-dbpressure", "0");
+    // A form without the checkbox unchecks it
+    request_.addArg("weatherconfig-stormalert", "selected");
+    ASSERT_TRUE(AsyncWebServer::instance()->handle(request_));
+    ASSERT_EQ(request_.response()->code(), 200);
+}
+
+// Most frames that left in one slot of the bus, and the most frames of
+// one epoch, which all went at once before the plan
+static void bursts(uint32_t& slot_, uint32_t& epoch_) {
+    std::map<uint64_t, uint32_t> slots_;
+    std::map<uint64_t, uint32_t> epochs_;
+    for (const HostCanMessage& message_ : gHostCan.messages()) {
+        uint64_t queued_ = message_.Queued / 1000;
+        slots_[queued_ / SlotLength] += message_.Frames;
+        epochs_[queued_ / EpochPeriod] += message_.Frames;
+    }
+
+    slot_ = 0;
+    epoch_ = 0;
+    for (const auto& slot : slots_) {
+        slot_ = std::max(slot_, slot.second);
+    }
+    for (const auto& epoch : epochs_) {
+        epoch_ = std::max(epoch_, epoch.second);
+    }
+}
+
+TEST(BusPlan, AlertIsAloneInItsSlot) {
+    // 28 bytes are a fast packet of 5 frames, one more than the budget
+    EXPECT_EQ(N2kStatistics::frameCount(N2kAlertDataLen), 5u);
+
+    BusPlanner planner_;
+    for (int i = 0; i < 8; i++) {
+        planner_.add(EpochPeriod, 1);
+    }
+    int8_t alert_ = planner_.add(10000, N2kStatistics::frameCount(N2kAlertDataLen));
+    EXPECT_TRUE(planner_.plan(SlotLength, BusBudget));
+    EXPECT_EQ(planner_.peak(), 5);
+
+    // The measurements fill slots 0 and 1, the alert gets the next empty one
+    EXPECT_EQ(planner_.slot(alert_), 2);
+}
+
+TEST(BusPlan, BurstBeforeAndAfter) {
+    HostSketch::boot();
+    sendEveryEpoch();
+    for (uint8_t i = 0; i < HostSketch::SensorSlots; i++) {
+        HostSketch::sensor(i).setConditions(20.0, 1010.0, 50.0);
+    }
+    HostSketch::run(2000);
+    gHostCan.clearSent();
+
+    HostSketch::run(60000);
+
+    uint32_t slot_ = 0;
+    uint32_t epoch_ = 0;
+    bursts(slot_, epoch_);
+    printf("%d sensors, %zu messages: at once %lu frames, planned %lu frames per %lu ms slot\n",
+        SENSOR_COUNT, gHostCan.messages().size(), (unsigned long)epoch_, (unsigned long)slot_, (unsigned long)SlotLength);
+
+    EXPECT_GT(epoch_, (uint32_t)BusBudget);
+    EXPECT_LE(slot_, (uint32_t)BusBudget);
+    EXPECT_EQ(gHostCan.rejected(), 0u);
+}
+
+extern DeadlineScheduler Scheduler;
+
+// The slot of a message in its epoch, the epochs count from the start of the scheduler
+static uint32_t slotOf(const HostCanMessage& message_) {
+    uint32_t phase_ = (uint32_t)(message_.Queued / 1000 - Scheduler.startTime()) % EpochPeriod;
+    return phase_ / SlotLength;
+}
+
+// The slots of every message (PGN, source address and N2k source) in its epoch
+typedef std::map<std::tuple<uint32_t, uint8_t, uint8_t>, std::set<uint32_t>> tMessageSlots;
+
+static tMessageSlots slotsOfMessages() {
+    tMessageSlots slots_;
+    for (const HostCanMessage& message_ : gHostCan.messages()) {
+        slots_[std::make_tuple(message_.Msg.PGN, message_.Source, message_.Msg.Data[2])].insert(slotOf(message_));
+    }
+    return slots_;
+}
+
+TEST(BusPlan, LateLoopKeepsTheSlots) {
+    HostSketch::boot();
+    sendEveryEpoch();
+    HostSketch::run(2000);
+    gHostCan.clearSent();
+    HostSketch::run(5000);
+    tMessageSlots planned_ = slotsOfMessages();
+
+    // Stalls over several slots at changing points of the epoch
+    for (int i = 0; i < 20; i++) {
+        HostSketch::run(1000 + 37 * i);
+        HostClock::advance(45 + 11 * i);
+        HostSketch::run(1);
+    }
+    HostSketch::run(2000);
+    gHostCan.clearSent();
+    HostSketch::run(5000);
+    tMessageSlots after_ = slotsOfMessages();
+
+    for (const auto& message_ : planned_) {
+        EXPECT_EQ(message_.second.size(), 1u) << "PGN " << std::get<0>(message_.first) << " from " << (int)std::get<1>(message_.first);
+    }
+    EXPECT_EQ(after_, planned_);
+}
+
+extern bool StormAlertActive;
+
+// Every epoch message of every sensor and the repeated storm alert get a
+// slot in the plan: each message is sent in one slot, no slot carries more
+// than the budget, and the alert is alone in its slot
+TEST(BusPlan, EveryMessageHasASlot) {
+    const uint32_t AlertPgn = 126983;
+
+    HostSketch::boot();
+    sendEveryEpoch();
+    // Pressure falls 6 mBar per hour until the storm warning is raised
+    for (uint32_t minute_ = 0; minute_ < 240 && !StormAlertActive; minute_++) {
+        for (uint8_t i = 0; i < HostSketch::SensorSlots; i++) {
+            HostSketch::sensor(i).setConditions(20.0, 1010.0 - 0.1 * minute_, 50.0);
+        }
+        HostSketch::run(60000);
+    }
+    ASSERT_TRUE(StormAlertActive);
+    // The change of the warning is sent at once, only the repetitions follow the plan
+    HostSketch::run(2000);
+    gHostCan.clearSent();
+    HostSketch::run(30000);
+    ASSERT_TRUE(StormAlertActive);
+
+    tMessageSlots slots_ = slotsOfMessages();
+    std::set<uint32_t> alertSlots_;
+    size_t measurements_ = 0;
+    for (const auto& message_ : slots_) {
+        EXPECT_EQ(message_.second.size(), 1u) << "PGN " << std::get<0>(message_.first) << " from " << (int)std::get<1>(message_.first);
+        if (std::get<0>(message_.first) == AlertPgn) {
+            alertSlots_.insert(message_.second.begin(), message_.second.end());
+        }
+        else {
+            measurements_++;
+        }
+    }
+    printf("%d sensors: %zu messages per epoch, alert in slot %lu\n", SENSOR_COUNT, measurements_,
+        alertSlots_.empty() ? 0ul : (unsigned long)*alertSlots_.begin());
+    EXPECT_EQ(measurements_, (size_t)SENSOR_COUNT * TemplateCount);
+    ASSERT_EQ(alertSlots_.size(), 1u);
+    uint32_t alertSlot_ = *alertSlots_.begin();
+    EXPECT_NE(alertSlot_, 0u);
+
+    // Frames per slot of every epoch, and what else went in the slot of the alert
+    std::map<uint64_t, uint32_t> frames_;
+    size_t alerts_ = 0;
+    for (const HostCanMessage& message_ : gHostCan.messages()) {
+        if (message_.Msg.PGN == AlertPgn) {
+            alerts_++;
+            continue;
+        }
+        frames_[message_.Queued / 1000 / SlotLength] += message_.Frames;
+        EXPECT_NE(slotOf(message_), alertSlot_) << "PGN " << message_.Msg.PGN << " in the slot of the alert";
+    }
+    EXPECT_GE(alerts_, 2u);
+    for (const auto& slot_ : frames_) {
+        EXPECT_LE(slot_.second, (uint32_t)BusBudget) << "slot " << slot_.first;
+    }
+}
@@ -0,0 +1,117 @@
+// test_canrx.cpp
+
+// Frames of other nodes arriving at the sketch: woken by the RX edge or polling
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "hostsketch.h"
+#include "hostcan.h"
+#include "hostclock.h"
+
+extern bool gCanRxNotification;
+
+struct RxResult {
+    uint32_t Frames;
+    uint32_t Received;
+    uint32_t Overruns;
+    uint32_t Worst;  // us
+    double Mean;     // us
+    double Rate;     // frames/s parsed in simulated time
+    double Host;     // frames/s the host build gets through
+};
+
+// frames_ frames with random gaps that average 1e6 / rate_ us, a stall_ ms
+// stall of the task every second
+static RxResult receive(uint32_t rate_, uint32_t frames_, uint32_t stall_ = 0) {
+    HostSketch::boot();
+
+    size_t first_ = gHostCan.latencies().size();
+    uint32_t received_ = gHostCan.received();
+    uint32_t overruns_ = gHostCan.overruns();
+    uint64_t start_ = HostClock::now();
+    uint64_t time_ = start_;
+
+    srand(rate_);
+    for (uint32_t i = 0; i < frames_; i++) {
+        time_ += 1 + rand() % (2000000 / rate_);
+        gHostCan.inject(time_, 127250L, 35);
+    }
+
+    auto wallStart_ = std::chrono::steady_clock::now();
+    uint64_t nextStall_ = start_ + 1000000;
+    while (HostClock::now() < time_ + 100000) {
+        if (stall_ > 0 && HostClock::now() >= nextStall_) {
+            HostClock::advance(stall_);
+            nextStall_ += 1000000;
+        }
+        HostSketch::step();
+    }
+
+    double wall_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart_).count();
+
+    RxResult result_ = {};
+    const std::vector<uint32_t>& latencies_ = gHostCan.latencies();
+    result_.Frames = frames_;
+    result_.Received = gHostCan.received() - received_;
+    result_.Overruns = gHostCan.overruns() - overruns_;
+    uint64_t sum_ = 0;
+    for (size_t i = first_; i < latencies_.size(); i++) {
+        result_.Worst = std::max(result_.Worst, latencies_[i]);
+        sum_ += latencies_[i];
+    }
+    result_.Mean = result_.Received > 0 ? (double)sum_ / result_.Received : 0;
+    result_.Rate = result_.Received / ((time_ - start_) / 1e6);
+    result_.Host = result_.Received / wall_;
+    return result_;
+}
+
+static void print(const char* name_, const RxResult& result_) {
+    printf("%s: %.0f frames/s (host %.0f), worst RX-to-parse %lu us, mean %.0f us, %lu overruns\n", name_,
+        result_.Rate, result_.Host, (unsigned long)result_.Worst, result_.Mean, (unsigned long)result_.Overruns);
+}
+
+TEST(CanRx, ParsesAtTheEdge) {
+    HostSketch::boot();
+    ASSERT_TRUE(gCanRxNotification);
+
+    RxResult result_ = receive(1000, 10000);
+    print("notified, 1000 frames/s", result_);
+
+    EXPECT_EQ(result_.Received, result_.Frames);
+    EXPECT_EQ(result_.Overruns, 0u);
+    EXPECT_EQ(result_.Worst, 0u);
+}
+
+TEST(CanRx, PollingWaitsUpToThePollInterval) {
+    HostSketch::boot();
+    gCanRxNotification = false;
+    RxResult result_ = receive(1000, 10000);
+    gCanRxNotification = true;
+    print("polled, 1000 frames/s", result_);
+
+    EXPECT_EQ(result_.Received, result_.Frames);
+    EXPECT_LE(result_.Worst, 10000u);
+    EXPECT_GT(result_.Mean, 1000.0);
+}
+
+TEST(CanRx, StallsDelayButDoNotLoseFrames) {
+    RxResult result_ = receive(2000, 20000, 20);
+    print("notified, 2000 frames/s, 20 ms stall per s", result_);
+
+    EXPECT_EQ(result_.Received, result_.Frames);
+    EXPECT_EQ(result_.Overruns, 0u);
+    EXPECT_LE(result_.Worst, 20000u);
+}
+
+TEST(CanRx, LongStallOverrunsTheReceiveBuffer) {
+    // 150 frames of buffer last 75 ms at 2000 frames/s
+    RxResult result_ = receive(2000, 4000, 100);
+    print("notified, 2000 frames/s, 100 ms stall per s", result_);
+
+    EXPECT_GT(result_.Overruns, 0u);
+    EXPECT_EQ(result_.Received + result_.Overruns, result_.Frames);
+}
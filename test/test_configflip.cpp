@@ -0,0 +1,105 @@
+// test_configflip.cpp
+
+// Flips between two configurations on /config while the sketch sends: every
+// message has to carry the instance and the source of one of them, never a mix
+
+#include <gtest/gtest.h>
+
+#include "hostsketch.h"
+#include "hostcan.h"
+#include "ESPAsyncWebServer.h"
+#include "N2kMessages.h"
+
+struct FlipConfig {
+    uint8_t Instance;
+    tN2kTempSource TempSource;
+    uint8_t HumiditySource; // value of the select list, sent as it is
+};
+
+// The values of the select lists in webhandling.h
+static const FlipConfig Configs[2] = {
+    { 10, N2kts_MainCabinTemperature, 1 },
+    { 40, N2kts_OutsideTemperature, 2 }
+};
+
+static void postConfig(const FlipConfig& config_) {
+    AsyncWebServerRequest request_(HTTP_POST, "/config");
+    request_.addArg("nmeaconfig-instance", String((unsigned int)config_.Instance));
+    request_.addArg("TempSource", String((unsigned int)config_.TempSource));
+    request_.addArg("HumiditySource", String((unsigned int)config_.HumiditySource));
+    // Every epoch sends, so each flip shows on the bus at once
+    request_.addArg("transmitconfig-dbtemperature", "0");
+    request_.addArg("transmitconfig-dbhumidity", "0");
+    request_.addArg("transmitconfig-dbpressure", "0");
+    ASSERT_TRUE(AsyncWebServer::instance()->handle(request_));
+    ASSERT_EQ(request_.response()->code(), 200);
+}
+
+// The configuration a message belongs to, -1 for none or a mix
+static int configOf(const tN2kMsg& msg_) {
+    uint8_t instance_ = msg_.Data[1];
+    uint8_t source_ = msg_.Data[2];
+
+    for (int i = 0; i < 2; i++) {
+        const FlipConfig& config_ = Configs[i];
+        switch (msg_.PGN) {
+        case 130312L:
+        case 130316L:
+            if ((instance_ == config_.Instance && source_ == config_.TempSource) ||
+                (instance_ == config_.Instance + 3 && source_ == N2kts_HeatIndexTemperature) ||
+                (instance_ == config_.Instance + 4 && source_ == N2kts_DewPointTemperature)) {
+                return i;
+            }
+            break;
+        case 130313L:
+            if (instance_ == config_.Instance + 1 && source_ == config_.HumiditySource) {
+                return i;
+            }
+            break;
+        case 130314L:
+            if (instance_ == config_.Instance + 2) {
+                return i;
+            }
+            break;
+        }
+    }
+    return -1;
+}
+
+TEST(ConfigFlip, EveryMessageMatchesOneConfiguration) {
+    HostSketch::boot();
+    postConfig(Configs[0]);
+    HostSketch::run(2000);
+    gHostCan.clearSent();
+
+    // Flip at changing points of the epoch and the slots
+    uint32_t flips_ = 0;
+    for (uint32_t ms_ = 0; ms_ < 60000; flips_++) {
+        postConfig(Configs[flips_ % 2 == 0 ? 1 : 0]);
+        uint32_t hold_ = 37 + (flips_ * 53) % 611;
+        HostSketch::run(hold_);
+        ms_ += hold_;
+    }
+
+    uint32_t counts_[2] = { 0, 0 };
+    uint32_t mixed_ = 0;
+    for (const HostCanMessage& message_ : gHostCan.messages()) {
+        if (message_.Msg.PGN < 130312L || message_.Msg.PGN > 130316L) {
+            continue;
+        }
+        int config_ = configOf(message_.Msg);
+        if (config_ < 0) {
+            mixed_++;
+            ADD_FAILURE() << "PGN " << message_.Msg.PGN << " instance " << (int)message_.Msg.Data[1] << " source " << (int)message_.Msg.Data[2];
+            continue;
+        }
+        counts_[config_]++;
+    }
+
+    printf("%lu flips in 60 s: %lu messages of the first, %lu of the second configuration, %lu mixed\n",
+        (unsigned long)flips_, (unsigned long)counts_[0], (unsigned long)counts_[1], (unsigned long)mixed_);
+
+    EXPECT_EQ(mixed_, 0u);
+    EXPECT_GT(counts_[0], 100u);
+    EXPECT_GT(counts_[1], 100u);
+}
@@ -0,0 +1,249 @@
+// test_data.cpp
+
+// /data of the booted sketch: its ETag across boots and the JSON body
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "hostsketch.h"
+#include "common.h"
+#include "ESPAsyncWebServer.h"
+#include "version.h"
+
+size_t renderDataJson(char* buffer_, size_t size_, const SensorData& data_);
+
+// Validating JSON parser, counts the numbers and nulls
+class JsonChecker {
+public:
+    explicit JsonChecker(const std::string& text_) : _text(text_), _pos(0) {}
+
+    bool valid() {
+        return this->value() && this->_pos == this->_text.size();
+    }
+
+    size_t Numbers = 0;
+    size_t Nulls = 0;
+
+private:
+    bool value() {
+        if (this->_pos >= this->_text.size()) {
+            return false;
+        }
+        char c_ = this->_text[this->_pos];
+        if (c_ == '{') {
+            return this->container('}', true);
+        }
+        if (c_ == '[') {
+            return this->container(']', false);
+        }
+        if (c_ == '"') {
+            return this->string();
+        }
+        if (this->literal("true") || this->literal("false")) {
+            return true;
+        }
+        if (this->literal("null")) {
+            this->Nulls++;
+            return true;
+        }
+        return this->number();
+    }
+
+    bool container(char end_, bool object_) {
+        this->_pos++;
+        if (this->peek(end_)) {
+            this->_pos++;
+            return true;
+        }
+        for (;;) {
+            if (object_ && !(this->string() && this->expect(':'))) {
+                return false;
+            }
+            if (!this->value()) {
+                return false;
+            }
+            if (this->peek(end_)) {
+                this->_pos++;
+                return true;
+            }
+            if (!this->expect(',')) {
+                return false;
+            }
+        }
+    }
+
+    bool string() {
+        if (!this->expect('"')) {
+            return false;
+        }
+        size_t end_ = this->_text.find('"', this->_pos);
+        if (end_ == std::string::npos) {
+            return false;
+        }
+        this->_pos = end_ + 1;
+        return true;
+    }
+
+    bool number() {
+        const char* start_ = this->_text.c_str() + this->_pos;
+        char* end_ = nullptr;
+        strtod(start_, &end_);
+        if (end_ == start_) {
+            return false;
+        }
+        this->_pos += end_ - start_;
+        this->Numbers++;
+        return true;
+    }
+
+    bool literal(const char* word_) {
+        size_t length_ = strlen(word_);
+        if (this->_text.compare(this->_pos, length_, word_) != 0) {
+            return false;
+        }
+        this->_pos += length_;
+        return true;
+    }
+
+    bool peek(char c_) const { return this->_pos < this->_text.size() && this->_text[this->_pos] == c_; }
+    bool expect(char c_) {
+        if (!this->peek(c_)) {
+            return false;
+        }
+        this->_pos++;
+        return true;
+    }
+
+    const std::string& _text;
+    size_t _pos;
+};
+
+struct DataResult {
+    int Code;
+    std::string ETag;
+    std::string Body;
+};
+
+static DataResult get(const char* url_, const std::string& match_ = "") {
+    DataResult result_ = {};
+    AsyncWebServerRequest request_(HTTP_GET, url_);
+    if (!match_.empty()) {
+        request_.addHeader("If-None-Match", match_.c_str());
+    }
+    AsyncWebServer::instance()->handle(request_);
+    AsyncWebServerResponse* response_ = request_.response();
+    response_->drain(&result_.Body);
+    result_.Code = response_->code();
+    if (response_->header("ETag") != nullptr) {
+        result_.ETag = response_->header("ETag")->c_str();
+    }
+    return result_;
+}
+
+TEST(Data, ETagHoldsVersionAndBootNonce) {
+    HostSketch::run(1000);
+
+    DataResult data_ = get("/data");
+    ASSERT_EQ(data_.Code, 200);
+    // "<version>-<8 hex digits>-<sequence>" in quotes, the nonce of the root page
+    ASSERT_GE(data_.ETag.size(), sizeof(VERSION) + 12);
+    EXPECT_EQ(data_.ETag.compare(0, sizeof(VERSION), "\"" VERSION), 0) << data_.ETag;
+    std::string nonce_ = data_.ETag.substr(sizeof(VERSION) + 1, 8);
+    EXPECT_EQ(nonce_.find_first_not_of("0123456789abcdef"), std::string::npos) << data_.ETag;
+    EXPECT_EQ(get("/").ETag.substr(0, sizeof(VERSION) + 10), data_.ETag.substr(0, sizeof(VERSION) + 10));
+
+    // The same measurement, the same tag
+    EXPECT_EQ(get("/data").ETag, data_.ETag);
+    EXPECT_EQ(get("/data", data_.ETag).Code, 304);
+
+    // The tag of the same sequence number in an earlier boot
+    std::string sequence_ = data_.ETag.substr(sizeof(VERSION) + 10);
+    EXPECT_EQ(get("/data", "\"" + sequence_).Code, 200);
+    std::string before_ = data_.ETag;
+    before_[sizeof(VERSION) + 1] = before_[sizeof(VERSION) + 1] == '0' ? '1' : '0';
+    EXPECT_EQ(get("/data", before_).Code, 200);
+
+    // A new measurement, a new tag
+    HostSketch::run(1000);
+    EXPECT_NE(get("/data").ETag, data_.ETag);
+    EXPECT_EQ(get("/data", data_.ETag).Code, 200);
+}
+
+// Every value at the widest number that is still sent
+static SensorData widestData() {
+    SensorData data_ = {};
+    data_.temperature = -999999.99;
+    data_.humidity = -999999.99;
+    data_.pressure = -999999.99;
+    data_.dewPoint = -999999.99;
+    data_.heatIndex = -999999.99;
+    data_.tendency1h = -999999.99;
+    data_.tendency3h = -999999.99;
+    data_.tendency = TendencyRapidlyFalling;
+    data_.storm = false;
+    return data_;
+}
+
+static void publishStatistics(float value_) {
+    StatisticsData statistics_;
+    for (uint8_t i = 0; i < ChannelCount; i++) {
+        for (uint8_t j = 0; j < WindowCount; j++) {
+            statistics_.Windows[i][j] = { value_, value_, value_, value_, 1000 };
+        }
+    }
+    gStatistics.publish(statistics_);
+}
+
+TEST(Data, WidestBodyFitsAndParses) {
+    HostSketch::boot();
+    publishStatistics(-999999.8f); // as a float -999999.99 rounds to -1e6, which is sent as null
+
+    char buffer_[4096];
+    size_t length_ = renderDataJson(buffer_, sizeof(buffer_), widestData());
+    std::string body_(buffer_, length_);
+    printf("widest /data body %zu bytes\n", length_);
+
+    ASSERT_GT(length_, 0u);
+    // The sketch renders it into its own buffer and sends all of it
+    gSensorData.publish(widestData());
+    DataResult data_ = get("/data");
+    ASSERT_EQ(data_.Code, 200);
+    EXPECT_EQ(data_.Body, body_);
+
+    JsonChecker checker_(body_);
+    EXPECT_TRUE(checker_.valid()) << body_;
+    // rssi, seven values and four per channel and window
+    EXPECT_EQ(checker_.Numbers, 1u + 7 + 4 * ChannelCount * WindowCount);
+    EXPECT_EQ(checker_.Nulls, 0u);
+}
+
+TEST(Data, ValuesOutOfRangeAreNull) {
+    HostSketch::boot();
+    publishStatistics(NAN);
+
+    SensorData data_ = widestData();
+    data_.temperature = 1e300;
+    data_.humidity = -1e300;
+    data_.pressure = INFINITY;
+    data_.dewPoint = NAN;
+    data_.heatIndex = 1000000.0;
+
+    char buffer_[4096];
+    size_t length_ = renderDataJson(buffer_, sizeof(buffer_), data_);
+    std::string body_(buffer_, length_);
+    JsonChecker checker_(body_);
+    EXPECT_TRUE(checker_.valid()) << body_;
+    EXPECT_EQ(checker_.Nulls, 5u + 4 * ChannelCount * WindowCount);
+}
+
+TEST(Data, TooSmallBufferIsNotSent) {
+    HostSketch::boot();
+    publishStatistics(1.0f);
+
+    char buffer_[256];
+    EXPECT_EQ(renderDataJson(buffer_, sizeof(buffer_), widestData()), 0u);
+}
@@ -0,0 +1,76 @@
+// test_derived.cpp
+
+// Largest error of the single precision dew point, heat index and
+// logarithm against the double versions over the range of the sensor
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include "derived.h"
+
+struct Sweep {
+    double Error;       // largest absolute error
+    double Temperature; // where it is
+    double Humidity;
+};
+
+// -40..85 degree celsius and 1..100 %RH in steps of 0.01 degree and 0.05 %RH
+template <typename TFast, typename TReference>
+static Sweep sweep(TFast fast_, TReference reference_) {
+    Sweep worst_ = { 0, 0, 0 };
+    for (int t = -4000; t <= 8500; t++) {
+        for (int h = 20; h <= 2000; h++) {
+            float temperature_ = t / 100.0f;
+            float humidity_ = h / 20.0f;
+            double error_ = fabs(fast_(temperature_, humidity_) - reference_(temperature_, humidity_));
+            if (error_ > worst_.Error) {
+                worst_ = { error_, temperature_, humidity_ };
+            }
+        }
+    }
+    return worst_;
+}
+
+TEST(DerivedTest, DewPointFastAgainstDouble) {
+    Sweep worst_ = sweep(dewPointFast, dewPoint);
+    printf("dew point: largest error %.2e degree at %.2f degree, %.2f %%RH\n", worst_.Error, worst_.Temperature, worst_.Humidity);
+    EXPECT_LT(worst_.Error, 3e-5);
+}
+
+TEST(DerivedTest, HeatIndexFastAgainstDouble) {
+    Sweep worst_ = sweep(heatIndexCelsiusFast, heatIndexCelsius);
+    printf("heat index: largest error %.2e degree at %.2f degree, %.2f %%RH\n", worst_.Error, worst_.Temperature, worst_.Humidity);
+    EXPECT_LT(worst_.Error, 4e-4);
+}
+
+TEST(DerivedTest, FastLogAgainstLog) {
+    double worst_ = 0;
+    double at_ = 0;
+    // All floats between 1e-3 and 1e3 in steps of 64 ulp
+    for (float x = 1e-3f; x < 1e3f; x = nextafterf(x, INFINITY) + 64 * (nextafterf(x, INFINITY) - x)) {
+        double exact_ = log((double)x);
+        double error_ = fabs(fastLog(x) - exact_) / (fabs(exact_) > 1 ? fabs(exact_) : 1);
+        if (error_ > worst_) {
+            worst_ = error_;
+            at_ = x;
+        }
+    }
+    printf("fastLog: largest error %.2e at %g\n", worst_, at_);
+    EXPECT_LT(worst_, 2e-7);
+
+    EXPECT_EQ(fastLog(1.0f), 0.0f);
+    EXPECT_EQ(fastLog(0.0f), -INFINITY);
+    EXPECT_TRUE(isnan(fastLog(-1.0f)));
+    EXPECT_TRUE(isnan(fastLog(NAN)));
+    EXPECT_EQ(fastLog(INFINITY), INFINITY);
+}
+
+TEST(DerivedTest, SketchGetsTheFloatVersions) {
+#if defined(DERIVED_FLOAT)
+    EXPECT_EQ(calculateDewPoint(21.5, 48.0), (double)dewPointFast(21.5f, 48.0f));
+    EXPECT_EQ(calculateHeatIndex(30.0, 70.0), (double)heatIndexCelsiusFast(30.0f, 70.0f));
+#else
+    EXPECT_EQ(calculateDewPoint(21.5, 48.0), dewPoint(21.5, 48.0));
+#endif
+}
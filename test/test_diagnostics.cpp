@@ -0,0 +1,132 @@
+// test_diagnostics.cpp
+
+// The power of two buckets of the latency histogram and the percentiles at their edges
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include "diagnostics.h"
+
+TEST(LatencyHistogram, BucketOf) {
+    EXPECT_EQ(LatencyHistogram::bucketOf(0), 0);
+    EXPECT_EQ(LatencyHistogram::bucketOf(1), 1);
+    EXPECT_EQ(LatencyHistogram::bucketOf(2), 2);
+    EXPECT_EQ(LatencyHistogram::bucketOf(3), 2);
+    EXPECT_EQ(LatencyHistogram::bucketOf(4), 3);
+    EXPECT_EQ(LatencyHistogram::bucketOf(0x7FFFFFFF), 31);
+    EXPECT_EQ(LatencyHistogram::bucketOf(0x80000000), 32);
+    EXPECT_EQ(LatencyHistogram::bucketOf(0xFFFFFFFF), 32);
+
+    // Every power of two starts a bucket, the value before ends the previous one
+    for (uint8_t n = 1; n < 32; n++) {
+        uint32_t low_ = 1UL << n;
+        EXPECT_EQ(LatencyHistogram::bucketOf(low_), n + 1) << (int)n;
+        EXPECT_EQ(LatencyHistogram::bucketOf(low_ - 1), n) << (int)n;
+        EXPECT_EQ(LatencyHistogram::upperBound(n), low_ - 1) << (int)n;
+        EXPECT_EQ(LatencyHistogram::bucketOf(LatencyHistogram::upperBound(n)), n) << (int)n;
+    }
+    EXPECT_EQ(LatencyHistogram::upperBound(0), 0u);
+    EXPECT_EQ(LatencyHistogram::upperBound(32), 0xFFFFFFFFu);
+    EXPECT_TRUE(LatencyHistogram::bucketOf(0xFFFFFFFF) < LatencyHistogram::Buckets);
+}
+
+TEST(LatencyHistogram, RecordCountsAndMax) {
+    LatencyHistogram histogram_;
+    const uint32_t Values[] = { 0, 1, 5, 7, 8, 1000, 0xFFFFFFFF };
+    for (uint32_t value_ : Values) {
+        histogram_.record(value_);
+    }
+
+    EXPECT_EQ(histogram_.count(), 7u);
+    EXPECT_EQ(histogram_.max(), 0xFFFFFFFFu);
+    EXPECT_EQ(histogram_.bucket(0), 1u);
+    EXPECT_EQ(histogram_.bucket(1), 1u);
+    EXPECT_EQ(histogram_.bucket(3), 2u);
+    EXPECT_EQ(histogram_.bucket(4), 1u);
+    EXPECT_EQ(histogram_.bucket(10), 1u);
+    EXPECT_EQ(histogram_.bucket(32), 1u);
+
+    histogram_.reset();
+    EXPECT_EQ(histogram_.count(), 0u);
+    EXPECT_EQ(histogram_.max(), 0u);
+    for (uint8_t i = 0; i < LatencyHistogram::Buckets; i++) {
+        EXPECT_EQ(histogram_.bucket(i), 0u);
+    }
+}
+
+TEST(LatencyHistogram, PercentileOfNothingIsZero) {
+    LatencyHistogram histogram_;
+    EXPECT_EQ(histogram_.percentile(0.0), 0u);
+    EXPECT_EQ(histogram_.percentile(0.5), 0u);
+    EXPECT_EQ(histogram_.percentile(1.0), 0u);
+}
+
+TEST(LatencyHistogram, PercentileOfOneValue) {
+    LatencyHistogram histogram_;
+    histogram_.record(100);
+
+    // The bucket 64..127, capped at the maximum
+    EXPECT_EQ(histogram_.percentile(0.0), 100u);
+    EXPECT_EQ(histogram_.percentile(0.5), 100u);
+    EXPECT_EQ(histogram_.percentile(1.0), 100u);
+}
+
+TEST(LatencyHistogram, PercentileEdges) {
+    // 90 values of 10 (bucket 8..15), 9 of 100 (64..127), 1 of 5000 (4096..8191)
+    LatencyHistogram histogram_;
+    for (int i = 0; i < 90; i++) {
+        histogram_.record(10);
+    }
+    for (int i = 0; i < 9; i++) {
+        histogram_.record(100);
+    }
+    histogram_.record(5000);
+
+    // p 0 is the first value, the bound of its bucket
+    EXPECT_EQ(histogram_.percentile(0.0), 15u);
+    EXPECT_EQ(histogram_.percentile(0.5), 15u);
+    // The 90th value is the last one of the first bucket, the 91st the first of the next
+    EXPECT_EQ(histogram_.percentile(0.90), 15u);
+    EXPECT_EQ(histogram_.percentile(0.904), 15u); // 90.4 rounds to 90
+    EXPECT_EQ(histogram_.percentile(0.905), 127u); // 90.5 rounds to 91
+    EXPECT_EQ(histogram_.percentile(0.99), 127u);
+    // The last value is capped at the maximum, not at 8191
+    EXPECT_EQ(histogram_.percentile(0.995), 5000u);
+    EXPECT_EQ(histogram_.percentile(1.0), 5000u);
+
+    // Shares outside of 0..1 are clamped
+    EXPECT_EQ(histogram_.percentile(-1.0), 15u);
+    EXPECT_EQ(histogram_.percentile(2.0), 5000u);
+    EXPECT_EQ(histogram_.percentile(1e12), 5000u);
+}
+
+TEST(LatencyHistogram, PercentileOfZerosAndTheTopBucket) {
+    LatencyHistogram histogram_;
+    histogram_.record(0);
+    histogram_.record(0);
+    histogram_.record(0x80000000);
+
+    EXPECT_EQ(histogram_.percentile(0.0), 0u);
+    EXPECT_EQ(histogram_.percentile(0.5), 0u);
+    EXPECT_EQ(histogram_.percentile(0.67), 0u);
+    EXPECT_EQ(histogram_.percentile(0.84), 0x80000000u);
+    EXPECT_EQ(histogram_.percentile(1.0), 0x80000000u);
+}
+
+// The bucket bound is at most twice the value below it
+TEST(LatencyHistogram, PercentileIsWithinOneBucket) {
+    LatencyHistogram histogram_;
+    for (uint32_t i = 1; i <= 1000; i++) {
+        histogram_.record(i * 37);
+    }
+
+    const double Shares[] = { 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99 };
+    for (double p_ : Shares) {
+        uint32_t exact_ = (uint32_t)lround(p_ * 1000) * 37;
+        uint32_t percentile_ = histogram_.percentile(p_);
+        EXPECT_GE(percentile_, exact_) << p_;
+        EXPECT_LT(percentile_, 2 * exact_) << p_;
+        EXPECT_EQ(LatencyHistogram::bucketOf(percentile_), LatencyHistogram::bucketOf(exact_)) << p_;
+    }
+}
@@ -0,0 +1,112 @@
+// test_events.cpp
+
+// Measurements pushed to several /events clients: latency from the sample
+// to the event, and the cost of one push
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include "hostsketch.h"
+#include "hostclock.h"
+#include "ESPAsyncWebServer.h"
+#include "common.h"
+
+extern AsyncEventSource events;
+extern uint32_t EventSequence;
+void pushEvents();
+
+struct EventResult {
+    uint32_t Events;   // per client
+    uint32_t Worst;    // ms from the sample to the event
+    double Mean;       // ms
+    double Push;       // us of host time per push
+};
+
+static EventResult push(int clients_, uint32_t ms_) {
+    HostSketch::boot();
+    events.clear();
+
+    std::vector<int> ids_;
+    for (int i = 0; i < clients_; i++) {
+        ids_.push_back(events.connect());
+    }
+
+    // The sample time of every measurement the sketch publishes
+    std::map<uint32_t, uint32_t> samples_;
+    uint64_t end_ = HostClock::now() + (uint64_t)ms_ * 1000;
+    while (HostClock::now() < end_) {
+        HostSketch::step();
+        SensorData data_;
+        uint32_t sequence_ = gSensorData.read(data_);
+        samples_[sequence_] = data_.timestamp;
+    }
+
+    EventResult result_ = {};
+    const std::vector<AsyncEventSource::Event>& first_ = events.received(ids_[0]);
+    result_.Events = first_.size();
+
+    uint64_t sum_ = 0;
+    for (size_t i = 0; i < first_.size(); i++) {
+        // "id: <sequence>" is the first line of the event
+        uint32_t sequence_ = strtoul(first_[i].Text->c_str() + 4, nullptr, 10);
+        EXPECT_EQ(samples_.count(sequence_), 1u) << *first_[i].Text;
+        uint32_t latency_ = (uint32_t)(first_[i].Time / 1000) - samples_[sequence_];
+        result_.Worst = std::max(result_.Worst, latency_);
+        sum_ += latency_;
+
+        // Every client got the same event, formatted once
+        for (int id_ : ids_) {
+            EXPECT_EQ(events.received(id_)[i].Text.get(), first_[i].Text.get());
+        }
+    }
+    result_.Mean = first_.empty() ? 0 : (double)sum_ / first_.size();
+    EXPECT_EQ(events.formatted(), result_.Events);
+
+    // The push alone, as if a new measurement came every time
+    const int pushes_ = 2000;
+    auto start_ = std::chrono::steady_clock::now();
+    for (int i = 0; i < pushes_; i++) {
+        EventSequence = 0;
+        pushEvents();
+    }
+    result_.Push = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_).count() / pushes_;
+
+    events.clear();
+    return result_;
+}
+
+TEST(Events, LatencyAndCostByClients) {
+    for (int clients_ : { 1, 4, 8, 16 }) {
+        EventResult result_ = push(clients_, 30000);
+        printf("%2d clients: %lu events, latency mean %.1f ms worst %lu ms, %.2f us per push\n", clients_,
+            (unsigned long)result_.Events, result_.Mean, (unsigned long)result_.Worst, result_.Push);
+
+        // One event per epoch of 500 ms
+        EXPECT_NEAR(result_.Events, 60, 2);
+        // The push runs in wifiLoop(), every 100 ms, after the measurement
+        EXPECT_LE(result_.Worst, 100u + 50u);
+    }
+}
+
+TEST(Events, NothingIsRenderedWithoutClients) {
+    HostSketch::boot();
+    events.clear();
+    HostSketch::run(5000);
+    EXPECT_EQ(events.formatted(), 0u);
+
+    int id_ = events.connect();
+    HostSketch::run(1000);
+    EXPECT_GE(events.received(id_).size(), 1u);
+
+    // A client that left gets nothing more
+    events.disconnect(id_);
+    size_t received_ = events.received(id_).size();
+    HostSketch::run(2000);
+    EXPECT_EQ(events.received(id_).size(), received_);
+    EXPECT_EQ(events.count(), 0u);
+    events.clear();
+}
@@ -0,0 +1,129 @@
+// test_history.cpp
+
+// The 24 h ring buffer of History: minutes, gaps, quantization, the
+// wraparound of the buffer and of millis(), and its memory
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include "history.h"
+
+// One value every 500 ms for minutes_ minutes, the value of a minute is its number
+static void fill(History& history_, uint32_t minutes_, uint32_t start_ = 0) {
+    for (uint32_t i = 0; i < minutes_ * 120; i++) {
+        uint32_t minute_ = i / 120;
+        history_.add(20.0 + minute_ % 100 / 100.0, 50.0, 1000.0 + minute_ % 1000 / 10.0, start_ + i * 500);
+    }
+}
+
+TEST(HistoryTest, MeanOfEachMinute) {
+    History history_;
+    for (uint32_t t = 0; t < 120000; t += 500) {
+        double ramp_ = (t % 60000) / 60000.0;
+        history_.add(20.0 + ramp_, 40.0 + ramp_, 1010.0 + ramp_, t);
+    }
+    // The second minute is still running
+    history_.add(25.0, 50.0, 1020.0, 120000);
+    ASSERT_EQ(history_.end(), 2u);
+
+    HistoryEntry entry_;
+    ASSERT_TRUE(history_.get(0, entry_));
+    EXPECT_NEAR(History::temperature(entry_), 20.4958, 0.005);
+    EXPECT_NEAR(History::humidity(entry_), 40.4958, 0.005);
+    EXPECT_NEAR(History::pressure(entry_), 1010.5, 0.05);
+    EXPECT_FALSE(history_.get(2, entry_));
+}
+
+TEST(HistoryTest, GapsAndMissingValues) {
+    History history_;
+    history_.add(20.0, NAN, 1000.0, 0);
+    // Nothing for three minutes
+    history_.add(21.0, 45.0, NAN, 4 * History::Interval);
+    history_.add(21.0, 45.0, NAN, 5 * History::Interval);
+    ASSERT_EQ(history_.end(), 5u);
+
+    HistoryEntry entry_;
+    ASSERT_TRUE(history_.get(0, entry_));
+    EXPECT_DOUBLE_EQ(History::temperature(entry_), 20.0);
+    EXPECT_TRUE(isnan(History::humidity(entry_)));
+    EXPECT_DOUBLE_EQ(History::pressure(entry_), 1000.0);
+    for (uint32_t i = 1; i < 4; i++) {
+        ASSERT_TRUE(history_.get(i, entry_));
+        EXPECT_TRUE(isnan(History::temperature(entry_)));
+        EXPECT_TRUE(isnan(History::humidity(entry_)));
+        EXPECT_TRUE(isnan(History::pressure(entry_)));
+    }
+    ASSERT_TRUE(history_.get(4, entry_));
+    EXPECT_DOUBLE_EQ(History::humidity(entry_), 45.0);
+    EXPECT_TRUE(isnan(History::pressure(entry_)));
+}
+
+TEST(HistoryTest, LimitsOfTheFields) {
+    History history_;
+    history_.add(-400.0, -5.0, 100.0, 0);
+    history_.add(400.0, 700.0, 7000.0, History::Interval);
+    history_.add(0, 0, 0, 2 * History::Interval);
+
+    HistoryEntry low_;
+    HistoryEntry high_;
+    ASSERT_TRUE(history_.get(0, low_));
+    ASSERT_TRUE(history_.get(1, high_));
+    // Clamped, but never the marker of a missing value
+    EXPECT_DOUBLE_EQ(History::temperature(low_), -327.67);
+    EXPECT_DOUBLE_EQ(History::humidity(low_), 0.0);
+    EXPECT_DOUBLE_EQ(History::pressure(low_), HistoryPressureOffset);
+    EXPECT_DOUBLE_EQ(History::temperature(high_), 327.67);
+    EXPECT_DOUBLE_EQ(History::humidity(high_), 655.34);
+    EXPECT_DOUBLE_EQ(History::pressure(high_), HistoryPressureOffset + 6553.4);
+}
+
+TEST(HistoryTest, Wraparound) {
+    History history_;
+    fill(history_, History::Size + 100 + 1);
+    ASSERT_EQ(history_.end(), History::Size + 100u);
+    EXPECT_EQ(history_.first(), 100u);
+
+    HistoryEntry entry_;
+    // Overwritten
+    EXPECT_FALSE(history_.get(99, entry_));
+    EXPECT_FALSE(history_.get(0, entry_));
+    // Every stored minute has its own value
+    for (uint32_t i = history_.first(); i < history_.end(); i++) {
+        ASSERT_TRUE(history_.get(i, entry_)) << i;
+        EXPECT_NEAR(History::temperature(entry_), 20.0 + i % 100 / 100.0, 0.005) << i;
+        EXPECT_NEAR(History::pressure(entry_), 1000.0 + i % 1000 / 10.0, 0.05) << i;
+    }
+    EXPECT_FALSE(history_.get(history_.end(), entry_));
+
+    // Several days later still exactly 24 h
+    fill(history_, 3 * History::Size, (History::Size + 101) * History::Interval);
+    EXPECT_EQ(history_.end() - history_.first(), History::Size);
+}
+
+TEST(HistoryTest, MillisWraparound) {
+    History history_;
+    // Starts 10 minutes before millis() wraps after 49.7 days
+    uint32_t start_ = 0 - 10 * History::Interval;
+    for (uint32_t i = 0; i < 20 * 120; i++) {
+        history_.add(20.0 + i / 120, 50.0, 1000.0, start_ + i * 500);
+    }
+    history_.add(0, 0, 0, start_ + 20 * History::Interval);
+    ASSERT_EQ(history_.end(), 20u);
+
+    HistoryEntry entry_;
+    for (uint32_t i = 0; i < 20; i++) {
+        ASSERT_TRUE(history_.get(i, entry_));
+        EXPECT_DOUBLE_EQ(History::temperature(entry_), 20.0 + i) << i;
+    }
+}
+
+TEST(HistoryTest, MemoryFootprint) {
+    size_t entries_ = History::Size * sizeof(HistoryEntry);
+    printf("HistoryEntry %zu bytes, History %zu bytes, %zu of them entries\n", sizeof(HistoryEntry), sizeof(History), entries_);
+
+    EXPECT_EQ(sizeof(HistoryEntry), 6u);
+    EXPECT_EQ(entries_, 8640u);
+    // The running minute and the counters
+    EXPECT_LE(sizeof(History), entries_ + 64);
+}
@@ -0,0 +1,172 @@
+// test_metrics.cpp
+
+// Scrapes /metrics of the booted sketch and parses it as Prometheus does
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+
+#include "hostsketch.h"
+#include "ESPAsyncWebServer.h"
+#include "common.h"
+#include "n2kstats.h"
+
+struct MetricFamily {
+    std::string Help;
+    std::string Type;
+    std::map<std::string, double> Samples; // labels to value
+};
+
+// Parses the text format 0.0.4. Fails the test on every line a scraper would reject.
+static std::map<std::string, MetricFamily> parse(const std::string& body_) {
+    std::map<std::string, MetricFamily> families_;
+    std::istringstream lines_(body_);
+    std::string line_;
+    std::string current_;
+
+    EXPECT_FALSE(body_.empty());
+    EXPECT_EQ(body_.back(), '\n');
+
+    while (std::getline(lines_, line_)) {
+        if (line_.compare(0, 7, "# HELP ") == 0) {
+            size_t end_ = line_.find(' ', 7);
+            current_ = line_.substr(7, end_ - 7);
+            EXPECT_EQ(families_.count(current_), 0u) << "family twice: " << current_;
+            families_[current_].Help = line_.substr(end_ + 1);
+            continue;
+        }
+        if (line_.compare(0, 7, "# TYPE ") == 0) {
+            size_t end_ = line_.find(' ', 7);
+            EXPECT_EQ(line_.substr(7, end_ - 7), current_) << "TYPE without HELP: " << line_;
+            families_[current_].Type = line_.substr(end_ + 1);
+            continue;
+        }
+
+        size_t labels_ = line_.find('{');
+        size_t space_ = line_.rfind(' ');
+        EXPECT_NE(space_, std::string::npos) << line_;
+        std::string name_ = line_.substr(0, labels_ < space_ ? labels_ : space_);
+        std::string set_ = labels_ < space_ ? line_.substr(labels_, space_ - labels_) : "";
+        EXPECT_EQ(name_, current_) << "sample outside its family: " << line_;
+        if (!set_.empty()) {
+            EXPECT_EQ(set_.back(), '}') << line_;
+        }
+
+        std::string text_ = line_.substr(space_ + 1);
+        char* end_ = nullptr;
+        double value_ = strtod(text_.c_str(), &end_);
+        EXPECT_TRUE(!text_.empty() && *end_ == '\0') << "value: " << line_;
+
+        MetricFamily& family_ = families_[name_];
+        EXPECT_EQ(family_.Samples.count(set_), 0u) << "series twice: " << line_;
+        family_.Samples[set_] = value_;
+    }
+
+    for (const auto& family_ : families_) {
+        EXPECT_FALSE(family_.second.Help.empty()) << family_.first;
+        EXPECT_TRUE(family_.second.Type == "gauge" || family_.second.Type == "counter") << family_.first;
+        if (family_.second.Type == "counter") {
+            EXPECT_EQ(family_.first.substr(family_.first.size() - 6), "_total") << family_.first;
+        }
+        EXPECT_FALSE(family_.second.Samples.empty()) << family_.first;
+    }
+    return families_;
+}
+
+static std::string scrape(int* code_ = nullptr) {
+    AsyncWebServerRequest request_(HTTP_GET, "/metrics");
+    EXPECT_TRUE(AsyncWebServer::instance()->handle(request_));
+    std::string body_;
+    if (request_.response() != nullptr) {
+        if (code_ != nullptr) {
+            *code_ = request_.response()->code();
+        }
+        EXPECT_EQ(request_.response()->drain(&body_), request_.response()->contentLength());
+    }
+    return body_;
+}
+
+TEST(Metrics, ScrapeParses) {
+    HostSketch::sensor(0).setConditions(19.25, 1002.5, 61.0);
+    HostSketch::run(10000);
+
+    int code_ = 0;
+    std::string body_ = scrape(&code_);
+    ASSERT_EQ(code_, 200) << body_;
+    printf("%zu bytes, %d sensors\n", body_.size(), SENSOR_COUNT);
+
+    std::map<std::string, MetricFamily> families_ = parse(body_);
+    EXPECT_EQ(families_.size(), 28u);
+
+    EXPECT_NEAR(families_["bme280_temperature_celsius"].Samples[""], 19.25, 0.02);
+    EXPECT_NEAR(families_["bme280_pressure_hpa"].Samples[""], 1002.5, 0.05);
+    EXPECT_GT(families_["bme280_sample_sequence"].Samples[""], 10);
+
+    // One series per result and device, the frames of the devices add up to those of the PGNs
+    const MetricFamily& messages_ = families_["n2k_device_messages_total"];
+    EXPECT_EQ(messages_.Samples.size(), 2u * DeviceCount);
+    EXPECT_EQ(messages_.Samples.count("{device=\"temperature\",result=\"ok\"}"), 1u);
+    double devices_ = 0;
+    double pgns_ = 0;
+    for (const auto& sample_ : families_["n2k_device_frames_total"].Samples) {
+        devices_ += sample_.second;
+    }
+    for (const auto& sample_ : families_["n2k_pgn_frames_total"].Samples) {
+        pgns_ += sample_.second;
+    }
+    EXPECT_GT(pgns_, 0);
+    EXPECT_LE(pgns_, devices_);
+}
+
+// METRIC_FAMILY_LEN and METRIC_SAMPLE_LEN of webhandling.cpp
+static const size_t FamilyLength = 144;
+static const size_t SampleLength = 80;
+
+TEST(Metrics, LargestScrapeFitsTheBuffer) {
+    HostSketch::run(1000);
+
+    // All PGNs the statistics can hold
+    extern N2kStatistics gN2kStats;
+    while (gN2kStats.pgnCount() < N2kStatistics::MaxPGNs) {
+        gN2kStats.addPGN(100000L + gN2kStats.pgnCount());
+    }
+
+    int code_ = 0;
+    std::string body_ = scrape(&code_);
+    ASSERT_EQ(code_, 200) << body_;
+    printf("%zu bytes with %u PGNs\n", body_.size(), (unsigned)N2kStatistics::MaxPGNs);
+
+    // Each line still fits with its counter at the widest uint32_t
+    std::istringstream lines_(body_);
+    std::string line_;
+    std::string help_;
+    while (std::getline(lines_, line_)) {
+        if (line_.compare(0, 7, "# HELP ") == 0) {
+            help_ = line_;
+        }
+        else if (line_.compare(0, 7, "# TYPE ") == 0) {
+            EXPECT_LE(help_.size() + line_.size() + 2, FamilyLength) << line_;
+        }
+        else {
+            EXPECT_LE(line_.rfind(' ') + sizeof(" 4294967295"), SampleLength) << line_;
+        }
+    }
+}
+
+TEST(Metrics, SecondScrapeWaitsForTheFirst) {
+    HostSketch::run(1000);
+
+    AsyncWebServerRequest first_(HTTP_GET, "/metrics");
+    AsyncWebServer::instance()->handle(first_);
+    int code_ = 0;
+    scrape(&code_);
+    EXPECT_EQ(code_, 503);
+
+    first_.disconnect();
+    scrape(&code_);
+    EXPECT_EQ(code_, 200);
+}
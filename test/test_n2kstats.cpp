@@ -0,0 +1,102 @@
+// test_n2kstats.cpp
+
+// Frames per message, the send counters and the bus load of N2kStatistics
+
+#include <gtest/gtest.h>
+
+#include "n2kstats.h"
+
+TEST(N2kStatsTest, FrameCountOfSingleAndFastPackets) {
+    EXPECT_EQ(N2kStatistics::frameCount(0), 1u);
+    EXPECT_EQ(N2kStatistics::frameCount(8), 1u);
+    // Fast packet: 6 bytes in the first frame, 7 in each one after it
+    EXPECT_EQ(N2kStatistics::frameCount(9), 2u);
+    EXPECT_EQ(N2kStatistics::frameCount(13), 2u);
+    EXPECT_EQ(N2kStatistics::frameCount(14), 3u);
+    EXPECT_EQ(N2kStatistics::frameCount(20), 3u);
+    EXPECT_EQ(N2kStatistics::frameCount(27), 4u);
+    EXPECT_EQ(N2kStatistics::frameCount(28), 5u);
+    // Largest fast packet, 32 frames
+    EXPECT_EQ(N2kStatistics::frameCount(223), 32u);
+}
+
+TEST(N2kStatsTest, CountsPerPgnDeviceAndTotal) {
+    N2kStatistics stats_;
+    EXPECT_TRUE(stats_.addPGN(130312L));
+    EXPECT_TRUE(stats_.addPGN(130314L));
+    EXPECT_TRUE(stats_.addPGN(130312L));
+    EXPECT_EQ(stats_.pgnCount(), 2);
+
+    stats_.record(130312L, 0, 8, true);
+    stats_.record(130312L, 0, 8, false);
+    stats_.record(130314L, 2, 8, true);
+    stats_.record(126996L, 1, 134, true);
+
+    EXPECT_EQ(stats_.pgnCounters(0).Attempted.load(), 2u);
+    EXPECT_EQ(stats_.pgnCounters(0).Succeeded.load(), 1u);
+    EXPECT_EQ(stats_.pgnCounters(0).Failed.load(), 1u);
+    // Failed sends put nothing on the bus
+    EXPECT_EQ(stats_.pgnCounters(0).Frames.load(), 1u);
+    EXPECT_EQ(stats_.pgnCounters(0).Bytes.load(), 8u);
+    EXPECT_EQ(stats_.pgnCounters(1).Frames.load(), 1u);
+
+    // Not registered, only in the device and the total
+    EXPECT_EQ(stats_.deviceCounters(1).Frames.load(), 20u);
+    EXPECT_EQ(stats_.deviceCounters(2).Attempted.load(), 1u);
+    EXPECT_EQ(stats_.total().Attempted.load(), 4u);
+    EXPECT_EQ(stats_.total().Frames.load(), 22u);
+    EXPECT_EQ(stats_.total().Bytes.load(), 150u);
+}
+
+TEST(N2kStatsTest, TooManyPgnsAndDevices) {
+    N2kStatistics stats_;
+    for (uint8_t i = 0; i < N2kStatistics::MaxPGNs; i++) {
+        EXPECT_TRUE(stats_.addPGN(130000L + i));
+    }
+    EXPECT_FALSE(stats_.addPGN(129000L));
+
+    stats_.record(130000L, N2kStatistics::MaxDevices, 8, true);
+    EXPECT_EQ(stats_.pgnCounters(0).Frames.load(), 1u);
+    EXPECT_EQ(stats_.total().Frames.load(), 1u);
+}
+
+TEST(N2kStatsTest, BusLoad) {
+    N2kStatistics stats_;
+    stats_.update(1000);
+    EXPECT_EQ(stats_.framesPerSecond(), 0.0f);
+
+    // 100 single frames in one second, 131 bits each without stuffing
+    for (int i = 0; i < 100; i++) {
+        stats_.record(130312L, 0, 8, true);
+    }
+    stats_.update(2000);
+    EXPECT_FLOAT_EQ(stats_.framesPerSecond(), 100.0f);
+    EXPECT_FLOAT_EQ(stats_.busLoad(), 100 * 131 * 100.0f / 250000);
+
+    // 10 messages of 28 bytes in 500 ms: 50 frames, 100 per second
+    for (int i = 0; i < 10; i++) {
+        stats_.record(130312L, 0, 28, true);
+    }
+    stats_.update(2500);
+    EXPECT_FLOAT_EQ(stats_.framesPerSecond(), 100.0f);
+    EXPECT_FLOAT_EQ(stats_.busLoad(), 5.24f);
+
+    // Nothing sent, and a second update at the same time keeps the values
+    stats_.update(3500);
+    EXPECT_EQ(stats_.framesPerSecond(), 0.0f);
+    EXPECT_EQ(stats_.busLoad(), 0.0f);
+    stats_.record(130312L, 0, 8, true);
+    stats_.update(3500);
+    EXPECT_EQ(stats_.framesPerSecond(), 0.0f);
+}
+
+TEST(N2kStatsTest, BusLoadAcrossMillisWrap) {
+    N2kStatistics stats_;
+    stats_.update(0xFFFFFE0CUL);
+    for (int i = 0; i < 50; i++) {
+        stats_.record(130312L, 0, 8, true);
+    }
+    // 1000 ms later, millis() wrapped
+    stats_.update(500);
+    EXPECT_FLOAT_EQ(stats_.framesPerSecond(), 50.0f);
+}
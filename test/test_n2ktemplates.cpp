@@ -0,0 +1,124 @@
+// test_n2ktemplates.cpp
+
+// Patched templates against the complete encode of the library, byte by byte
+// over the whole range of every value field
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "N2kMessages.h"
+#include "n2ktemplates.h"
+
+static const uint8_t Instance = 7;
+
+// The message as the library encodes it, with the instances of N2kTemplates::build()
+static void reference(tN2kTemplateId id_, tN2kMsg& msg_, uint8_t sid_, double value_) {
+    switch (id_) {
+    case TemplateTemperature: SetN2kPGN130312(msg_, sid_, Instance, N2kts_MainCabinTemperature, value_, N2kDoubleNA); break;
+    case TemplateTemperatureExt: SetN2kPGN130316(msg_, sid_, Instance, N2kts_MainCabinTemperature, value_, N2kDoubleNA); break;
+    case TemplateHumidity: SetN2kPGN130313(msg_, sid_, Instance + 1, N2khs_InsideHumidity, value_, N2kDoubleNA); break;
+    case TemplatePressure: SetN2kPGN130314(msg_, sid_, Instance + 2, N2kps_Atmospheric, value_); break;
+    case TemplateHeatIndex: SetN2kPGN130312(msg_, sid_, Instance + 3, N2kts_HeatIndexTemperature, value_, N2kDoubleNA); break;
+    case TemplateHeatIndexExt: SetN2kPGN130316(msg_, sid_, Instance + 3, N2kts_HeatIndexTemperature, value_, N2kDoubleNA); break;
+    case TemplateDewPoint: SetN2kPGN130312(msg_, sid_, Instance + 4, N2kts_DewPointTemperature, value_, N2kDoubleNA); break;
+    default: SetN2kPGN130316(msg_, sid_, Instance + 4, N2kts_DewPointTemperature, value_, N2kDoubleNA); break;
+    }
+}
+
+class N2kTemplatesTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        templates_.build(Instance, N2kts_MainCabinTemperature, N2khs_InsideHumidity);
+    }
+
+    // Counts the values whose patched message differs from the reference
+    uint32_t mismatches(tN2kTemplateId id_, uint8_t sid_, double value_) {
+        tN2kMsg expected_;
+        reference(id_, expected_, sid_, value_);
+        const tN2kMsg& actual_ = templates_.patch(id_, sid_, value_);
+
+        checked_++;
+        bool same_ = expected_.PGN == actual_.PGN && expected_.Priority == actual_.Priority &&
+            expected_.DataLen == actual_.DataLen && memcmp(expected_.Data, actual_.Data, expected_.DataLen) == 0;
+        if (!same_ && failures_++ < 5) {
+            ADD_FAILURE() << "template " << (int)id_ << " differs for " << value_;
+        }
+        return same_ ? 0 : 1;
+    }
+
+    // Steps through [from_, to_] and adds values that are not on the grid
+    uint32_t sweep(tN2kTemplateId id_, double from_, double to_, double step_) {
+        uint32_t count_ = 0;
+        uint8_t sid_ = 0;
+        for (double value_ = from_; value_ <= to_; value_ += step_) {
+            count_ += mismatches(id_, sid_++ % 253, value_);
+        }
+        std::mt19937 random_(id_);
+        std::uniform_real_distribution<double> any_(from_, to_);
+        for (int i = 0; i < 100000; i++) {
+            count_ += mismatches(id_, 0, any_(random_));
+        }
+        return count_;
+    }
+
+    // NA, out of range and rounding edges
+    uint32_t edges(tN2kTemplateId id_, double limit_, double precision_) {
+        const double values_[] = { N2kDoubleNA, -1e12, -limit_ - precision_, -limit_, -precision_ / 2, -0.0, 0.0,
+            precision_ / 2, precision_ * 0.4999999, precision_ * 0.5000001, limit_ - precision_, limit_ - precision_ / 2,
+            limit_, limit_ + precision_, 1e12 };
+        uint32_t count_ = 0;
+        for (double value_ : values_) {
+            count_ += mismatches(id_, 252, value_);
+        }
+        return count_;
+    }
+
+    N2kTemplates templates_;
+    uint32_t checked_ = 0;
+    uint32_t failures_ = 0;
+};
+
+TEST_F(N2kTemplatesTest, Temperature2ByteMatchesTheLibrary) {
+    for (tN2kTemplateId id_ : { TemplateTemperature, TemplateHeatIndex, TemplateDewPoint }) {
+        // 0.01 K, 0..655.32 K
+        EXPECT_EQ(sweep(id_, 0.0, 700.0, 0.0025), 0u);
+        EXPECT_EQ(edges(id_, 655.32, 0.01), 0u);
+    }
+    printf("%lu messages compared\n", (unsigned long)checked_);
+}
+
+TEST_F(N2kTemplatesTest, Temperature3ByteMatchesTheLibrary) {
+    for (tN2kTemplateId id_ : { TemplateTemperatureExt, TemplateHeatIndexExt, TemplateDewPointExt }) {
+        // 0.001 K, 0..16777.214 K, the full grid in the range of the sensor
+        EXPECT_EQ(sweep(id_, 200.0, 400.0, 0.00025), 0u);
+        EXPECT_EQ(sweep(id_, 0.0, 17000.0, 0.1), 0u);
+        EXPECT_EQ(edges(id_, 16777.214, 0.001), 0u);
+    }
+    printf("%lu messages compared\n", (unsigned long)checked_);
+}
+
+TEST_F(N2kTemplatesTest, HumidityMatchesTheLibrary) {
+    // 0.004 %, -131.072..131.068 %
+    EXPECT_EQ(sweep(TemplateHumidity, -140.0, 140.0, 0.001), 0u);
+    EXPECT_EQ(edges(TemplateHumidity, 131.068, 0.004), 0u);
+    printf("%lu messages compared\n", (unsigned long)checked_);
+}
+
+TEST_F(N2kTemplatesTest, PressureMatchesTheLibrary) {
+    // 0.1 Pa, the grid in the range of the sensor and the full signed 32 bit range
+    EXPECT_EQ(sweep(TemplatePressure, 30000.0, 110000.0, 0.025), 0u);
+    EXPECT_EQ(sweep(TemplatePressure, -214748364.7, 214748364.6, 1000.1), 0u);
+    EXPECT_EQ(edges(TemplatePressure, 214748364.6, 0.1), 0u);
+    printf("%lu messages compared\n", (unsigned long)checked_);
+}
+
+TEST_F(N2kTemplatesTest, KeepsTheOtherFieldsOfTheMessage) {
+    for (uint8_t i = 0; i < TemplateCount; i++) {
+        tN2kTemplateId id_ = tN2kTemplateId(i);
+        for (int sid_ = 0; sid_ < 256; sid_++) {
+            EXPECT_EQ(mismatches(id_, sid_, 290.0 + sid_), 0u);
+        }
+        EXPECT_EQ(mismatches(id_, 0, N2kDoubleNA), 0u);
+    }
+}
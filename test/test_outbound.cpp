@@ -0,0 +1,128 @@
+// test_outbound.cpp
+
+// The sketch on a bus that takes fewer frames than it wants to send: the age
+// of the values when their last frame left, from the epoch of their SID
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "hostsketch.h"
+#include "hostcan.h"
+#include "ESPAsyncWebServer.h"
+#include "webhandling.h"
+
+extern TransmitConfig TransmitSettings;
+extern OutboundQueue gOutbound;
+
+static const uint32_t EpochPeriod = 500;
+static const uint8_t SIDCount = 253; // 0..252, see NextSID()
+
+static void postConfig(const char* maxAge_) {
+    AsyncWebServerRequest request_(HTTP_POST, "/config");
+    // Deadband 0, so every epoch sends all its messages
+    request_.addArg("transmitconfig-dbtemperature", "0");
+    request_.addArg("transmitconfig-dbhumidity", "0");
+    request_.addArg("transmitconfig-dbpressure", "0");
+    request_.addArg("transmitconfig-maxage", maxAge_);
+    ASSERT_TRUE(AsyncWebServer::instance()->handle(request_));
+    ASSERT_EQ(request_.response()->code(), 200);
+}
+
+// Where the epochs start and which SID one of them has
+struct EpochGrid {
+    uint32_t Start; // ms
+    uint8_t SID;
+
+    // Start of the latest epoch up to queued_ with the SID sid_
+    uint32_t epochOf(uint8_t sid_, uint32_t queued_) const {
+        uint32_t epochs_ = (queued_ - this->Start) / EpochPeriod;
+        uint8_t sidNow_ = (this->SID + epochs_) % SIDCount;
+        uint32_t back_ = (sidNow_ + SIDCount - sid_) % SIDCount;
+        return this->Start + (epochs_ - back_) * EpochPeriod;
+    }
+};
+
+// On a free bus the messages of slot 0 leave when the epoch starts
+static EpochGrid findGrid() {
+    EpochGrid grid_ = { 0xFFFFFFFF, 0 };
+    for (const HostCanMessage& message_ : gHostCan.messages()) {
+        uint32_t queued_ = message_.Queued / 1000;
+        if (queued_ < grid_.Start) {
+            grid_.Start = queued_;
+            grid_.SID = message_.Msg.Data[0];
+        }
+    }
+    return grid_;
+}
+
+static uint32_t percentile(std::vector<uint32_t>& values_, double p_) {
+    if (values_.empty()) {
+        return 0;
+    }
+    std::sort(values_.begin(), values_.end());
+    size_t index_ = (size_t)(p_ * (values_.size() - 1) + 0.5);
+    return values_[index_];
+}
+
+TEST(Outbound, MaxAgeKeepsFiveDigits) {
+    HostSketch::boot();
+    postConfig("10000");
+    EXPECT_EQ(TransmitSettings.MaxAge(), 10000u);
+    postConfig("500");
+    EXPECT_EQ(TransmitSettings.MaxAge(), 500u);
+}
+
+TEST(Outbound, DeliveredAgeOnAThrottledBus) {
+    HostSketch::boot();
+    postConfig("1000");
+    gHostCan.setFrameRate(0);
+    HostSketch::run(2000);
+    gHostCan.clearSent();
+    HostSketch::run(1000);
+    EpochGrid grid_ = findGrid();
+    ASSERT_NE(grid_.Start, 0xFFFFFFFF);
+
+    // The node wants 8 frames per epoch, 16 per second
+    const uint32_t Rates[] = { 0, 32, 16, 12, 8, 4 };
+    for (uint32_t rate_ : Rates) {
+        gHostCan.setFrameRate(rate_);
+        HostSketch::run(5000); // settle
+        gHostCan.clearSent();
+        uint32_t stale_ = gOutbound.stale();
+        uint32_t coalesced_ = gOutbound.coalesced();
+
+        HostSketch::run(60000);
+
+        std::vector<uint32_t> ages_;
+        for (const HostCanMessage& message_ : gHostCan.messages()) {
+            if (message_.Msg.PGN < 130312L || message_.Msg.PGN > 130316L) {
+                continue;
+            }
+            uint32_t queued_ = message_.Queued / 1000;
+            uint32_t taken_ = grid_.epochOf(message_.Msg.Data[0], queued_);
+            ages_.push_back(message_.Sent / 1000 - taken_);
+        }
+        size_t delivered_ = ages_.size();
+        uint32_t p50_ = percentile(ages_, 0.5);
+        uint32_t p90_ = percentile(ages_, 0.9);
+        uint32_t p99_ = percentile(ages_, 0.99);
+        uint32_t max_ = ages_.empty() ? 0 : ages_.back();
+
+        printf("%2lu frames/s: %4zu values delivered, age p50 %4lu p90 %4lu p99 %4lu max %4lu ms, %lu stale, %lu replaced\n",
+            (unsigned long)rate_, delivered_, (unsigned long)p50_, (unsigned long)p90_, (unsigned long)p99_, (unsigned long)max_,
+            (unsigned long)(gOutbound.stale() - stale_), (unsigned long)(gOutbound.coalesced() - coalesced_));
+
+        // Values are not older than the maximal age when they are handed to
+        // the CAN driver, the frames in its buffer (32) add to that
+        EXPECT_GT(delivered_, 0u) << rate_;
+        if (rate_ > 0) {
+            EXPECT_LE(max_, 1000u + 32 * 1000 / rate_) << rate_;
+        }
+        if (rate_ == 0 || rate_ >= 32) {
+            EXPECT_LT(p99_, EpochPeriod) << rate_;
+        }
+    }
+    gHostCan.setFrameRate(0);
+}
@@ -0,0 +1,76 @@
+// test_profiles.cpp
+
+// Each sampling profile chosen on /config: the registers the sketch writes
+// into the simulated sensor and the time from the trigger to the read
+
+#include <gtest/gtest.h>
+
+#include "hostsketch.h"
+#include "ESPAsyncWebServer.h"
+#include "bme280profile.h"
+
+// Register addresses of the datasheet (5.3)
+#define REG_CTRL_HUM 0xF2
+#define REG_CTRL_MEAS 0xF4
+#define REG_CONFIG 0xF5
+
+static void chooseProfile(tBME280Profile profile_) {
+    AsyncWebServerRequest request_(HTTP_POST, "/config");
+    request_.addArg("SamplingProfile", String((unsigned int)profile_));
+    ASSERT_TRUE(AsyncWebServer::instance()->handle(request_));
+    ASSERT_EQ(request_.response()->code(), 200);
+}
+
+TEST(Profiles, RegistersAndLatency) {
+    HostSketch::boot();
+    SimBME280& sensor_ = HostSketch::sensor(0);
+
+    for (uint8_t i = 0; i < ProfileCount; i++) {
+        const BME280Profile& profile_ = BME280GetProfile(tBME280Profile(i));
+        chooseProfile(tBME280Profile(i));
+        HostSketch::run(2000);
+
+        uint32_t reads_ = sensor_.dataReads();
+        uint32_t stale_ = sensor_.staleReads();
+        uint32_t worst_ = 0;
+        uint32_t oldest_ = 0;
+        for (int epoch_ = 0; epoch_ < 20; epoch_++) {
+            HostSketch::run(500);
+            // Normal mode has no trigger
+            if (profile_.Mode == BME280_MODE_FORCED) {
+                worst_ = std::max(worst_, sensor_.lastTriggerToRead());
+            }
+            oldest_ = std::max(oldest_, sensor_.lastReadAge());
+        }
+
+        uint32_t measurement_ = SimBME280::measurementTime(profile_.TemperatureOversampling, profile_.PressureOversampling, profile_.HumidityOversampling);
+        printf("profile %u: ctrl_hum 0x%02X ctrl_meas 0x%02X config 0x%02X, t_measure %lu us, trigger to read %lu us, data age %lu us\n",
+            i, sensor_.reg(REG_CTRL_HUM), sensor_.reg(REG_CTRL_MEAS), sensor_.reg(REG_CONFIG), (unsigned long)measurement_,
+            (unsigned long)worst_, (unsigned long)oldest_);
+
+        EXPECT_EQ(sensor_.reg(REG_CTRL_HUM) & 0x07, profile_.HumidityOversampling) << (int)i;
+        EXPECT_EQ(sensor_.reg(REG_CTRL_MEAS) >> 5, profile_.TemperatureOversampling) << (int)i;
+        EXPECT_EQ((sensor_.reg(REG_CTRL_MEAS) >> 2) & 0x07, profile_.PressureOversampling) << (int)i;
+        EXPECT_EQ((sensor_.reg(REG_CONFIG) >> 2) & 0x07, profile_.Filter) << (int)i;
+        // The firmware and the simulation agree on t_measure,max
+        EXPECT_EQ(BME280MeasurementTime(profile_), measurement_);
+
+        // One read per epoch and every read gets a new conversion
+        EXPECT_EQ(sensor_.dataReads() - reads_, 20u) << (int)i;
+        EXPECT_EQ(sensor_.staleReads(), stale_) << (int)i;
+
+        if (profile_.Mode == BME280_MODE_FORCED) {
+            EXPECT_EQ(sensor_.reg(REG_CTRL_MEAS) & 0x03, BME280_MODE_FORCED) << (int)i;
+            // Triggered t_measure,max rounded up to the next ms before the read
+            EXPECT_GE(worst_, measurement_) << (int)i;
+            EXPECT_LE(worst_, measurement_ + 1000 + 200) << (int)i;
+            EXPECT_LE(oldest_, 1200u) << (int)i;
+        }
+        else {
+            EXPECT_EQ(sensor_.reg(REG_CTRL_MEAS) & 0x03, BME280_MODE_NORMAL) << (int)i;
+            EXPECT_EQ(sensor_.reg(REG_CONFIG) >> 5, profile_.Standby) << (int)i;
+            // The newest conversion of a cycle is read, at most one cycle old
+            EXPECT_LE(oldest_, measurement_ + SimBME280::standbyTime(profile_.Standby)) << (int)i;
+        }
+    }
+}
@@ -0,0 +1,134 @@
+// test_rootpage.cpp
+
+// The root page of the booted sketch: its ETag, and time to first byte,
+// bytes and heap of a request
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+#include "hostsketch.h"
+#include "ESPAsyncWebServer.h"
+#include "version.h"
+
+struct RootResult {
+    int Code;
+    std::string ETag;
+    size_t Bytes;
+    double FirstByte;   // us from the request to the response being ready
+    size_t Allocations;
+    size_t Heap;        // bytes allocated at most while the request is answered
+};
+
+static RootResult get(const std::string& match_ = "") {
+    RootResult result_ = {};
+    AsyncWebServerRequest request_(HTTP_GET, "/");
+    if (!match_.empty()) {
+        request_.addHeader("If-None-Match", match_.c_str());
+    }
+
+    HostHeap::resetPeak();
+    size_t inUse_ = HostHeap::inUse();
+    size_t allocations_ = HostHeap::allocations();
+    auto start_ = std::chrono::steady_clock::now();
+
+    // The server sends the first segment as soon as the handler returns
+    AsyncWebServer::instance()->handle(request_);
+    result_.FirstByte = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_).count();
+    AsyncWebServerResponse* response_ = request_.response();
+    result_.Bytes = response_->drain();
+
+    result_.Allocations = HostHeap::allocations() - allocations_;
+    result_.Heap = HostHeap::peak() - inUse_;
+    result_.Code = response_->code();
+    if (response_->header("ETag") != nullptr) {
+        result_.ETag = response_->header("ETag")->c_str();
+    }
+    return result_;
+}
+
+TEST(RootPage, ETagHoldsVersionAndBootNonce) {
+    HostSketch::run(1000);
+
+    RootResult page_ = get();
+    ASSERT_EQ(page_.Code, 200);
+    // "<version>-<8 hex digits>-<page>" in quotes
+    ASSERT_GE(page_.ETag.size(), sizeof(VERSION) + 12);
+    EXPECT_EQ(page_.ETag.front(), '"');
+    EXPECT_EQ(page_.ETag.back(), '"');
+    EXPECT_EQ(page_.ETag.compare(1, sizeof(VERSION) - 1, VERSION), 0) << page_.ETag;
+    EXPECT_EQ(page_.ETag.find(' '), std::string::npos) << page_.ETag;
+    std::string nonce_ = page_.ETag.substr(sizeof(VERSION) + 1, 8);
+    EXPECT_EQ(nonce_.find_first_not_of("0123456789abcdef"), std::string::npos) << page_.ETag;
+    EXPECT_NE(nonce_, "00000000");
+
+    // The same page, the same tag
+    EXPECT_EQ(get().ETag, page_.ETag);
+    EXPECT_EQ(get(page_.ETag).Code, 304);
+    // A tag of the firmware before, or of an earlier boot
+    EXPECT_EQ(get("\"r1\"").Code, 200);
+    std::string before_ = page_.ETag;
+    before_[sizeof(VERSION) + 1] = before_[sizeof(VERSION) + 1] == '0' ? '1' : '0';
+    EXPECT_EQ(get(before_).Code, 200);
+}
+
+void configSaved();
+
+TEST(RootPage, FirstByteBytesAndHeap) {
+    HostSketch::run(1000);
+
+    // A saved configuration builds the page again on the next request
+    std::string before_ = get().ETag;
+    configSaved();
+    RootResult build_ = get();
+    RootResult full_ = get();
+    RootResult cached_ = get(full_.ETag);
+    const RootResult* results_[] = { &build_, &full_, &cached_ };
+    const char* names_[] = { "build", "200", "304" };
+    for (int i = 0; i < 3; i++) {
+        printf("%-5s: %5zu bytes, first byte after %6.1f us, %3zu allocations, %5zu bytes heap\n", names_[i],
+            results_[i]->Bytes, results_[i]->FirstByte, results_[i]->Allocations, results_[i]->Heap);
+    }
+
+    EXPECT_EQ(build_.Code, 200);
+    EXPECT_NE(build_.ETag, before_);
+    EXPECT_EQ(full_.ETag, build_.ETag);
+    EXPECT_EQ(full_.Code, 200);
+    EXPECT_EQ(full_.Bytes, build_.Bytes);
+    EXPECT_GT(full_.Bytes, 1000u);
+    EXPECT_EQ(cached_.Code, 304);
+    EXPECT_EQ(cached_.Bytes, 0u);
+    // The page is sent from memory: the heap holds one segment, not a copy of the page
+    EXPECT_LT(full_.Heap, full_.Bytes / 2);
+    EXPECT_GT(build_.Heap, full_.Bytes);
+    EXPECT_LE(cached_.Allocations, full_.Allocations);
+}
+
+TEST(RootPage, OneCopyWhileSent) {
+    HostSketch::run(1000);
+    RootResult first_ = get();
+    ASSERT_EQ(first_.Code, 200);
+    size_t inUse_ = HostHeap::inUse();
+
+    // A response still sends the page: a saved configuration does not rebuild it under it
+    {
+        AsyncWebServerRequest sending_(HTTP_GET, "/");
+        AsyncWebServer::instance()->handle(sending_);
+        ASSERT_EQ(sending_.response()->code(), 200);
+
+        configSaved();
+        RootResult old_ = get();
+        EXPECT_EQ(old_.ETag, first_.ETag);
+        EXPECT_EQ(old_.Bytes, first_.Bytes);
+        EXPECT_EQ(sending_.response()->drain(), first_.Bytes);
+    }
+
+    // Once it is done the next request builds the page again, into the same buffer
+    RootResult rebuilt_ = get();
+    EXPECT_EQ(rebuilt_.Code, 200);
+    EXPECT_NE(rebuilt_.ETag, first_.ETag);
+    size_t after_ = HostHeap::inUse();
+    printf("heap after the rebuild: %+ld bytes, page %zu bytes\n", (long)after_ - (long)inUse_, rebuilt_.Bytes);
+    EXPECT_LT(after_, inUse_ + rebuilt_.Bytes / 2);
+}
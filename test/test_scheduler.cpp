@@ -0,0 +1,160 @@
+// test_scheduler.cpp
+
+// The deadline scheduler on a simulated clock, and the sleep of the sketch
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "scheduler.h"
+#include "diagnostics.h"
+#include "hostsketch.h"
+#include "common.h"
+
+// The jobs of the sketch on a clock that only moves by work and sleep
+namespace {
+    const uint8_t JobCount = 4;
+    const uint32_t Periods[JobCount] = { 500, 20, 1000, 10000 };
+    const uint32_t Offsets[JobCount] = { 490, 500, 1000, 10000 };
+    const uint32_t Work[JobCount] = { 0, 1, 0, 2 }; // ms per run, the epoch costs 3 ms more
+
+    DeadlineScheduler Scheduler;
+    uint32_t Now;
+    uint32_t RunNow;
+    uint32_t Runs[JobCount];
+    uint32_t MaxLateness[JobCount];
+    uint64_t SumLateness[JobCount];
+    uint32_t SlotRuns;
+
+    template <uint8_t Job>
+    void job() {
+        // lateness() is against the time run() was called, work of the
+        // jobs before in the same run() delays this one further
+        uint32_t lateness_ = Scheduler.lateness() + (Now - RunNow);
+        Runs[Job]++;
+        SumLateness[Job] += lateness_;
+        MaxLateness[Job] = std::max(MaxLateness[Job], lateness_);
+
+        Now += Work[Job];
+        if (Job == 1 && SlotRuns++ % 25 == 0) {
+            Now += 3;
+        }
+    }
+
+    const tJobCallback Callbacks[JobCount] = { job<0>, job<1>, job<2>, job<3> };
+}
+
+TEST(Scheduler, SleepsUntilTheNextDeadline) {
+    for (uint8_t i = 0; i < JobCount; i++) {
+        ASSERT_GE(Scheduler.add(Callbacks[i], Periods[i], Offsets[i]), 0);
+    }
+
+    const uint32_t Duration = 3600 * 1000;
+    uint32_t slept_ = 0;
+    uint32_t wakes_ = 0;
+
+    Now = 0;
+    Scheduler.start(Now);
+    while (Now < Duration) {
+        RunNow = Now;
+        Scheduler.run(Now);
+        uint32_t wait_ = Scheduler.timeUntilNext(Now);
+        wakes_++;
+
+        // the sketch wakes at least every 50 ms for the protocol
+        wait_ = std::min<uint32_t>(wait_, 50);
+        slept_ += wait_;
+        Now += wait_;
+    }
+
+    double idle_ = (double)slept_ / Now;
+    EXPECT_GT(idle_, 0.90);
+    // one wake per deadline of the slot job, not one per ms
+    EXPECT_LT(wakes_, Duration / Periods[1] * 11 / 10);
+
+    for (uint8_t i = 0; i < JobCount; i++) {
+        EXPECT_EQ(Runs[i], (Duration - 1 - Offsets[i]) / Periods[i] + 1) << "job " << (int)i;
+        // late by at most the work that ran before it
+        EXPECT_LE(MaxLateness[i], 6u) << "job " << (int)i;
+    }
+
+    printf("idle %.1f %%, %.1f wakes/s\n", idle_ * 100, wakes_ / (Now / 1000.0));
+    for (uint8_t i = 0; i < JobCount; i++) {
+        printf("job period %5lu ms: mean lateness %.3f ms, max %lu ms\n", (unsigned long)Periods[i],
+            (double)SumLateness[i] / Runs[i], (unsigned long)MaxLateness[i]);
+    }
+}
+
+TEST(Scheduler, SketchSleepsBetweenItsJobs) {
+    HostSketch::boot();
+    HostSketch::run(1000);
+
+    HostTask::reset();
+    gDiagnostics.Phases[DiagEpochLateness].reset();
+    uint32_t start_ = HostClock::millis();
+    uint32_t iterations_ = gLoopTiming.Iterations.load();
+
+    HostSketch::run(60000);
+
+    uint32_t elapsed_ = HostClock::millis() - start_;
+    uint32_t wakes_ = gLoopTiming.Iterations.load() - iterations_;
+    double idle_ = (double)HostTask::sleptMs() / elapsed_;
+
+    EXPECT_GT(idle_, 0.99);
+    // 50 slots per second and the other jobs, far from a spinning loop
+    EXPECT_LT(wakes_, elapsed_ / 10);
+    EXPECT_EQ(gDiagnostics.Phases[DiagEpochLateness].max(), 0u);
+
+    printf("sketch: idle %.2f %%, %.1f wakes/s\n", idle_ * 100, wakes_ / (elapsed_ / 1000.0));
+}
+
+TEST(Scheduler, SketchCatchesUpAfterAStall) {
+    HostSketch::boot();
+    gDiagnostics.Phases[DiagEpochLateness].reset();
+
+    uint32_t start_ = HostClock::millis();
+
+    // a 7 ms stall of the task once per second
+    for (int i = 0; i < 60; i++) {
+        HostSketch::run(1000);
+        HostClock::advance(7);
+    }
+
+    const LatencyHistogram& lateness_ = gDiagnostics.Phases[DiagEpochLateness];
+    // no epoch is lost
+    EXPECT_NEAR(lateness_.count(), (HostClock::millis() - start_) / 500.0, 1.0);
+    EXPECT_LE(lateness_.max(), 7u);
+    printf("epoch lateness with stalls: p50 <= %lu ms, max %lu ms\n", (unsigned long)lateness_.percentile(0.5), (unsigned long)lateness_.max());
+}
+
+namespace {
+    DeadlineScheduler GridScheduler;
+    uint32_t GridDeadline;
+    uint32_t GridLateness;
+    uint32_t GridRuns;
+
+    void gridJob() {
+        GridDeadline = GridScheduler.deadline();
+        GridLateness = GridScheduler.lateness();
+        GridRuns++;
+    }
+}
+
+TEST(Scheduler, DeadlineIsTheLatestPassedGridPoint) {
+    GridScheduler.add(gridJob, 20, 500);
+    GridScheduler.start(1000);
+    EXPECT_EQ(GridScheduler.startTime(), 1000u);
+
+    GridScheduler.run(1500);
+    EXPECT_EQ(GridRuns, 1u);
+    EXPECT_EQ(GridDeadline, 1500u);
+    EXPECT_EQ(GridLateness, 0u);
+
+    // Late by three periods: one run, for the latest grid point
+    GridScheduler.run(1585);
+    EXPECT_EQ(GridRuns, 2u);
+    EXPECT_EQ(GridDeadline, 1580u);
+    EXPECT_EQ(GridLateness, 65u);
+    EXPECT_EQ(GridScheduler.nextDeadline(), 1600u);
+    EXPECT_EQ((GridDeadline - GridScheduler.startTime() - 500) / 20, 4u);
+}
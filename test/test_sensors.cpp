@@ -0,0 +1,154 @@
+// test_sensors.cpp
+
+// The bus output of a node with SENSOR_COUNT sensors, built once per count
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+
+#include "hostsketch.h"
+#include "hostcan.h"
+#include "ESPAsyncWebServer.h"
+#include "N2kMessages.h"
+#include "n2ktemplates.h"
+#include "common.h"
+
+// Sensors[] of the sketch, the sources of the first sensor come from the configuration
+struct ExpectedSensor {
+    uint8_t InstanceOffset;
+    tN2kTempSource TempSource;
+    tN2kHumiditySource HumiditySource;
+};
+
+static const ExpectedSensor Expected[HostSketch::SensorSlots] = {
+    { 0, N2kts_MainCabinTemperature, N2khs_InsideHumidity },
+    { 5, N2kts_OutsideTemperature, N2khs_OutsideHumidity },
+    { 10, N2kts_EngineRoomTemperature, N2khs_InsideHumidity },
+    { 15, N2kts_RefridgerationTemperature, N2khs_InsideHumidity }
+};
+
+// What one sensor sent, from the messages of its three source addresses
+struct SensorOutput {
+    uint32_t Temperatures = 0;
+    uint32_t Humidities = 0;
+    uint32_t Pressures = 0;
+};
+
+TEST(Sensors, EverySensorSendsOnItsOwnDevices) {
+    // Every sensor, also the ones not used, measures other conditions
+    for (uint8_t i = 0; i < HostSketch::SensorSlots; i++) {
+        HostSketch::sensor(i).setConditions(10.0 + i * 5, 1000.0 + i * 4, 40.0 + i * 10);
+    }
+    HostSketch::run(10000);
+
+    SensorOutput outputs_[SENSOR_COUNT];
+    uint8_t instance_ = 0;
+    bool instanceKnown_ = false;
+    std::map<uint8_t, uint32_t> sources_;
+
+    for (const HostCanMessage& message_ : gHostCan.messages()) {
+        sources_[message_.Source]++;
+        if (message_.Source < 22 || message_.Source >= 22 + DeviceCount) {
+            continue;
+        }
+        uint8_t sensor_ = (message_.Source - 22) / DevicesPerSensor;
+        uint8_t device_ = (message_.Source - 22) % DevicesPerSensor;
+        const ExpectedSensor& expected_ = Expected[sensor_];
+        SensorOutput& output_ = outputs_[sensor_];
+        int index_ = 3;
+        uint8_t instanceOffset_ = 0;
+
+        if (message_.Msg.PGN == 130312L && message_.Msg.Data[2] != N2kts_DewPointTemperature && message_.Msg.Data[2] != N2kts_HeatIndexTemperature) {
+            EXPECT_EQ(device_, DeviceTemperature);
+            if (sensor_ > 0) {
+                EXPECT_EQ(message_.Msg.Data[2], expected_.TempSource);
+            }
+            EXPECT_NEAR(KelvinToC(message_.Msg.Get2ByteUDouble(0.01, index_)), 10.0 + sensor_ * 5, 0.02);
+            output_.Temperatures++;
+        }
+        else if (message_.Msg.PGN == 130313L) {
+            EXPECT_EQ(device_, DeviceHumidity);
+            if (sensor_ > 0) {
+                EXPECT_EQ(message_.Msg.Data[2], expected_.HumiditySource);
+            }
+            EXPECT_NEAR(message_.Msg.Get2ByteDouble(0.004, index_), 40.0 + sensor_ * 10, 0.1);
+            output_.Humidities++;
+            instanceOffset_ = 1;
+        }
+        else if (message_.Msg.PGN == 130314L) {
+            EXPECT_EQ(device_, DevicePressure);
+            EXPECT_NEAR(PascalTomBar(message_.Msg.Get4ByteDouble(0.1, index_)), 1000.0 + sensor_ * 4, 0.05);
+            output_.Pressures++;
+            instanceOffset_ = 2;
+        }
+        else {
+            continue;
+        }
+
+        // The instances of a sensor start at the configured one plus its offset
+        uint8_t base_ = message_.Msg.Data[1] - instanceOffset_ - expected_.InstanceOffset;
+        if (!instanceKnown_) {
+            instance_ = base_;
+            instanceKnown_ = true;
+        }
+        EXPECT_EQ(base_, instance_) << "sensor " << (int)sensor_ << " PGN " << message_.Msg.PGN;
+    }
+
+    printf("%d sensors, %zu messages in 10 s from %zu sources\n", SENSOR_COUNT, gHostCan.messages().size(), sources_.size());
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        printf("  sensor %u: %lu temperature, %lu humidity, %lu pressure\n", i,
+            (unsigned long)outputs_[i].Temperatures, (unsigned long)outputs_[i].Humidities, (unsigned long)outputs_[i].Pressures);
+
+        // Every sensor sends as often as the first one
+        EXPECT_GT(outputs_[i].Temperatures, 0u);
+        EXPECT_EQ(outputs_[i].Temperatures, outputs_[0].Temperatures);
+        EXPECT_EQ(outputs_[i].Humidities, outputs_[0].Humidities);
+        EXPECT_EQ(outputs_[i].Pressures, outputs_[0].Pressures);
+    }
+
+    // Nothing from the devices of the sensors that are not configured
+    EXPECT_EQ(sources_.size(), (size_t)DeviceCount);
+    for (const auto& source_ : sources_) {
+        EXPECT_GE(source_.first, 22);
+        EXPECT_LT(source_.first, 22 + DeviceCount);
+    }
+    EXPECT_EQ(gHostCan.rejected(), 0u);
+}
+
+// A bus that takes one frame per second: the driver buffer fills and the
+// messages of every epoch wait in the outbound queue. All of them and the
+// storm alert fit, newer values only replace older ones of the same message.
+TEST(Sensors, TheQueueHoldsAWholeEpoch) {
+    AsyncWebServerRequest request_(HTTP_POST, "/config");
+    // Deadband 0, so every epoch queues all its messages, and none gets stale
+    request_.addArg("transmitconfig-dbtemperature", "0");
+    request_.addArg("transmitconfig-dbhumidity", "0");
+    request_.addArg("transmitconfig-dbpressure", "0");
+    request_.addArg("transmitconfig-maxage", "10000");
+    ASSERT_TRUE(AsyncWebServer::instance()->handle(request_));
+    ASSERT_EQ(request_.response()->code(), 200);
+    HostSketch::run(1000);
+
+    uint32_t dropped_ = gOutbound.dropped();
+    uint32_t stale_ = gOutbound.stale();
+    uint8_t pending_ = 0;
+    gHostCan.setFrameRate(1);
+    for (int i = 0; i < 500; i++) {
+        HostSketch::run(10);
+        pending_ = std::max(pending_, gOutbound.pending());
+    }
+
+    // The storm alert of the pressure device (key 0) on top of a full epoch
+    tN2kMsg alert_;
+    alert_.SetPGN(126983L);
+    EXPECT_TRUE(gOutbound.push(alert_, DevicePressure, 0, millis()));
+    uint8_t withAlert_ = gOutbound.pending();
+    gHostCan.setFrameRate(0);
+
+    printf("%d sensors: %u messages waiting, %u with the alert, queue of %u\n", SENSOR_COUNT, pending_, withAlert_, OutboundQueue::Size);
+    EXPECT_EQ(pending_, SENSOR_COUNT * TemplateCount);
+    EXPECT_EQ(withAlert_, SENSOR_COUNT * TemplateCount + 1);
+    EXPECT_EQ(gOutbound.dropped(), dropped_);
+    EXPECT_EQ(gOutbound.stale(), stale_);
+}
@@ -0,0 +1,173 @@
+// test_seqlock.cpp
+
+// One writer and several reader threads on the sequence lock, one writer
+// and one reader thread on the snapshot store of the configuration
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "seqlock.h"
+#include "snapshot.h"
+
+// Every field follows from Number, so a torn copy shows
+struct StressValue {
+    uint32_t Number;
+    double Values[7];
+    uint32_t Check;
+};
+
+static void fill(StressValue& value_, uint32_t number_) {
+    value_.Number = number_;
+    for (int i = 0; i < 7; i++) {
+        value_.Values[i] = number_ * (i + 1.5);
+    }
+    value_.Check = ~number_;
+}
+
+static bool consistent(const StressValue& value_) {
+    for (int i = 0; i < 7; i++) {
+        if (value_.Values[i] != value_.Number * (i + 1.5)) {
+            return false;
+        }
+    }
+    return value_.Check == ~value_.Number;
+}
+
+TEST(SeqLock, ReturnsNothingBeforeTheFirstPublish) {
+    SeqLock<StressValue> lock_;
+    StressValue value_;
+
+    EXPECT_EQ(lock_.read(value_), 0u);
+    EXPECT_EQ(lock_.sequence(), 0u);
+}
+
+TEST(SeqLock, ReadersNeverSeeATornValue) {
+    const uint32_t Publishes = 200000;
+    const int Readers = 3;
+
+    SeqLock<StressValue> lock_;
+    std::atomic<bool> done_{ false };
+    std::atomic<uint32_t> torn_{ 0 };
+    std::atomic<uint32_t> mismatched_{ 0 };
+    std::atomic<uint32_t> backwards_{ 0 };
+    std::atomic<uint64_t> reads_{ 0 };
+
+    std::vector<std::thread> readers_;
+    for (int i = 0; i < Readers; i++) {
+        readers_.emplace_back([&]() {
+            StressValue value_;
+            uint32_t last_ = 0;
+            uint64_t count_ = 0;
+
+            while (!done_.load(std::memory_order_relaxed)) {
+                uint32_t sequence_ = lock_.read(value_);
+                count_++;
+                if (sequence_ == 0) {
+                    continue;
+                }
+                if (!consistent(value_)) {
+                    torn_++;
+                }
+                if (value_.Number != sequence_) {
+                    mismatched_++;
+                }
+                if (sequence_ < last_) {
+                    backwards_++;
+                }
+                last_ = sequence_;
+            }
+            reads_ += count_;
+        });
+    }
+
+    auto start_ = std::chrono::steady_clock::now();
+    StressValue value_;
+    for (uint32_t i = 1; i <= Publishes; i++) {
+        fill(value_, i);
+        lock_.publish(value_);
+    }
+    double writeSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    done_ = true;
+    for (std::thread& reader_ : readers_) {
+        reader_.join();
+    }
+    double seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+
+    EXPECT_EQ(torn_.load(), 0u);
+    EXPECT_EQ(mismatched_.load(), 0u);
+    EXPECT_EQ(backwards_.load(), 0u);
+    EXPECT_EQ(lock_.sequence(), Publishes);
+
+    printf("%.0f publishes/s, %.0f reads/s with %d readers\n", Publishes / writeSeconds_, reads_.load() / seconds_, Readers);
+}
+
+// The reader holds a buffer for a while: the writer must not pick it for an
+// edit, so the value stays the same until release()
+TEST(SnapshotStore, HeldValueNeverChanges) {
+    const uint32_t Publishes = 200000;
+
+    SnapshotStore<StressValue> store_;
+    std::atomic<bool> done_{ false };
+    uint32_t torn_ = 0;
+    uint32_t changed_ = 0;
+    uint32_t mismatched_ = 0;
+    uint32_t backwards_ = 0;
+    uint64_t reads_ = 0;
+
+    std::thread reader_([&]() {
+        uint32_t last_ = 0;
+        while (!done_.load(std::memory_order_relaxed)) {
+            const StressValue& value_ = store_.acquire();
+            uint32_t number_ = value_.Number;
+            if (!consistent(value_)) {
+                torn_++;
+            }
+            if (store_.version() != number_) {
+                mismatched_++;
+            }
+            if (number_ < last_) {
+                backwards_++;
+            }
+            last_ = number_;
+
+            // Long enough for the writer to publish a few times
+            for (int i = 0; i < 50; i++) {
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+            }
+            if (value_.Number != number_ || !consistent(value_)) {
+                changed_++;
+            }
+            store_.release();
+            reads_++;
+        }
+    });
+
+    auto start_ = std::chrono::steady_clock::now();
+    uint32_t versions_ = 0;
+    for (uint32_t i = 1; i <= Publishes; i++) {
+        fill(store_.edit(), i);
+        if (store_.publish() == i) {
+            versions_++;
+        }
+    }
+    double writeSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    done_ = true;
+    reader_.join();
+
+    EXPECT_EQ(torn_, 0u);
+    EXPECT_EQ(changed_, 0u);
+    EXPECT_EQ(mismatched_, 0u);
+    EXPECT_EQ(backwards_, 0u);
+    EXPECT_EQ(versions_, Publishes);
+    EXPECT_GT(reads_, 0u);
+
+    printf("%.0f publishes/s, %llu held reads\n", Publishes / writeSeconds_, (unsigned long long)reads_);
+}
@@ -0,0 +1,58 @@
+// test_sketch.cpp
+
+// Boots the sketch on the stand-ins and checks what reaches the bus and the web server
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "hostsketch.h"
+#include "hostcan.h"
+#include "N2kMessages.h"
+#include "ESPAsyncWebServer.h"
+
+TEST(Sketch, SendsTheMeasurementsOfTheSensor) {
+    HostSketch::sensor(0).setConditions(21.5, 1009.0, 48.0);
+    HostSketch::run(10000);
+
+    bool temperature_ = false;
+    bool humidity_ = false;
+    bool pressure_ = false;
+
+    for (const HostCanMessage& message_ : gHostCan.messages()) {
+        int index_ = 3;
+        if (message_.Msg.PGN == 130312L && message_.Msg.Data[2] == N2kts_MainCabinTemperature) {
+            EXPECT_EQ(message_.Source, 22);
+            EXPECT_NEAR(KelvinToC(message_.Msg.Get2ByteUDouble(0.01, index_)), 21.5, 0.02);
+            temperature_ = true;
+        }
+        else if (message_.Msg.PGN == 130313L) {
+            EXPECT_EQ(message_.Source, 24);
+            EXPECT_NEAR(message_.Msg.Get2ByteDouble(0.004, index_), 48.0, 0.1);
+            humidity_ = true;
+        }
+        else if (message_.Msg.PGN == 130314L) {
+            EXPECT_EQ(message_.Source, 23);
+            EXPECT_NEAR(PascalTomBar(message_.Msg.Get4ByteDouble(0.1, index_)), 1009.0, 0.05);
+            pressure_ = true;
+        }
+    }
+
+    EXPECT_TRUE(temperature_);
+    EXPECT_TRUE(humidity_);
+    EXPECT_TRUE(pressure_);
+    EXPECT_EQ(gHostCan.rejected(), 0u);
+}
+
+TEST(Sketch, ServesTheLastMeasurement) {
+    HostSketch::run(1000);
+
+    AsyncWebServerRequest request_(HTTP_GET, "/data");
+    ASSERT_TRUE(AsyncWebServer::instance()->handle(request_));
+    ASSERT_NE(request_.response(), nullptr);
+    EXPECT_EQ(request_.response()->code(), 200);
+
+    std::string body_;
+    request_.response()->drain(&body_);
+    EXPECT_NE(body_.find("\"Temperature\":21.50"), std::string::npos) << body_;
+}
@@ -0,0 +1,185 @@
+// test_streamstats.cpp
+
+// The sliding window statistics against a batch reference: all values of
+// the window kept and summed again in two passes with long double
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <math.h>
+#include <random>
+#include <vector>
+
+#include "streamstats.h"
+
+struct Sample {
+    float Value;
+    uint32_t Time;
+};
+
+struct BatchSummary {
+    long double Min;
+    long double Max;
+    long double Mean;
+    long double StdDev;
+    uint32_t Count;
+};
+
+// The same window as WindowStatistics: the running bucket and the Buckets before it
+template <uint16_t Buckets, uint32_t BucketLength>
+static BatchSummary reference(const std::vector<Sample>& samples_) {
+    uint32_t start_ = samples_.front().Time;
+    uint32_t last_ = (samples_.back().Time - start_) / BucketLength;
+
+    std::vector<long double> values_;
+    for (const Sample& sample_ : samples_) {
+        uint32_t bucket_ = (sample_.Time - start_) / BucketLength;
+        if (bucket_ + Buckets >= last_ && !isnan(sample_.Value)) {
+            values_.push_back(sample_.Value);
+        }
+    }
+
+    BatchSummary summary_ = { NAN, NAN, NAN, NAN, (uint32_t)values_.size() };
+    if (values_.empty()) {
+        return summary_;
+    }
+    long double sum_ = 0;
+    for (long double value_ : values_) {
+        sum_ += value_;
+    }
+    long double mean_ = sum_ / values_.size();
+    long double squares_ = 0;
+    for (long double value_ : values_) {
+        squares_ += (value_ - mean_) * (value_ - mean_);
+    }
+    summary_.Min = *std::min_element(values_.begin(), values_.end());
+    summary_.Max = *std::max_element(values_.begin(), values_.end());
+    summary_.Mean = mean_;
+    summary_.StdDev = values_.size() > 1 ? sqrtl(squares_ / (values_.size() - 1)) : 0;
+    return summary_;
+}
+
+struct Accuracy {
+    double Mean;   // largest error, in the unit of the values
+    double StdDev; // largest error relative to the reference
+};
+
+// Adds the samples one by one and compares the summary with the reference every checkEvery_ samples
+template <uint16_t Buckets, uint32_t BucketLength>
+static Accuracy compare(const std::vector<Sample>& samples_, uint32_t checkEvery_) {
+    WindowStatistics<Buckets, BucketLength> window_;
+    std::vector<Sample> seen_;
+    Accuracy accuracy_ = { 0, 0 };
+
+    for (size_t i = 0; i < samples_.size(); i++) {
+        window_.add(samples_[i].Value, samples_[i].Time);
+        seen_.push_back(samples_[i]);
+        if (i % checkEvery_ != 0 && i + 1 != samples_.size()) {
+            continue;
+        }
+
+        StatisticsSummary actual_;
+        window_.summary(actual_);
+        BatchSummary expected_ = reference<Buckets, BucketLength>(seen_);
+
+        EXPECT_EQ(actual_.Count, expected_.Count) << i;
+        if (expected_.Count == 0) {
+            EXPECT_TRUE(isnan(actual_.Mean)) << i;
+            continue;
+        }
+        EXPECT_EQ(actual_.Min, (float)expected_.Min) << i;
+        EXPECT_EQ(actual_.Max, (float)expected_.Max) << i;
+        accuracy_.Mean = std::max(accuracy_.Mean, (double)fabsl(actual_.Mean - expected_.Mean));
+        if (expected_.StdDev > 0) {
+            accuracy_.StdDev = std::max(accuracy_.StdDev, (double)(fabsl(actual_.StdDev - expected_.StdDev) / expected_.StdDev));
+        }
+    }
+    return accuracy_;
+}
+
+// Every 500 ms, with jitter, a random walk around offset_
+static std::vector<Sample> walk(uint32_t count_, double offset_, double step_, double noise_, uint32_t seed_) {
+    std::mt19937 random_(seed_);
+    std::normal_distribution<double> normal_(0, 1);
+    std::uniform_int_distribution<uint32_t> jitter_(0, 20);
+    std::vector<Sample> samples_;
+    double value_ = offset_;
+    for (uint32_t i = 0; i < count_; i++) {
+        value_ += step_ * normal_(random_);
+        samples_.push_back({ (float)(value_ + noise_ * normal_(random_)), i * 500 + jitter_(random_) });
+    }
+    return samples_;
+}
+
+TEST(StreamStatsTest, PressureAgainstBatch) {
+    // The large offset against the small spread is where a naive sum of squares fails
+    std::vector<Sample> samples_ = walk(2 * 7200, 1013.25, 0.002, 0.05, 1);
+    Accuracy minute_ = compare<6, 10000>(samples_, 97);
+    Accuracy hour_ = compare<30, 120000>(samples_, 997);
+    printf("pressure: minute mean %.2e stddev %.2e, hour mean %.2e stddev %.2e\n", minute_.Mean, minute_.StdDev, hour_.Mean, hour_.StdDev);
+
+    // The summary is float: half an ulp of 1013 is 3e-5
+    EXPECT_LT(minute_.Mean, 1e-4);
+    EXPECT_LT(hour_.Mean, 1e-4);
+    EXPECT_LT(minute_.StdDev, 1e-6);
+    EXPECT_LT(hour_.StdDev, 1e-6);
+}
+
+TEST(StreamStatsTest, DayAgainstBatch) {
+    // Two days of temperature at 500 ms
+    std::vector<Sample> samples_ = walk(2 * 24 * 7200, 20.0, 0.01, 0.02, 2);
+    Accuracy day_ = compare<24, 3600000>(samples_, 20011);
+    printf("temperature: day mean %.2e stddev %.2e\n", day_.Mean, day_.StdDev);
+    // Half an ulp of 20 is 1e-6
+    EXPECT_LT(day_.Mean, 2e-6);
+    EXPECT_LT(day_.StdDev, 1e-6);
+}
+
+TEST(StreamStatsTest, MissingValuesAndGaps) {
+    std::vector<Sample> samples_ = walk(3000, 50.0, 0.1, 0.2, 3);
+    // Every 7th value missing and 90 s without any value
+    for (size_t i = 0; i < samples_.size(); i++) {
+        if (i % 7 == 0) {
+            samples_[i].Value = NAN;
+        }
+        if (i >= 1000) {
+            samples_[i].Time += 90000;
+        }
+    }
+    Accuracy minute_ = compare<6, 10000>(samples_, 13);
+    EXPECT_LT(minute_.Mean, 1e-5);
+    EXPECT_LT(minute_.StdDev, 1e-5);
+
+    // A gap longer than the window leaves it empty until the next value
+    MinuteStatistics window_;
+    window_.add(1.0f, 0);
+    window_.add(NAN, 100000);
+    StatisticsSummary summary_;
+    window_.summary(summary_);
+    EXPECT_EQ(summary_.Count, 0u);
+    EXPECT_TRUE(isnan(summary_.Mean));
+}
+
+TEST(StreamStatsTest, MergeEqualsAdd) {
+    std::vector<Sample> samples_ = walk(1000, 1013.0, 0.01, 0.1, 4);
+    StatisticsAccumulator all_;
+    StatisticsAccumulator parts_[7];
+    all_.clear();
+    for (StatisticsAccumulator& part_ : parts_) {
+        part_.clear();
+    }
+    for (size_t i = 0; i < samples_.size(); i++) {
+        all_.add(samples_[i].Value);
+        parts_[i * 7 / samples_.size()].add(samples_[i].Value);
+    }
+    StatisticsAccumulator merged_;
+    merged_.clear();
+    for (const StatisticsAccumulator& part_ : parts_) {
+        merged_.merge(part_);
+    }
+    EXPECT_EQ(merged_.Count, all_.Count);
+    EXPECT_NEAR(merged_.Mean, all_.Mean, 1e-9);
+    EXPECT_NEAR(merged_.M2, all_.M2, all_.M2 * 1e-9);
+    EXPECT_EQ(merged_.Min, all_.Min);
+    EXPECT_EQ(merged_.Max, all_.Max);
+}
@@ -0,0 +1,105 @@
+// test_txpolicy.cpp
+
+// The transmit policy on epochs with jitter, and a one hour replay that
+// counts the frames a channel puts on the bus
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <random>
+
+#include "txpolicy.h"
+
+static const uint32_t Epoch = 500;    // ms, EpochPeriod of the sketch
+static const uint32_t Hour = 3600000; // ms
+
+// Frames in one hour of epochs, each up to jitter_ ms late. value_ gives the
+// value of an epoch.
+template <typename TValue>
+static uint32_t replay(const TransmitPolicy& policy_, uint32_t jitter_, TValue value_) {
+    ChannelTransmitter transmitter_;
+    transmitter_.setPolicy(policy_);
+    transmitter_.setTolerance(Epoch / 2);
+
+    std::mt19937 random_(1);
+    std::uniform_int_distribution<uint32_t> late_(0, jitter_);
+    uint32_t frames_ = 0;
+    for (uint32_t epoch_ = 0; epoch_ < Hour / Epoch; epoch_++) {
+        uint32_t now_ = epoch_ * Epoch + late_(random_);
+        if (transmitter_.due(value_(epoch_), now_)) {
+            frames_++;
+        }
+    }
+    return frames_;
+}
+
+TEST(TxPolicyTest, MinIntervalOfOneEpochSendsEveryEpoch) {
+    TransmitPolicy policy_ = { 0, Epoch, 5000 };
+    ChannelTransmitter transmitter_;
+    transmitter_.setPolicy(policy_);
+    transmitter_.setTolerance(Epoch / 2);
+
+    EXPECT_TRUE(transmitter_.due(20.0, 1010));
+    // 499 ms after the last send, because the last sample was late
+    EXPECT_TRUE(transmitter_.due(20.1, 1509));
+    EXPECT_TRUE(transmitter_.due(20.2, 2000));
+    // Two values in the same epoch
+    EXPECT_FALSE(transmitter_.due(20.3, 2100));
+}
+
+TEST(TxPolicyTest, WithoutToleranceJitterHalvesTheRate) {
+    TransmitPolicy policy_ = { 0, Epoch, 5000 };
+    ChannelTransmitter transmitter_;
+    transmitter_.setPolicy(policy_);
+
+    EXPECT_TRUE(transmitter_.due(20.0, 1010));
+    EXPECT_FALSE(transmitter_.due(20.1, 1509));
+}
+
+TEST(TxPolicyTest, HeartbeatKeepsItsPeriodUnderJitter) {
+    TransmitPolicy policy_ = { 0.1, Epoch, 5000 };
+    ChannelTransmitter transmitter_;
+    transmitter_.setPolicy(policy_);
+    transmitter_.setTolerance(Epoch / 2);
+
+    EXPECT_TRUE(transmitter_.due(20.0, 30));
+    // The epoch 5 s later, sampled a bit earlier in its epoch
+    EXPECT_FALSE(transmitter_.due(20.0, 4530));
+    EXPECT_TRUE(transmitter_.due(20.0, 5010));
+    EXPECT_FALSE(transmitter_.due(20.0, 5500));
+}
+
+TEST(TxPolicyTest, ReplayFramesPerHour) {
+    TransmitPolicy every_ = { 0, Epoch, 5000 };
+    TransmitPolicy temperature_ = { 0.1, Epoch, 5000 };
+    TransmitPolicy pressure_ = { 0.1, Epoch, 5000 };
+
+    // A room in the morning: 2 degrees per hour with 0.02 degrees noise
+    std::mt19937 noise_(2);
+    std::normal_distribution<double> sensor_(0, 0.02);
+    auto warming_ = [&](uint32_t epoch_) { return 18.0 + 2.0 * epoch_ / (Hour / Epoch) + sensor_(noise_); };
+    // A constant value, only the heartbeat sends
+    auto constant_ = [](uint32_t) { return 1013.2; };
+    // A front passing, 3 mBar in the hour
+    auto front_ = [](uint32_t epoch_) { return 1013.2 - 3.0 * epoch_ / (Hour / Epoch); };
+
+    uint32_t steady_ = replay(every_, 0, constant_);
+    uint32_t jittered_ = replay(every_, 20, constant_);
+    uint32_t warmingFrames_ = replay(temperature_, 20, warming_);
+    uint32_t constantFrames_ = replay(pressure_, 20, constant_);
+    uint32_t frontFrames_ = replay(pressure_, 20, front_);
+
+    printf("frames/hour: deadband 0 %lu (no jitter) %lu (20 ms jitter)\n", (unsigned long)steady_, (unsigned long)jittered_);
+    printf("frames/hour: warming %lu, constant %lu, front %lu\n", (unsigned long)warmingFrames_, (unsigned long)constantFrames_, (unsigned long)frontFrames_);
+
+    // One frame per epoch, jitter does not halve it
+    EXPECT_EQ(steady_, Hour / Epoch);
+    EXPECT_EQ(jittered_, Hour / Epoch);
+    // One heartbeat every 5 s
+    EXPECT_EQ(constantFrames_, Hour / 5000);
+    // Steps of 0.1 mBar come every 2 minutes, the heartbeat sends in between
+    EXPECT_NEAR(frontFrames_, Hour / 5000, 2);
+    // Noise crosses the deadband now and then, far below one frame per epoch
+    EXPECT_GE(warmingFrames_, Hour / 5000);
+    EXPECT_LT(warmingFrames_, Hour / Epoch / 4);
+}
@@ -0,0 +1,76 @@
+// test_writebehind.cpp
+
+// Address claim storms against the simulated flash: the claimed source
+// addresses have to end in one write once they settled
+
+#include <gtest/gtest.h>
+
+#include "hostsketch.h"
+#include "IotWebConfAsync.h"
+#include "NMEA2000_CAN.h"
+#include "writebehind.h"
+
+TEST(WriteBehind, RepeatedChangesOfOneFieldRestartTheSettleTime) {
+    WriteBehind writer_;
+
+    // The same device claims a new address every second
+    for (uint32_t now_ = 0; now_ <= 20000; now_ += 1000) {
+        writer_.update(1, now_);
+        EXPECT_FALSE(writer_.due(now_ + 999)) << now_;
+    }
+    EXPECT_FALSE(writer_.due(20000 + WriteBehind::SettleTime - 1));
+    EXPECT_TRUE(writer_.due(20000 + WriteBehind::SettleTime));
+    EXPECT_EQ(writer_.changes(), 21u);
+}
+
+TEST(WriteBehind, MaxDelayEndsALongStorm) {
+    WriteBehind writer_;
+
+    for (uint32_t now_ = 0; now_ < WriteBehind::MaxDelay; now_ += 1000) {
+        writer_.update(1, now_);
+        EXPECT_FALSE(writer_.due(now_)) << now_;
+    }
+    EXPECT_TRUE(writer_.due(WriteBehind::MaxDelay));
+}
+
+TEST(WriteBehind, AClaimStormIsWrittenOnce) {
+    HostSketch::boot();
+    HostSketch::run(10000);
+    HostFlash::resetCounters();
+
+    // Device 0 loses its address 20 times, one claim per second
+    uint8_t source_ = 22;
+    for (int i = 0; i < 20; i++) {
+        source_ = 60 + i;
+        NMEA2000.claimAddress(0, source_);
+        HostSketch::run(1000);
+        EXPECT_EQ(HostFlash::erases(), 0u) << i;
+    }
+
+    HostSketch::run(WriteBehind::SettleTime + 1000);
+    printf("20 claims in 20 s: %lu erases, %lu writes\n", (unsigned long)HostFlash::erases(), (unsigned long)HostFlash::writes());
+    EXPECT_EQ(HostFlash::erases(), 1u);
+    EXPECT_EQ(HostFlash::writes(), 1u);
+
+    // The last address is the stored one, nothing more to write
+    HostSketch::run(120000);
+    EXPECT_EQ(HostFlash::erases(), 1u);
+    EXPECT_EQ(NMEA2000.GetN2kSource(0), source_);
+}
+
+TEST(WriteBehind, AClaimStormOfSeveralDevicesIsWrittenOnce) {
+    HostSketch::boot();
+    HostSketch::run(10000);
+    HostFlash::resetCounters();
+
+    // The three devices of the sensor claim in turn, one of them twice
+    const int Devices[] = { 0, 1, 2, 0, 1, 2, 0 };
+    for (int i = 0; i < 7; i++) {
+        NMEA2000.claimAddress(Devices[i], 80 + i);
+        HostSketch::run(700);
+    }
+
+    HostSketch::run(WriteBehind::SettleTime + 1000);
+    EXPECT_EQ(HostFlash::erases(), 1u);
+    EXPECT_EQ(HostFlash::writes(), 1u);
+}